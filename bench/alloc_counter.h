@@ -0,0 +1,30 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstdint>
+
+// Global operator new is replaced in alloc_counter.cpp to count the heap
+// allocations of the whole benchmark binary, threads included.
+namespace bench {
+
+/// allocations made through operator new since the start of the process
+uint64_t allocations();
+
+/**
+ * Counts the allocations made during its lifetime, to be reported per
+ * processed site through perSite().
+ */
+class AllocationScope {
+public:
+    AllocationScope() : m_start(allocations()) {}
+
+    uint64_t count() const { return allocations() - m_start; }
+    double perSite(int64_t sites) const { return sites ? double(count()) / double(sites) : 0.0; }
+
+private:
+    uint64_t m_start;
+};
+
+} // namespace bench
+
+#endif // ALLOC_COUNTER_H
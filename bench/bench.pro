@@ -0,0 +1,20 @@
+include(../common.pri)
+include(../core/core.pri)
+
+TEMPLATE = app
+TARGET = vt_bench
+
+CONFIG += console
+CONFIG -= qt app_bundle
+
+SOURCES += \
+        alloc_counter.cpp \
+        grid_layout_bench.cpp \
+        pipeline_bench.cpp \
+        tiler_bench.cpp
+
+HEADERS += \
+        alloc_counter.h
+
+# main() comes from benchmark_main
+LIBS += -lbenchmark_main -lbenchmark
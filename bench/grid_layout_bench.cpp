@@ -0,0 +1,118 @@
+// Compares the historical row-of-vectors acceleration grid with the flat
+// SoA grid now used by PoissonGenerator::sGrid.
+
+#include <map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "poisson-grid.h"
+
+using namespace PoissonGenerator;
+
+namespace {
+
+// Layout used up to Poisson Generator 1.1.4: one heap-allocated vector per
+// row, 12-byte points with an inline validity flag and a fixed 10x10 probe.
+struct LegacyGrid {
+    LegacyGrid(int W, int H, float MinDist)
+        : m_W(W)
+        , m_H(H)
+        , m_MinDist2(MinDist * MinDist)
+    {
+        m_Grid.resize(m_H);
+        for (auto &r : m_Grid)
+            r.resize(m_W);
+    }
+
+    sGridPoint GridPoint(const sPoint &P) const {
+        return { std::min(int(P.x * m_W), m_W - 1), std::min(int(P.y * m_H), m_H - 1) };
+    }
+
+    void Insert(const sPoint &P) {
+        auto G = GridPoint(P);
+        m_Grid[G.x][G.y] = P;
+    }
+
+    bool IsInNeighbourhood(sPoint Point) {
+        sGridPoint G = GridPoint(Point);
+        const int D = 5;
+
+        for (int i = G.x - D; i < G.x + D; i++) {
+            for (int j = G.y - D; j < G.y + D; j++) {
+                if (i >= 0 && i < m_W && j >= 0 && j < m_H) {
+                    sPoint P = m_Grid[i][j];
+                    if (P.m_Valid && P.Dist2(Point) < m_MinDist2)
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    int m_W;
+    int m_H;
+    float m_MinDist2;
+    std::vector<std::vector<sPoint>> m_Grid;
+};
+
+struct Sample {
+    std::vector<sPoint> points;
+    std::vector<sPoint> queries;
+    float min_dist;
+    int grid_size;
+};
+
+// Poisson sets are expensive to produce at 10^6 points, build each one once.
+const Sample &sample(size_t n) {
+    static std::map<size_t, Sample> cache;
+    auto it = cache.find(n);
+    if (it != cache.end())
+        return it->second;
+
+    Sample s;
+    DefaultPRNG prng(0);
+    s.min_dist = std::sqrt(float(n)) / float(n);
+    s.points = GeneratePoissonPoints(n, prng, 30, false, s.min_dist);
+    s.grid_size = int(std::ceil(std::sqrt(2.0f) / s.min_dist));
+
+    s.queries.reserve(4096);
+    for (int i = 0; i < 4096; ++i)
+        s.queries.emplace_back(prng.RandomFloat(), prng.RandomFloat());
+
+    return cache.emplace(n, std::move(s)).first->second;
+}
+
+template <typename G>
+void BM_Insert(benchmark::State &state) {
+    const auto &s = sample(size_t(state.range(0)));
+    for (auto _ : state) {
+        G grid(s.grid_size, s.grid_size, s.min_dist);
+        for (const auto &p : s.points)
+            grid.Insert(p);
+        benchmark::DoNotOptimize(grid);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(s.points.size()));
+}
+
+template <typename G>
+void BM_Neighbourhood(benchmark::State &state) {
+    const auto &s = sample(size_t(state.range(0)));
+    G grid(s.grid_size, s.grid_size, s.min_dist);
+    for (const auto &p : s.points)
+        grid.Insert(p);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grid.IsInNeighbourhood(s.queries[i]));
+        i = (i + 1) % s.queries.size();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Insert, LegacyGrid)->RangeMultiplier(10)->Range(10000, 1000000);
+BENCHMARK_TEMPLATE(BM_Insert, sGrid)->RangeMultiplier(10)->Range(10000, 1000000);
+BENCHMARK_TEMPLATE(BM_Neighbourhood, LegacyGrid)->RangeMultiplier(10)->Range(10000, 1000000);
+BENCHMARK_TEMPLATE(BM_Neighbourhood, sGrid)->RangeMultiplier(10)->Range(10000, 1000000);
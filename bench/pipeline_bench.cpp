@@ -0,0 +1,296 @@
+// One benchmark per stage of the generation pipeline, from the Poisson
+// sampler to the cell areas, over 10^3 to 10^7 requested sites and tiles
+// of the same area with 1:1, 4:1 and 16:1 aspect ratios.
+//
+// Every benchmark reports its throughput in sites per second and the heap
+// allocations it makes per site. Google Benchmark writes JSON with
+//
+//     vt_bench --benchmark_filter=Pipeline --benchmark_format=json
+//     vt_bench --benchmark_out=run.json --benchmark_out_format=json
+
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <boost/polygon/voronoi.hpp>
+
+#include "alloc_counter.h"
+#include "cell-raster.h"
+#include "cell-store.h"
+#include "convex-clip.h"
+#include "poisson-grid.h"
+#include "regions.h"
+#include "tiling.h"
+#include "voronoi-cells.h"
+
+namespace {
+
+// tiles all cover 10^6 square units
+struct Shape {
+    int w, h;
+};
+
+Shape shape(int aspect) {
+    const double side = 1000.0 * std::sqrt(double(aspect));
+    return { int(std::lround(side)), int(std::lround(1.0e6 / side)) };
+}
+
+// inputs of the stages, built once per size and shape: sampling 10^7 sites
+// takes a while
+struct Input {
+    Shape shape;
+    std::vector<PoissonGenerator::sPoint> points;
+    vt::Grid sites;    // sites of the tile, as generateGrid() makes them
+    vt::Grid unique;   // the same, merged and in sweep order
+    std::vector<size_t> origin;
+};
+
+const Input &input(size_t n, int aspect) {
+    static std::map<std::pair<size_t, int>, Input> cache;
+    const auto key = std::make_pair(n, aspect);
+    auto it = cache.find(key);
+    if (it != cache.end())
+        return it->second;
+
+    Input in;
+    in.shape = shape(aspect);
+
+    PoissonGenerator::sSettings settings;
+    settings.Circle = false;
+    PoissonGenerator::DefaultPRNG prng(0);
+    in.points = PoissonGenerator::GeneratePoissonPoints(n, prng, settings);
+
+    vt::jitterSites(in.points, in.shape.w, in.shape.h, 0, in.sites);
+    vt::sweepUniqueSites(in.sites, in.unique, in.origin);
+
+    return cache.emplace(key, std::move(in)).first->second;
+}
+
+void report(benchmark::State &state, size_t sites, const bench::AllocationScope &allocations) {
+    const int64_t processed = int64_t(state.iterations()) * int64_t(sites);
+    state.SetItemsProcessed(processed);
+    state.counters["sites"] = double(sites);
+    state.counters["allocs_per_site"] = allocations.perSite(processed);
+}
+
+void BM_PoissonSampler(benchmark::State &state) {
+    const size_t n = size_t(state.range(0));
+    const Input &in = input(n, 1);
+
+    PoissonGenerator::sSettings settings;
+    settings.Circle = false;
+    PoissonGenerator::sContext context;
+
+    bench::AllocationScope allocations;
+    for (auto _ : state) {
+        PoissonGenerator::DefaultPRNG prng(0);
+        benchmark::DoNotOptimize(PoissonGenerator::GeneratePoissonPoints(n, prng, settings, context).data());
+    }
+    report(state, in.points.size(), allocations);
+}
+
+void BM_SamplerNeighbourhood(benchmark::State &state) {
+    const Input &in = input(size_t(state.range(0)), 1);
+
+    const float min_dist = std::sqrt(float(state.range(0))) / float(state.range(0));
+    const int grid_size = PoissonGenerator::GridSizeFor(min_dist);
+    PoissonGenerator::sGrid grid(grid_size, grid_size, min_dist);
+    for (const auto &p : in.points)
+        grid.Insert(p);
+
+    PoissonGenerator::PcgPRNG prng(0);
+    std::vector<PoissonGenerator::sPoint> queries;
+    for (int i = 0; i < 4096; ++i)
+        queries.emplace_back(prng.RandomFloat(), prng.RandomFloat());
+
+    bench::AllocationScope allocations;
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grid.IsInNeighbourhoodPacked(queries[i]));
+        i = (i + 1) % queries.size();
+    }
+    // one query per item here
+    state.SetItemsProcessed(int64_t(state.iterations()));
+    state.counters["sites"] = double(in.points.size());
+    state.counters["allocs_per_site"] = allocations.perSite(int64_t(state.iterations()));
+}
+
+void BM_JitterQuantize(benchmark::State &state) {
+    const Input &in = input(size_t(state.range(0)), int(state.range(1)));
+
+    vt::Grid g;
+    bench::AllocationScope allocations;
+    for (auto _ : state) {
+        vt::jitterSites(in.points, in.shape.w, in.shape.h, 0, g);
+        benchmark::DoNotOptimize(g.data());
+    }
+    report(state, in.sites.size(), allocations);
+}
+
+void BM_ConstructVoronoi(benchmark::State &state) {
+    const Input &in = input(size_t(state.range(0)), int(state.range(1)));
+
+    boost::polygon::voronoi_builder<int> builder;
+    boost::polygon::voronoi_diagram<double> vd;
+
+    bench::AllocationScope allocations;
+    for (auto _ : state) {
+        builder.clear();
+        vd.clear();
+        for (const vt::Site &s : in.unique)
+            builder.insert_point(s.x(), s.y());
+        builder.construct(&vd);
+        benchmark::DoNotOptimize(vd.num_cells());
+    }
+    report(state, in.sites.size(), allocations);
+}
+
+// the stages walking the diagram share one, built outside of the timing
+struct Diagram {
+    explicit Diagram(const Input &in) {
+        boost::polygon::construct_voronoi(in.unique.begin(), in.unique.end(), &vd);
+    }
+
+    boost::polygon::voronoi_diagram<double> vd;
+};
+
+// edge loops of the cells, closing the infinite ones, without clipping
+void BM_EdgeTraversal(benchmark::State &state) {
+    const Input &in = input(size_t(state.range(0)), int(state.range(1)));
+    const Diagram d(in);
+    const vt::GridQuantizer quant(in.shape.w, in.shape.h);
+    const double extent = std::max(in.shape.w, in.shape.h);
+
+    std::vector<vt::CellVertex> ring;
+    bench::AllocationScope allocations;
+    for (auto _ : state) {
+        size_t vertices = 0;
+        for (const auto &c : d.vd.cells()) {
+            vt::cellRing(c, in.unique, quant, extent, ring);
+            vertices += ring.size();
+        }
+        benchmark::DoNotOptimize(vertices);
+    }
+    report(state, in.sites.size(), allocations);
+}
+
+void BM_Clip(benchmark::State &state) {
+    const Input &in = input(size_t(state.range(0)), int(state.range(1)));
+    const vt::GridQuantizer quant(in.shape.w, in.shape.h);
+    const vt::ClipRect rect{0.0, 0.0, double(in.shape.w), double(in.shape.h)};
+
+    // unclipped rings, laid out like a cell store
+    std::vector<vt::CellVertex> vertices;
+    std::vector<size_t> offsets(1, 0);
+    {
+        const Diagram d(in);
+        std::vector<vt::CellVertex> ring;
+        for (const auto &c : d.vd.cells()) {
+            vt::cellRing(c, in.unique, quant, std::max(in.shape.w, in.shape.h), ring);
+            vertices.insert(vertices.end(), ring.begin(), ring.end());
+            offsets.push_back(vertices.size());
+        }
+    }
+
+    std::vector<vt::CellVertex> poly, scratch;
+    bench::AllocationScope allocations;
+    for (auto _ : state) {
+        size_t clipped = 0;
+        for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+            poly.assign(vertices.begin() + offsets[i], vertices.begin() + offsets[i + 1]);
+            clipped += vt::clipConvex(poly, rect, scratch);
+        }
+        benchmark::DoNotOptimize(clipped);
+    }
+    report(state, in.sites.size(), allocations);
+}
+
+void BM_Area(benchmark::State &state) {
+    const Input &in = input(size_t(state.range(0)), int(state.range(1)));
+    vt::TilingContext context(vt::defaultPool());
+    const vt::CellStore &cells = context.computeVoronoi(in.sites, in.shape.w, in.shape.h);
+
+    bench::AllocationScope allocations;
+    for (auto _ : state) {
+        double total = 0.0;
+        for (size_t i = 0; i < cells.size(); ++i)
+            total += vt::area(cells[i]);
+        benchmark::DoNotOptimize(total);
+    }
+    report(state, in.sites.size(), allocations);
+}
+
+// generateGrid() then computeVoronoi(), on a reused context
+void BM_Pipeline(benchmark::State &state) {
+    const Input &in = input(size_t(state.range(0)), int(state.range(1)));
+    vt::TilingContext context(vt::defaultPool());
+
+    bench::AllocationScope allocations;
+    for (auto _ : state) {
+        const vt::Grid &g = context.generateGrid(in.shape.w, in.shape.h, int(state.range(0)), 0);
+        benchmark::DoNotOptimize(context.computeVoronoi(g, in.shape.w, in.shape.h).size());
+    }
+    report(state, in.sites.size(), allocations);
+}
+
+// cell index raster of a square tile, range(1) pixels a side
+void BM_RasterizeCells(benchmark::State &state) {
+    const Input &in = input(size_t(state.range(0)), 1);
+    vt::TilingContext context(vt::defaultPool());
+    const vt::CellStore &cells = context.computeVoronoi(in.sites, in.shape.w, in.shape.h);
+    const int side = int(state.range(1));
+
+    vt::CellRaster raster;
+    vt::rasterizeCells(cells, in.shape.w, in.shape.h, side, side, raster);
+    bench::AllocationScope allocations;
+    for (auto _ : state) {
+        vt::rasterizeCells(cells, in.shape.w, in.shape.h, side, side, raster);
+        benchmark::DoNotOptimize(raster.ids.data());
+    }
+    report(state, in.sites.size(), allocations);
+    state.counters["pixels"] = double(side) * side;
+}
+
+// about range(1) regions of a square tile, with their outlines
+void BM_ClusterCells(benchmark::State &state) {
+    const Input &in = input(size_t(state.range(0)), 1);
+    vt::Adjacency adjacency;
+    std::vector<uint32_t> edges;
+    const vt::CellStore cells = vt::computeVoronoi(in.sites, in.shape.w, in.shape.h, vt::defaultPool(), &adjacency,
+                                                   &edges);
+    const std::vector<vt::CellVertex> sites = vt::siteCoordinates(in.sites, in.shape.w, in.shape.h);
+
+    bench::AllocationScope allocations;
+    for (auto _ : state) {
+        const vt::Regions regions = vt::clusterCells(sites, cells, adjacency, edges, in.shape.w, in.shape.h,
+                                                     int(state.range(1)), 0);
+        benchmark::DoNotOptimize(regions.outlines.size());
+    }
+    report(state, in.sites.size(), allocations);
+}
+
+// n from 10^3 to 10^7, times the aspect ratios
+void sizesAndShapes(benchmark::internal::Benchmark *b) {
+    for (int64_t n = 1000; n <= 10000000; n *= 10)
+        for (int64_t aspect : {1, 4, 16})
+            b->Args({n, aspect});
+    b->ArgNames({"n", "aspect"});
+    b->Unit(benchmark::kMillisecond);
+}
+
+} // namespace
+
+BENCHMARK(BM_PoissonSampler)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SamplerNeighbourhood)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK(BM_JitterQuantize)->Apply(sizesAndShapes);
+BENCHMARK(BM_ConstructVoronoi)->Apply(sizesAndShapes);
+BENCHMARK(BM_EdgeTraversal)->Apply(sizesAndShapes);
+BENCHMARK(BM_Clip)->Apply(sizesAndShapes);
+BENCHMARK(BM_Area)->Apply(sizesAndShapes);
+BENCHMARK(BM_Pipeline)->Apply(sizesAndShapes);
+BENCHMARK(BM_RasterizeCells)->ArgsProduct({{1000, 100000, 1000000}, {1024, 8192}})
+    ->ArgNames({"n", "side"})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ClusterCells)->ArgsProduct({{100000, 1000000}, {100, 1000}})
+    ->ArgNames({"n", "k"})->Unit(benchmark::kMillisecond);
@@ -0,0 +1,50 @@
+// Compares a fresh Voronoi construction per run with the persistent tiler
+// of vt::TilingContext, which reuses its builder, diagram and buffers and
+// feeds the sweep its sites already sorted.
+
+#include <map>
+
+#include <benchmark/benchmark.h>
+
+#include "tiling.h"
+
+namespace {
+
+const int W = 1000;
+const int H = 1000;
+
+// sampling 10^6 sites takes a while, generate each set once
+const vt::Grid &sites(size_t n) {
+    static std::map<size_t, vt::Grid> cache;
+    auto it = cache.find(n);
+    if (it == cache.end())
+        it = cache.emplace(n, vt::generateGrid(W, H, int(n), 0)).first;
+    return it->second;
+}
+
+// both sides stay on the serial construction
+vt::ThreadPool &serialPool() {
+    static vt::ThreadPool pool(0);
+    return pool;
+}
+
+void BM_FreshDiagram(benchmark::State &state) {
+    const vt::Grid &g = sites(size_t(state.range(0)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(vt::computeVoronoiSerial(g, W, H));
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(g.size()));
+}
+
+void BM_ReusedContext(benchmark::State &state) {
+    const vt::Grid &g = sites(size_t(state.range(0)));
+    vt::TilingContext context(serialPool());
+    context.computeVoronoi(g, W, H);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(context.computeVoronoi(g, W, H).size());
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(g.size()));
+}
+
+} // namespace
+
+BENCHMARK(BM_FreshDiagram)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReusedContext)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,11 @@
+include(../common.pri)
+include(../core/core.pri)
+
+TARGET = voronoi_tiling_cli
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= qt app_bundle
+
+SOURCES += \
+        main.cpp
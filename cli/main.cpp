@@ -0,0 +1,469 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "chunked-world.h"
+#include "instrument.h"
+#include "poisson-grid.h"
+#include "regions.h"
+#include "tile-cache.h"
+#include "tile-format.h"
+#include "tiling.h"
+
+namespace {
+
+struct Job {
+    int w, h, num;
+    uint32_t seed;
+    std::string output;
+};
+
+void usage(const char *prog) {
+    std::fprintf(stderr,
+        "usage: %s [options] <width> <height> <count> <seed> <output>\n"
+        "       %s [options] --manifest <file>\n"
+        "       %s [options] --chunk <size> <width> <height> <count> <seed> <output>\n"
+        "\n"
+        "outputs ending in .txt are written as text, the others as binary tile\n"
+        "files (see tile-format.h)\n"
+        "\n"
+        "options:\n"
+        "  -C, --chunk <size>    generates the map chunk by chunk, size x size each,\n"
+        "                        in bounded memory: chunk (x, y) goes to output with\n"
+        "                        _x_y before its extension, as a tile file in chunk\n"
+        "                        coordinates whose border cells run over the chunk\n"
+        "  -c, --cache <dir>     serves maps generated before from dir and keeps the new\n"
+        "                        ones there, the recent ones also stay in memory\n"
+        "  -j, --jobs <n>        maps generated at the same time, every core by default\n"
+        "  -m, --manifest <file> one job per line: width height count seed output,\n"
+        "                        blank lines and lines starting with # are skipped\n"
+        "  -q, --quiet           only report errors\n"
+        "  -r, --regions <k>     also groups the cells into about k regions, stored\n"
+        "                        with their outlines as a coarser level of detail\n"
+        "  -w, --wrap <x|y|xy>   maps repeating along these axes, seamless across the\n"
+        "                        borders: their border cells run over them\n"
+        "      --stats <file>    writes the counters and timings as JSON\n"
+        "      --trace <file>    writes the timed scopes as a Chrome trace\n"
+        "\n"
+        "--stats and --trace need a build with CONFIG+=vt_instrument, they\n"
+        "write empty reports otherwise\n",
+        prog, prog, prog);
+}
+
+bool parseInt(const char *s, long long min, long long max, long long &out) {
+    char *end = nullptr;
+    const long long v = std::strtoll(s, &end, 10);
+    if (!*s || *end || v < min || v > max)
+        return false;
+    out = v;
+    return true;
+}
+
+bool parseJob(const std::vector<std::string> &f, Job &job) {
+    long long w, h, num, seed;
+    if (f.size() != 5 || !parseInt(f[0].c_str(), 1, 1 << 20, w) || !parseInt(f[1].c_str(), 1, 1 << 20, h) ||
+        !parseInt(f[2].c_str(), 1, 1 << 30, num) || !parseInt(f[3].c_str(), 0, UINT32_MAX, seed))
+        return false;
+
+    job = Job{int(w), int(h), int(num), uint32_t(seed), f[4]};
+    return true;
+}
+
+bool readManifest(const char *path, std::vector<Job> &jobs) {
+    std::ifstream in(path);
+    if (!in) {
+        std::fprintf(stderr, "cannot open manifest %s\n", path);
+        return false;
+    }
+
+    std::string line;
+    for (int n = 1; std::getline(in, line); ++n) {
+        std::istringstream fields(line);
+        std::vector<std::string> f;
+        for (std::string s; fields >> s;)
+            f.push_back(s);
+
+        if (f.empty() || f[0][0] == '#')
+            continue;
+
+        Job job;
+        if (!parseJob(f, job)) {
+            std::fprintf(stderr, "%s:%d: expected width height count seed output\n", path, n);
+            return false;
+        }
+        jobs.push_back(job);
+    }
+
+    return true;
+}
+
+bool parseWrap(const std::string &s, vt::Wrap &wrap) {
+    if (s == "x")
+        wrap = vt::WRAP_X;
+    else if (s == "y")
+        wrap = vt::WRAP_Y;
+    else if (s == "xy")
+        wrap = vt::WRAP_XY;
+    else
+        return false;
+    return true;
+}
+
+const char *wrapName(vt::Wrap wrap) {
+    return wrap == vt::WRAP_XY ? "xy" : wrap == vt::WRAP_X ? "x" : "y";
+}
+
+/**
+ * Plain text dump of a tile:
+ *   voronoi_tiling <generator version>
+ *   tile <width> <height>
+ *   wrap <x|y|xy>, for repeating tiles only
+ *   sites <n>, then one "x y" line per site
+ *   cells <n>, then one "count x1 y1 ... xcount ycount" line per cell
+ *   with region LOD only:
+ *   regions <k>, then one line of the region of every cell
+ *   outlines <m>, then one "region count x1 y1 ... xcount ycount" line per ring
+ */
+bool writeText(const Job &job, vt::Wrap wrap, const std::vector<vt::CellVertex> &sites, const vt::CellStore &cells,
+               const vt::Regions &regions) {
+    std::FILE *f = std::fopen(job.output.c_str(), "w");
+    if (!f)
+        return false;
+
+    std::fprintf(f, "voronoi_tiling %s\ntile %d %d\n", PoissonGenerator::Version, job.w, job.h);
+    if (wrap != vt::WRAP_NONE)
+        std::fprintf(f, "wrap %s\n", wrapName(wrap));
+    std::fprintf(f, "sites %zu\n", sites.size());
+    for (const auto &s : sites)
+        std::fprintf(f, "%.17g %.17g\n", s.x(), s.y());
+
+    std::fprintf(f, "cells %zu\n", cells.size());
+    for (size_t i = 0; i < cells.size(); ++i) {
+        const vt::CellView cell = cells[i];
+        std::fprintf(f, "%zu", cell.size());
+        for (const auto &v : cell)
+            std::fprintf(f, " %.17g %.17g", v.x(), v.y());
+        std::fputc('\n', f);
+    }
+
+    if (!regions.empty()) {
+        std::fprintf(f, "regions %zu\n", regions.size());
+        for (size_t i = 0; i < regions.labels.size(); ++i)
+            std::fprintf(f, i ? " %u" : "%u", unsigned(regions.labels[i]));
+        std::fprintf(f, "\noutlines %zu\n", regions.outlines.size());
+        for (size_t r = 0; r < regions.size(); ++r) {
+            for (uint32_t j = regions.ringOffsets[r]; j < regions.ringOffsets[r + 1]; ++j) {
+                const vt::CellView ring = regions.outlines[j];
+                std::fprintf(f, "%zu %zu", r, ring.size());
+                for (const auto &v : ring)
+                    std::fprintf(f, " %.17g %.17g", v.x(), v.y());
+                std::fputc('\n', f);
+            }
+        }
+    }
+
+    return std::fclose(f) == 0;
+}
+
+bool writeFile(const char *path, const std::string &contents) {
+    std::FILE *f = std::fopen(path, "wb");
+    if (!f)
+        return false;
+    const bool written = std::fwrite(contents.data(), 1, contents.size(), f) == contents.size();
+    return std::fclose(f) == 0 && written;
+}
+
+/// output of chunk (cx, cy), its coordinates inserted before the extension
+std::string chunkPath(const std::string &output, int64_t cx, int64_t cy) {
+    const size_t dot = output.find_last_of('.');
+    const size_t slash = output.find_last_of('/');
+    const size_t at = dot != std::string::npos && (slash == std::string::npos || dot > slash) ? dot : output.size();
+
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), "_%lld_%lld", static_cast<long long>(cx), static_cast<long long>(cy));
+    return output.substr(0, at) + suffix + output.substr(at);
+}
+
+/**
+ * Streams the map of job to one tile file per chunk, see vt::ChunkedWorld.
+ * The Poisson distance is the one generateGrid() gives count sites, over
+ * the world area. A tile holds the sites of its chunk and their whole cells,
+ * moved to the chunk origin, without adjacency.
+ */
+bool writeChunks(const Job &job, int chunkSize, size_t &sites, size_t &chunks, std::string &error) {
+    vt::ChunkedWorldSettings settings;
+    settings.width = job.w;
+    settings.height = job.h;
+    settings.chunkSize = chunkSize;
+    settings.minDist = std::sqrt(double(job.w) * job.h / job.num);
+    settings.seed = job.seed;
+
+    vt::ChunkedWorld world(settings);
+    sites = chunks = 0;
+    bool ok = true;
+    std::vector<vt::CellVertex> local;
+    vt::CellStore cells;
+    std::vector<vt::CellVertex> ring;
+
+    world.generate([&](const vt::Chunk &chunk) {
+        if (!ok)
+            return;
+
+        auto move = [&](const vt::CellVertex &v) { return vt::CellVertex(v.x() - chunk.x0, v.y() - chunk.y0); };
+        local.clear();
+        for (const vt::CellVertex &s : chunk.sites)
+            local.push_back(move(s));
+        cells.clear();
+        for (size_t i = 0; i < chunk.cells.size(); ++i) {
+            ring.clear();
+            for (const vt::CellVertex &v : chunk.cells[i])
+                ring.push_back(move(v));
+            cells.append(ring);
+        }
+
+        ok = vt::writeTileFile(chunkPath(job.output, chunk.cx, chunk.cy), chunk.x1 - chunk.x0, chunk.y1 - chunk.y0,
+                               local, cells, nullptr, nullptr, 0, &error);
+        sites += local.size();
+        ++chunks;
+    });
+
+    return ok;
+}
+
+bool endsWith(const std::string &s, const char *suffix) {
+    const size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    unsigned threads = 0;
+    const char *manifest = nullptr;
+    bool quiet = false;
+    const char *stats = nullptr;
+    const char *trace = nullptr;
+    const char *cacheDir = nullptr;
+    vt::Wrap wrap = vt::WRAP_NONE;
+    int regionCount = 0;
+    int chunkSize = 0;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        long long v;
+
+        if ((arg == "-j" || arg == "--jobs") && i + 1 < argc && parseInt(argv[i + 1], 1, 4096, v)) {
+            threads = unsigned(v);
+            ++i;
+        }
+        else if ((arg == "-C" || arg == "--chunk") && i + 1 < argc && parseInt(argv[i + 1], 1, 1 << 20, v)) {
+            chunkSize = int(v);
+            ++i;
+        }
+        else if ((arg == "-c" || arg == "--cache") && i + 1 < argc) {
+            cacheDir = argv[++i];
+        }
+        else if ((arg == "-w" || arg == "--wrap") && i + 1 < argc && parseWrap(argv[i + 1], wrap)) {
+            ++i;
+        }
+        else if ((arg == "-r" || arg == "--regions") && i + 1 < argc && parseInt(argv[i + 1], 1, 1 << 24, v)) {
+            regionCount = int(v);
+            ++i;
+        }
+        else if ((arg == "-m" || arg == "--manifest") && i + 1 < argc) {
+            manifest = argv[++i];
+        }
+        else if (arg == "-q" || arg == "--quiet") {
+            quiet = true;
+        }
+        else if (arg == "--stats" && i + 1 < argc) {
+            stats = argv[++i];
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            trace = argv[++i];
+        }
+        else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        }
+        else if (arg.size() > 1 && arg[0] == '-') {
+            usage(argv[0]);
+            return 2;
+        }
+        else {
+            positional.push_back(arg);
+        }
+    }
+
+    std::vector<Job> jobs;
+    if (manifest) {
+        if (!positional.empty()) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (!readManifest(manifest, jobs))
+            return 1;
+    }
+    else {
+        Job job;
+        if (!parseJob(positional, job)) {
+            usage(argv[0]);
+            return 2;
+        }
+        jobs.push_back(job);
+    }
+
+    // chunks are plain tile files, streamed as they are built
+    if (chunkSize && (wrap != vt::WRAP_NONE || regionCount || cacheDir)) {
+        std::fprintf(stderr, "--chunk cannot be combined with --wrap, --regions or --cache\n");
+        return 2;
+    }
+    for (const Job &job : jobs) {
+        if (chunkSize && endsWith(job.output, ".txt")) {
+            std::fprintf(stderr, "%s: chunked maps are written as tile files only\n", job.output.c_str());
+            return 2;
+        }
+    }
+
+    // one pool for everything: jobs run side by side and a large map also
+    // spreads its Voronoi construction over the idle threads
+    vt::ThreadPool pool(threads ? threads - 1 : std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+    // without a cache the tiles are streamed to their files, with one they
+    // are encoded in memory first
+    std::unique_ptr<vt::TileCache> cache;
+    if (cacheDir) {
+        if (mkdir(cacheDir, 0777) != 0 && errno != EEXIST)
+            std::fprintf(stderr, "cannot create %s: %s, tiles are only cached in memory\n", cacheDir, std::strerror(errno));
+        cache.reset(new vt::TileCache(vt::TileCache::DEFAULT_MEMORY_BUDGET, cacheDir));
+    }
+
+    const uint32_t flags = ((wrap & vt::WRAP_X) ? vt::TILE_FLAG_WRAP_X : 0) |
+                           ((wrap & vt::WRAP_Y) ? vt::TILE_FLAG_WRAP_Y : 0);
+
+    std::mutex report;
+    std::atomic<size_t> failed(0);
+
+    pool.parallelFor(0, jobs.size(), 1, [&](size_t i) {
+        const Job &job = jobs[i];
+        const auto start = std::chrono::steady_clock::now();
+
+        const bool text = endsWith(job.output, ".txt");
+        const vt::TileKey key = vt::tileKey(job.w, job.h, job.num, job.seed, 0, !text, wrap, regionCount);
+
+        vt::TileCache::Tile tile = cache ? cache->find(key) : vt::TileCache::Tile();
+        const bool cached = bool(tile);
+
+        std::vector<vt::CellVertex> sites;
+        vt::CellStore cells;
+        vt::Regions regions;
+        size_t count = 0;
+        std::string error;
+        bool ok = true;
+        size_t chunks = 0;
+
+        if (chunkSize) {
+            ok = writeChunks(job, chunkSize, count, chunks, error);
+        }
+        else if (!cached) {
+            // the regions are grown along the adjacency and outlined along the edges
+            vt::Adjacency adjacency;
+            std::vector<uint32_t> edges;
+            const vt::Grid grid = vt::generateWrappedGrid(job.w, job.h, job.num, job.seed, wrap);
+            cells = vt::computeVoronoiWrapped(grid, job.w, job.h, wrap, pool,
+                                              text && !regionCount ? nullptr : &adjacency,
+                                              regionCount ? &edges : nullptr);
+            sites = vt::siteCoordinates(grid, job.w, job.h);
+            count = grid.size();
+            if (regionCount)
+                regions = vt::clusterCells(sites, cells, adjacency, edges, job.w, job.h, regionCount, job.seed, pool,
+                                           wrap);
+
+            if (cache) {
+                auto bytes = std::make_shared<std::string>();
+                ok = vt::encodeTile(job.w, job.h, sites, cells, text ? nullptr : &adjacency, &regions, *bytes, flags,
+                                    &error);
+                if (ok) {
+                    cache->insert(key, bytes);
+                    tile = bytes;
+                }
+            }
+            else if (!text) {
+                ok = vt::writeTileFile(job.output, job.w, job.h, sites, cells, &adjacency, &regions, flags, &error);
+            }
+        }
+        else {
+            vt::TileFile file;
+            std::string problem;
+            ok = file.view(tile->data(), tile->size(), &problem);
+            if (!ok) {
+                error = "invalid cached tile for " + job.output + ": " + problem;
+            }
+            else {
+                count = file.siteCount();
+                if (text)
+                    ok = vt::decodeTile(*tile, sites, cells, &error) && vt::decodeRegions(*tile, regions, &error);
+            }
+        }
+
+        if (ok && text) {
+            ok = writeText(job, wrap, sites, cells, regions);
+            error = "cannot write " + job.output;
+        }
+        else if (ok && tile) {
+            ok = writeFile(job.output.c_str(), *tile);
+            error = "cannot write " + job.output;
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(report);
+        if (!ok) {
+            ++failed;
+            std::fprintf(stderr, "%s\n", error.c_str());
+        }
+        else if (!quiet) {
+            if (chunkSize)
+                std::printf("%s: %dx%d, %zu sites in %zu chunks in %.1f ms\n", job.output.c_str(), job.w, job.h,
+                            count, chunks, ms);
+            else
+                std::printf("%s: %dx%d, %zu sites in %.1f ms%s\n", job.output.c_str(), job.w, job.h, count, ms,
+                            cached ? " (cached)" : "");
+        }
+    });
+
+    if (cache && !quiet) {
+        const vt::TileCacheStats s = cache->stats();
+        std::printf("cache: %llu hits (%llu from disk), %llu misses\n",
+                    static_cast<unsigned long long>(s.memoryHits + s.diskHits),
+                    static_cast<unsigned long long>(s.diskHits), static_cast<unsigned long long>(s.misses));
+    }
+
+    const vt::instrument::Report profile = vt::instrument::collect();
+    if (stats && !writeFile(stats, vt::instrument::toJson(profile))) {
+        std::fprintf(stderr, "cannot write %s\n", stats);
+        ++failed;
+    }
+    if (trace && !writeFile(trace, vt::instrument::toChromeTrace(profile))) {
+        std::fprintf(stderr, "cannot write %s\n", trace);
+        ++failed;
+    }
+
+    return failed ? 1 : 0;
+}
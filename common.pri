@@ -0,0 +1,10 @@
+CONFIG += c++11
+
+QMAKE_CFLAGS += -fno-omit-frame-pointer -g
+QMAKE_CXXFLAGS += -fno-omit-frame-pointer -g
+
+# keep the batched Poisson sampler bit-identical to the scalar one
+QMAKE_CXXFLAGS += -ffp-contract=off
+
+# qmake CONFIG+=vt_instrument: scoped timers and counters, see core/instrument.h
+vt_instrument: DEFINES += VT_INSTRUMENT
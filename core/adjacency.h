@@ -0,0 +1,150 @@
+#ifndef ADJACENCY_H
+#define ADJACENCY_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "csr-rows.h"
+
+namespace vt {
+
+/// read-only view over the neighbours of one cell
+class NeighbourView {
+public:
+    NeighbourView() : m_begin(nullptr), m_end(nullptr) {}
+    NeighbourView(const uint32_t *begin, const uint32_t *end) : m_begin(begin), m_end(end) {}
+
+    const uint32_t *begin() const { return m_begin; }
+    const uint32_t *end() const { return m_end; }
+    size_t size() const { return size_t(m_end - m_begin); }
+    bool empty() const { return m_begin == m_end; }
+    uint32_t operator[](size_t i) const { return m_begin[i]; }
+
+private:
+    const uint32_t *m_begin, *m_end;
+};
+
+/// label of the edges of a cell that have no cell on their other side
+const uint32_t NO_CELL = 0xFFFFFFFFu;
+
+/**
+ * Cell adjacency graph in compressed sparse rows, laid out like CellStore:
+ * the neighbours of cell i span [offsets[i], offsets[i+1]) of one array.
+ */
+class Adjacency {
+public:
+    Adjacency() : m_offsets(1, 0) {}
+
+    /// number of cells
+    size_t size() const { return m_offsets.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    NeighbourView operator[](size_t i) const {
+        assert(i < size());
+        const uint32_t *base = m_neighbours.data();
+        return NeighbourView(base + m_offsets[i], base + m_offsets[i + 1]);
+    }
+
+    const std::vector<uint32_t> &offsets() const { return m_offsets; }
+    const std::vector<uint32_t> &neighbours() const { return m_neighbours; }
+
+    void clear() {
+        m_neighbours.clear();
+        m_offsets.assign(1, 0);
+    }
+
+    void reserve(size_t cells, size_t links) {
+        m_offsets.reserve(cells + 1);
+        m_neighbours.reserve(links);
+    }
+
+    /// appends the neighbours of the next cell, cells must be added in index order
+    template <typename Range>
+    void append(const Range &neighbours) {
+        for (auto n : neighbours)
+            m_neighbours.push_back(uint32_t(n));
+        m_offsets.push_back(uint32_t(m_neighbours.size()));
+    }
+
+    /// neighbour lists produced in an arbitrary order, see CellStore::Unordered
+    class Unordered {
+    public:
+        template <typename Range>
+        void add(size_t index, const Range &neighbours) {
+            const size_t start = m_neighbours.size();
+            for (auto n : neighbours)
+                m_neighbours.push_back(uint32_t(n));
+            m_cells.push_back({index, start, m_neighbours.size() - start});
+        }
+
+        void clear() {
+            m_neighbours.clear();
+            m_cells.clear();
+        }
+
+    private:
+        friend class Adjacency;
+
+        struct Entry {
+            size_t index, start, count;
+        };
+
+        std::vector<uint32_t> m_neighbours;
+        std::vector<Entry> m_cells;
+    };
+
+    /// lays out the lists of n cells gathered in unordered batches
+    void assign(size_t n, const std::vector<const Unordered *> &parts) {
+        layout(n, parts);
+        for (const Unordered *part : parts)
+            fill(*part);
+    }
+
+    /// the two halves of assign(), see CellStore::layout() and CellStore::fill()
+    void layout(size_t n, const std::vector<const Unordered *> &parts) {
+        m_offsets.assign(n + 1, 0);
+        for (const Unordered *part : parts)
+            for (const auto &c : part->m_cells)
+                m_offsets[c.index + 1] = uint32_t(c.count);
+        for (size_t i = 0; i < n; ++i)
+            m_offsets[i + 1] += m_offsets[i];
+
+        m_neighbours.resize(m_offsets[n]);
+    }
+
+    void fill(const Unordered &part) {
+        for (const auto &c : part.m_cells) {
+            const uint32_t *src = part.m_neighbours.data() + c.start;
+            std::copy(src, src + c.count, m_neighbours.begin() + m_offsets[c.index]);
+        }
+    }
+
+    /// replaces the lists of a batch in place and grows to n cells, see CellStore::patch()
+    void patch(size_t n, const Unordered &part) {
+        assert(n >= size());
+        std::vector<std::pair<size_t, uint32_t>> sizes;
+        sizes.reserve(part.m_cells.size());
+        for (const auto &c : part.m_cells)
+            sizes.emplace_back(c.index, uint32_t(c.count));
+        std::sort(sizes.begin(), sizes.end());
+
+        const std::vector<detail::RowRun> runs = detail::resizeRows(m_offsets, n, sizes);
+        detail::moveRuns(m_neighbours, runs, m_offsets[n]);
+
+        for (const auto &c : part.m_cells) {
+            const uint32_t *src = part.m_neighbours.data() + c.start;
+            std::copy(src, src + c.count, m_neighbours.begin() + m_offsets[c.index]);
+        }
+    }
+
+private:
+    std::vector<uint32_t> m_neighbours;
+    std::vector<uint32_t> m_offsets;
+};
+
+} // namespace vt
+
+#endif // ADJACENCY_H
@@ -0,0 +1,88 @@
+#ifndef CELL_BUILDER_H
+#define CELL_BUILDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "adjacency.h"
+#include "cell-store.h"
+#include "convex-clip.h"
+#include "instrument.h"
+#include "tiling.h"
+#include "voronoi-cells.h"
+
+namespace vt {
+
+/**
+ * Turns the cells of a diagram into clipped rings, with the cell across each
+ * edge and the list of neighbours when the topology is wanted. Neighbours
+ * come from the twin of each edge, and the labels follow the edges through
+ * the clipping, so an edge lying outside of the tile drops its neighbour.
+ *
+ * One builder per thread, its buffers are reused from one cell to the next.
+ */
+class CellBuilder {
+public:
+    CellBuilder(const ClipRect &rect, double extent, bool topology)
+        : m_rect(rect), m_extent(extent), m_topology(topology) {}
+
+    /// toIndex maps a source index of the diagram to a site index. sites are
+    /// those of the diagram, Grid or 64-bit ones, and quant a GridQuantizer or
+    /// any type offering the same toReal() and scale()
+    template <typename Cell, typename Sites, typename Quant, typename ToIndex>
+    void build(const Cell &c, const Sites &sites, const Quant &quant, ToIndex &&toIndex) {
+        if (!m_topology) {
+            cellRing(c, sites, quant, m_extent, ring);
+            if (clipConvex(ring, m_rect, m_scratch))
+                VT_COUNT(instrument::VORONOI_CELLS_CLIPPED, 1);
+            VT_COUNT(instrument::VORONOI_VERTICES, ring.size());
+            return;
+        }
+
+        cellRing(c, sites, quant, m_extent, ring, m_labels, NO_SOURCE);
+        if (clipConvex(ring, m_labels, m_rect, m_scratch, m_label_scratch, NO_SOURCE))
+            VT_COUNT(instrument::VORONOI_CELLS_CLIPPED, 1);
+        VT_COUNT(instrument::VORONOI_VERTICES, ring.size());
+
+        labels.clear();
+        neighbours.clear();
+        for (size_t k = 0, n = ring.size(); k < n; ++k) {
+            const size_t l = m_labels[k];
+            const CellVertex &a = ring[k];
+            const CellVertex &b = ring[k + 1 < n ? k + 1 : 0];
+
+            labels.push_back(l == NO_SOURCE ? NO_CELL : uint32_t(toIndex(l)));
+            if (l != NO_SOURCE && (a.x() != b.x() || a.y() != b.y()))
+                neighbours.push_back(labels.back());
+        }
+    }
+
+    /// adds the ring built last as the cell of site index
+    void add(size_t index, CellStore::Unordered &cells, Adjacency::Unordered &adjacency) const {
+        if (!m_topology) {
+            cells.add(index, ring);
+            return;
+        }
+        cells.add(index, ring, labels);
+        adjacency.add(index, neighbours);
+    }
+
+    std::vector<CellVertex> ring;
+    std::vector<uint32_t> labels;
+    std::vector<uint32_t> neighbours;
+
+private:
+    // label of the ring edges with no cell across, in diagram source indices
+    static const size_t NO_SOURCE = size_t(-1);
+
+    ClipRect m_rect;
+    double m_extent;
+    bool m_topology;
+    std::vector<CellVertex> m_scratch;
+    std::vector<size_t> m_labels, m_label_scratch;
+};
+
+} // namespace vt
+
+#endif // CELL_BUILDER_H
@@ -0,0 +1,153 @@
+#include "cell-raster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "instrument.h"
+
+namespace vt {
+
+namespace {
+
+/// rows per band, a few bands per thread even out the cell counts
+const int MIN_BAND_ROWS = 8;
+const unsigned BANDS_PER_THREAD = 4;
+
+// first index whose pixel centre (i + 0.5) * scale is at or past v
+int firstCentre(double v, double scale) {
+    return int(std::ceil(v / scale - 0.5));
+}
+
+int wrapIndex(int i, int n) {
+    i %= n;
+    return i < 0 ? i + n : i;
+}
+
+// x extent of a convex ring along the line at height y, false if the ring
+// does not cross it. Edges hold their lower end and not the upper one, and
+// are walked from their lower end: the two cells of an edge see the same
+// crossing, bit for bit.
+bool spanAt(const CellView &cell, double y, double &x0, double &x1) {
+    bool crossed = false;
+    const size_t n = cell.size();
+    for (size_t i = 0; i < n; ++i) {
+        const CellVertex *a = &cell[i];
+        const CellVertex *b = &cell[i + 1 == n ? 0 : i + 1];
+        if (b->y() < a->y())
+            std::swap(a, b);
+        if (!(a->y() <= y && y < b->y()))
+            continue;
+
+        const double x = a->x() + (y - a->y()) * (b->x() - a->x()) / (b->y() - a->y());
+        if (!crossed) {
+            x0 = x1 = x;
+            crossed = true;
+        } else {
+            x0 = std::min(x0, x);
+            x1 = std::max(x1, x);
+        }
+    }
+    return crossed;
+}
+
+} // namespace
+
+void rasterizeCells(const CellStore &cells, double w, double h, int width, int height, CellRaster &raster,
+                    ThreadPool &pool, Wrap wrap) {
+    VT_SCOPE("raster.cells");
+
+    raster.width = std::max(width, 0);
+    raster.height = std::max(height, 0);
+    raster.ids.resize(size_t(raster.width) * size_t(raster.height));
+    if (raster.ids.empty())
+        return;
+
+    const bool wrap_x = (wrap & WRAP_X) != 0;
+    const bool wrap_y = (wrap & WRAP_Y) != 0;
+    const double sx = w / width;
+    const double sy = h / height;
+
+    const int wanted = int(pool.concurrency() * BANDS_PER_THREAD);
+    const int band_rows = std::max(MIN_BAND_ROWS, (height + wanted - 1) / wanted);
+    const int band_count = (height + band_rows - 1) / band_rows;
+
+    // rows of pixel centres within each cell, and the cells crossing each band
+    std::vector<std::pair<int, int>> rows(cells.size());
+    std::vector<std::vector<uint32_t>> bands(band_count);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        const CellView cell = cells[i];
+        if (cell.empty())
+            continue;
+
+        double y0 = cell[0].y(), y1 = y0;
+        for (const CellVertex &v : cell) {
+            y0 = std::min(y0, v.y());
+            y1 = std::max(y1, v.y());
+        }
+        int r0 = firstCentre(y0, sy);
+        int r1 = firstCentre(y1, sy);
+        if (!wrap_y) {
+            r0 = std::max(r0, 0);
+            r1 = std::min(r1, height);
+        } else if (r1 - r0 > height) {
+            r1 = r0 + height;
+        }
+        rows[i] = std::make_pair(r0, r1);
+
+        int last = -1;
+        for (int r = r0; r < r1;) {
+            const int row = wrap_y ? wrapIndex(r, height) : r;
+            const int b = row / band_rows;
+            if (b != last)
+                bands[size_t(b)].push_back(uint32_t(i));
+            last = b;
+            r += std::min((b + 1) * band_rows, height) - row;
+        }
+    }
+
+    pool.parallelFor(0, size_t(band_count), 1, [&](size_t b) {
+        const int band_begin = int(b) * band_rows;
+        const int band_end = std::min(band_begin + band_rows, height);
+        uint32_t *const ids = raster.ids.data();
+        std::fill(ids + size_t(band_begin) * size_t(width), ids + size_t(band_end) * size_t(width), NO_CELL);
+
+        for (uint32_t i : bands[b]) {
+            const CellView cell = cells[i];
+            const int r0 = rows[i].first, r1 = rows[i].second;
+
+            // the copies of the band in the periods the rows of the cell span
+            const int first = wrap_y ? r0 - wrapIndex(r0, height) : 0;
+            const int last = wrap_y ? r1 : 1;
+            for (int period = first; period < last; period += height) {
+                const int begin = std::max(r0, band_begin + period);
+                const int end = std::min(r1, band_end + period);
+                for (int r = begin; r < end; ++r) {
+                    double x0, x1;
+                    if (!spanAt(cell, (r + 0.5) * sy, x0, x1))
+                        continue;
+                    int c0 = firstCentre(x0, sx);
+                    int c1 = firstCentre(x1, sx);
+
+                    uint32_t *const line = ids + size_t(r - period) * size_t(width);
+                    if (!wrap_x) {
+                        c0 = std::max(c0, 0);
+                        c1 = std::min(c1, width);
+                        if (c0 < c1)
+                            std::fill(line + c0, line + c1, i);
+                    } else if (c1 - c0 >= width) {
+                        std::fill(line, line + width, i);
+                    } else if (c0 < c1) {
+                        const int s0 = wrapIndex(c0, width);
+                        const int s1 = s0 + (c1 - c0);
+                        std::fill(line + s0, line + std::min(s1, width), i);
+                        if (s1 > width)
+                            std::fill(line, line + (s1 - width), i);
+                    }
+                }
+            }
+        }
+    });
+}
+
+} // namespace vt
@@ -0,0 +1,44 @@
+#ifndef CELL_RASTER_H
+#define CELL_RASTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "adjacency.h"
+#include "cell-store.h"
+#include "thread-pool.h"
+#include "tiling.h"
+
+namespace vt {
+
+/**
+ * Per pixel cell index of a tile, for the consumers that look cells up by
+ * position rather than walk their polygons. Pixel (x, y) covers
+ * [x, x+1) x [y, y+1) of the tile scaled to width x height pixels, and holds
+ * the cell containing its centre, NO_CELL where no cell does.
+ */
+struct CellRaster {
+    int width = 0, height = 0;
+    std::vector<uint32_t> ids;   ///< row-major, width * height
+
+    uint32_t at(int x, int y) const { return ids[size_t(y) * size_t(width) + size_t(x)]; }
+};
+
+/**
+ * Scanline rasterization of the convex cells of a w x h tile into raster,
+ * resized to width x height pixels.
+ *
+ * The rows are split in bands rasterized in parallel on the pool, every
+ * band filling the spans of the cells crossing it: each pixel is written by
+ * one band only. Spans are half-open at the pixel centres and a shared
+ * edge gives both of its cells the same crossings, so the pixels along it
+ * go to exactly one of them. Cells running past a wrapped border, see
+ * computeVoronoiWrapped(), are drawn modulo the tile size.
+ */
+void rasterizeCells(const CellStore &cells, double w, double h, int width, int height, CellRaster &raster,
+                    ThreadPool &pool = defaultPool(), Wrap wrap = WRAP_NONE);
+
+} // namespace vt
+
+#endif // CELL_RASTER_H
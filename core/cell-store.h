@@ -0,0 +1,260 @@
+#ifndef CELL_STORE_H
+#define CELL_STORE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "csr-rows.h"
+
+namespace vt {
+
+/// vertex of a Voronoi cell, in tile coordinates
+struct CellVertex {
+    double px, py;
+
+    CellVertex() : px(0.0), py(0.0) {}
+    CellVertex(double x, double y) : px(x), py(y) {}
+
+    double x() const { return px; }
+    double y() const { return py; }
+};
+
+/**
+ * Read-only view over the vertices of one cell, an open ring: the last
+ * vertex connects back to the first one and is not repeated.
+ */
+class CellView {
+public:
+    CellView() : m_begin(nullptr), m_end(nullptr) {}
+    CellView(const CellVertex *begin, const CellVertex *end) : m_begin(begin), m_end(end) {}
+
+    const CellVertex *begin() const { return m_begin; }
+    const CellVertex *end() const { return m_end; }
+    const CellVertex *data() const { return m_begin; }
+    size_t size() const { return size_t(m_end - m_begin); }
+    bool empty() const { return m_begin == m_end; }
+    const CellVertex &operator[](size_t i) const { return m_begin[i]; }
+
+private:
+    const CellVertex *m_begin, *m_end;
+};
+
+/**
+ * Flat storage of all the cells of a tiling, indexed by site index.
+ *
+ * The vertices of every cell live back to back in one array, and cell i spans
+ * [offsets[i], offsets[i+1]) of it (compressed sparse rows).
+ *
+ * Compared to one QPolygonF per cell, at n cells of about 6 vertices:
+ *  - std::vector<QPolygonF>: n heap blocks, each holding a 24 byte QArrayData
+ *    header, 16 bytes per vertex of a closed ring and the allocator overhead,
+ *    plus n 8 byte d-pointers with an atomic reference count touched on every
+ *    copy. That is about 160 bytes per cell scattered over the heap, and n
+ *    allocations to build or free.
+ *  - CellStore: 16 bytes per vertex plus one 4 byte offset per cell, about
+ *    100 bytes per cell, in two allocations. Passes over all the cells (area,
+ *    drawing, export) stream through memory in index order, and a cell
+ *    neighbour in index order is also its neighbour in memory.
+ *
+ * Offsets are 32-bit, which bounds a store to 2^32 vertices.
+ */
+class CellStore {
+public:
+    CellStore() : m_offsets(1, 0) {}
+
+    /// number of cells
+    size_t size() const { return m_offsets.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    CellView operator[](size_t i) const {
+        assert(i < size());
+        const CellVertex *base = m_vertices.data();
+        return CellView(base + m_offsets[i], base + m_offsets[i + 1]);
+    }
+
+    const std::vector<CellVertex> &vertices() const { return m_vertices; }
+    const std::vector<uint32_t> &offsets() const { return m_offsets; }
+
+    void clear() {
+        m_vertices.clear();
+        m_offsets.assign(1, 0);
+    }
+
+    void reserve(size_t cells, size_t vertices) {
+        m_offsets.reserve(cells + 1);
+        m_vertices.reserve(vertices);
+    }
+
+    /// appends the next cell, cells must be added in index order
+    template <typename Ring>
+    void append(const Ring &ring) {
+        for (const auto &p : ring)
+            m_vertices.emplace_back(p.x(), p.y());
+        m_offsets.push_back(uint32_t(m_vertices.size()));
+    }
+
+    /// appends an empty cell, e.g. for a duplicated site
+    void appendEmpty() {
+        m_offsets.push_back(uint32_t(m_vertices.size()));
+    }
+
+    /**
+     * Cells produced in an arbitrary order, e.g. the order of a Voronoi
+     * diagram or of several workers, waiting to be laid out by index.
+     * Cells may carry one 32-bit label per vertex, laid out along with them.
+     */
+    class Unordered {
+    public:
+        template <typename Ring>
+        void add(size_t index, const Ring &ring) {
+            const size_t start = m_vertices.size();
+            for (const auto &p : ring)
+                m_vertices.emplace_back(p.x(), p.y());
+            m_cells.push_back({index, start, m_vertices.size() - start});
+        }
+
+        template <typename Ring, typename Labels>
+        void add(size_t index, const Ring &ring, const Labels &labels) {
+            assert(labels.size() == ring.size());
+            add(index, ring);
+            for (auto l : labels)
+                m_labels.push_back(uint32_t(l));
+        }
+
+        /// number of cells added so far
+        size_t size() const { return m_cells.size(); }
+
+        void clear() {
+            m_vertices.clear();
+            m_labels.clear();
+            m_cells.clear();
+        }
+
+    private:
+        friend class CellStore;
+
+        struct Entry {
+            size_t index, start, count;
+        };
+
+        std::vector<CellVertex> m_vertices;
+        std::vector<uint32_t> m_labels;
+        std::vector<Entry> m_cells;
+    };
+
+    /**
+     * Lays out n cells gathered in one or more unordered batches, cells
+     * absent from every batch are left empty. labels, if given, receives the
+     * vertex labels in the order of vertices(), batches must then have been
+     * filled with labels.
+     */
+    void assign(size_t n, const std::vector<const Unordered *> &parts,
+                std::vector<uint32_t> *labels = nullptr) {
+        layout(n, parts, labels);
+        for (const Unordered *part : parts)
+            fill(*part, labels);
+    }
+
+    /**
+     * First half of assign(): sizes the arrays for the batches, offsets
+     * final and vertices (and labels) left to fill(). Cells absent from
+     * every batch are empty.
+     */
+    void layout(size_t n, const std::vector<const Unordered *> &parts,
+                std::vector<uint32_t> *labels = nullptr) {
+        m_offsets.assign(n + 1, 0);
+        for (const Unordered *part : parts)
+            for (const auto &c : part->m_cells)
+                m_offsets[c.index + 1] = uint32_t(c.count);
+        for (size_t i = 0; i < n; ++i)
+            m_offsets[i + 1] += m_offsets[i];
+
+        m_vertices.resize(m_offsets[n]);
+        if (labels)
+            labels->assign(m_offsets[n], 0);
+    }
+
+    /**
+     * Second half of assign(): copies the cells of one of the batches laid
+     * out into place. Batches hold distinct cells and write disjoint ranges,
+     * they can be filled concurrently.
+     */
+    void fill(const Unordered &part, std::vector<uint32_t> *labels = nullptr) {
+        for (const auto &c : part.m_cells) {
+            const CellVertex *src = part.m_vertices.data() + c.start;
+            std::copy(src, src + c.count, m_vertices.begin() + m_offsets[c.index]);
+
+            if (labels) {
+                assert(part.m_labels.size() == part.m_vertices.size());
+                const uint32_t *l = part.m_labels.data() + c.start;
+                std::copy(l, l + c.count, labels->begin() + m_offsets[c.index]);
+            }
+        }
+    }
+
+    /**
+     * Replaces the cells of a batch and grows the store to n cells, the new
+     * cells the batch does not hold being empty. The arrays are patched in
+     * place, only the cells past the first one changing its vertex count
+     * being moved. labels are the vertex labels laid out by assign(),
+     * patched alongside, or null.
+     */
+    void patch(size_t n, const Unordered &part, std::vector<uint32_t> *labels = nullptr) {
+        assert(n >= size());
+        std::vector<std::pair<size_t, uint32_t>> sizes;
+        sizes.reserve(part.m_cells.size());
+        for (const auto &c : part.m_cells)
+            sizes.emplace_back(c.index, uint32_t(c.count));
+        std::sort(sizes.begin(), sizes.end());
+
+        const std::vector<detail::RowRun> runs = detail::resizeRows(m_offsets, n, sizes);
+        detail::moveRuns(m_vertices, runs, m_offsets[n]);
+        if (labels)
+            detail::moveRuns(*labels, runs, m_offsets[n]);
+
+        for (const auto &c : part.m_cells) {
+            const CellVertex *src = part.m_vertices.data() + c.start;
+            std::copy(src, src + c.count, m_vertices.begin() + m_offsets[c.index]);
+            if (labels) {
+                assert(part.m_labels.size() == part.m_vertices.size());
+                const uint32_t *l = part.m_labels.data() + c.start;
+                std::copy(l, l + c.count, labels->begin() + m_offsets[c.index]);
+            }
+        }
+    }
+
+private:
+    std::vector<CellVertex> m_vertices;
+    std::vector<uint32_t> m_offsets;
+};
+
+/// signed area of a cell, positive for counter-clockwise rings
+inline double area(const CellView &cell) {
+    const size_t n = cell.size();
+    double a = 0.0;
+    for (size_t i = 0, j = n - 1; i < n; j = i++)
+        a += cell[j].x() * cell[i].y() - cell[i].x() * cell[j].y();
+    return 0.5 * a;
+}
+
+/// area-weighted centroid of a cell, the first vertex for a degenerate one
+inline CellVertex centroid(const CellView &cell) {
+    const size_t n = cell.size();
+    double a = 0.0, cx = 0.0, cy = 0.0;
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+        const double cross = cell[j].x() * cell[i].y() - cell[i].x() * cell[j].y();
+        a += cross;
+        cx += (cell[j].x() + cell[i].x()) * cross;
+        cy += (cell[j].y() + cell[i].y()) * cross;
+    }
+    if (a == 0.0)
+        return n ? cell[0] : CellVertex();
+    return CellVertex(cx / (3.0 * a), cy / (3.0 * a));
+}
+
+} // namespace vt
+
+#endif // CELL_STORE_H
@@ -0,0 +1,253 @@
+#include "chunked-world.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/polygon/point_data.hpp>
+#include <boost/polygon/voronoi.hpp>
+
+#include "convex-clip.h"
+#include "poisson-grid.h"
+#include "quantizer.h"
+#include "voronoi-cells.h"
+
+namespace vt {
+
+namespace {
+
+// height in chunks of the stripes walked by generate()
+const int64_t STRIPE = 4;
+
+int phaseOf(int64_t cx, int64_t cy) {
+    return int(cx & 1) + 2 * int(cy & 1);
+}
+
+} // namespace
+
+ChunkedWorld::ChunkedWorld(const ChunkedWorldSettings &settings)
+    : m_settings(settings)
+    , m_sitesBuilt(0)
+{
+    // a chunk must be wide enough to keep chunks of the same colour apart,
+    // and the sampling margin of a chunk within its direct neighbours
+    m_settings.chunkSize = std::max(m_settings.chunkSize, 4.0 * m_settings.minDist);
+    m_chunksX = int64_t(std::ceil(m_settings.width / m_settings.chunkSize));
+    m_chunksY = int64_t(std::ceil(m_settings.height / m_settings.chunkSize));
+}
+
+bool ChunkedWorld::contains(int64_t cx, int64_t cy) const {
+    return cx >= 0 && cy >= 0 && cx < m_chunksX && cy < m_chunksY;
+}
+
+ChunkedWorld::Sites ChunkedWorld::sites(int64_t cx, int64_t cy) {
+    const Key key{cx, cy};
+    auto it = m_cache.find(key);
+    if (it != m_cache.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.use);
+        return it->second.sites;
+    }
+
+    // may recurse into the neighbours, the cache is only touched afterwards
+    Sites built = std::make_shared<const std::vector<CellVertex>>(sampleSites(cx, cy));
+    ++m_sitesBuilt;
+
+    m_lru.push_front(key);
+    m_cache[key] = Entry{built, m_lru.begin()};
+
+    while (m_settings.cachedChunks && m_cache.size() > m_settings.cachedChunks) {
+        m_cache.erase(m_lru.back());
+        m_lru.pop_back();
+    }
+
+    return built;
+}
+
+// Bridson's algorithm on the chunk and a margin of 2 minDist around it,
+// mapped to the unit square of the Poisson generator. The sites of the
+// neighbours sampled earlier are inserted in the margin as obstacles and
+// used as seeds, new samples are kept inside of the chunk only.
+std::vector<CellVertex> ChunkedWorld::sampleSites(int64_t cx, int64_t cy) {
+    using namespace PoissonGenerator;
+
+    const double c = m_settings.chunkSize;
+    const double x0 = cx * c, y0 = cy * c;
+    const double x1 = std::min(x0 + c, m_settings.width);
+    const double y1 = std::min(y0 + c, m_settings.height);
+
+    const double margin = 2.0 * m_settings.minDist;
+    const double ox = x0 - margin, oy = y0 - margin;
+    const double side = c + 2.0 * margin;
+    const float dist = float(m_settings.minDist / side);
+    const int cells = GridSizeFor(dist);
+
+    auto toLocal = [&](double x, double y) {
+        return sPoint(float((x - ox) / side), float((y - oy) / side));
+    };
+    auto toWorld = [&](const sPoint &p) {
+        return CellVertex(ox + double(p.x) * side, oy + double(p.y) * side);
+    };
+
+    sGrid grid(cells, cells, dist);
+    std::vector<sPoint> process;
+
+    const int phase = phaseOf(cx, cy);
+    for (int64_t ny = cy - 1; ny <= cy + 1; ++ny) {
+        for (int64_t nx = cx - 1; nx <= cx + 1; ++nx) {
+            if (!contains(nx, ny) || phaseOf(nx, ny) >= phase)
+                continue;
+
+            Sites around = sites(nx, ny);
+            for (const CellVertex &v : *around) {
+                const sPoint p = toLocal(v.x(), v.y());
+                if (p.IsInRectangle()) {
+                    grid.Insert(p);
+                    process.push_back(p);
+                }
+            }
+        }
+    }
+
+    PcgPRNG generator = PcgPRNG(m_settings.seed).Stream(uint64_t(cy) * uint64_t(m_chunksX) + uint64_t(cx));
+    sCandidateBatch batch(m_settings.newPointsCount);
+    std::vector<CellVertex> result;
+
+    auto owns = [&](const sPoint &p) {
+        const CellVertex v = toWorld(p);
+        return v.x() >= x0 && v.x() < x1 && v.y() >= y0 && v.y() < y1;
+    };
+    auto accept = [&](const sPoint &p) {
+        process.push_back(p);
+        result.push_back(toWorld(p));
+        grid.Insert(p);
+    };
+
+    // a few darts for chunks with no sample around them yet
+    for (int t = 0; process.empty() && t < m_settings.newPointsCount; ++t) {
+        const sPoint p = toLocal(x0 + generator.RandomFloat() * (x1 - x0),
+                                 y0 + generator.RandomFloat() * (y1 - y0));
+        if (owns(p) && !grid.IsInNeighbourhood(p))
+            accept(p);
+    }
+
+    while (!process.empty()) {
+        const sPoint p = PopRandom(process, generator);
+        TryPointsAround(p, dist, sRectangleDomain(), generator, batch, grid, owns, accept);
+    }
+
+    return result;
+}
+
+// Diagram of the sites of the chunk and of a band of the given width around
+// it, quantized relatively to the corner of that window. Fills found with the
+// exact cells still marked in todo and returns whether none is left.
+bool ChunkedWorld::buildCells(Chunk &chunk, double halo, std::vector<char> &todo,
+                              CellStore::Unordered &found) {
+    using Point = boost::polygon::point_data<int32_t>;
+
+    const SiteWindow window{std::max(chunk.x0 - halo, 0.0), std::max(chunk.y0 - halo, 0.0),
+                            std::min(chunk.x1 + halo, m_settings.width),
+                            std::min(chunk.y1 + halo, m_settings.height),
+                            chunk.x0 - halo > 0.0, chunk.y0 - halo > 0.0,
+                            chunk.x1 + halo < m_settings.width, chunk.y1 + halo < m_settings.height};
+
+    const double c = m_settings.chunkSize;
+    const int64_t first_x = int64_t(window.x0 / c);
+    const int64_t first_y = int64_t(window.y0 / c);
+    const int64_t last_x = std::min(int64_t(std::ceil(window.x1 / c)), m_chunksX) - 1;
+    const int64_t last_y = std::min(int64_t(std::ceil(window.y1 / c)), m_chunksY) - 1;
+
+    const double extent = std::max(window.x1 - window.x0, window.y1 - window.y0);
+    const Quantizer32 quant(window.x1 - window.x0, window.y1 - window.y0);
+
+    // sites of the chunk first, so that they win over coincident neighbours
+    std::vector<Point> all;
+    auto add = [&](const std::vector<CellVertex> &sites) {
+        for (const CellVertex &v : sites) {
+            if (v.x() >= window.x0 && v.x() < window.x1 && v.y() >= window.y0 && v.y() < window.y1)
+                all.emplace_back(quant.toInt(v.x() - window.x0), quant.toInt(v.y() - window.y0));
+        }
+    };
+
+    add(chunk.sites);
+    for (int64_t ny = first_y; ny <= last_y; ++ny) {
+        for (int64_t nx = first_x; nx <= last_x; ++nx) {
+            if (nx != chunk.cx || ny != chunk.cy)
+                add(*sites(nx, ny));
+        }
+    }
+
+    std::vector<Point> local;
+    std::vector<size_t> origin;
+    uniqueSites(all, local, origin);
+
+    boost::polygon::voronoi_diagram<double> vd;
+    boost::polygon::construct_voronoi(local.begin(), local.end(), &vd);
+
+    const ClipRect world{0.0, 0.0, m_settings.width, m_settings.height};
+    std::vector<CellVertex> ring, scratch;
+    bool done = true;
+
+    for (auto &cell : vd.cells()) {
+        const size_t i = origin[cell.source_index()];
+        if (i >= chunk.sites.size() || !todo[i])
+            continue;
+
+        cellRing(cell, local, quant, extent, ring);
+        for (CellVertex &v : ring) {
+            v.px += window.x0;
+            v.py += window.y0;
+        }
+        clipConvex(ring, world, scratch);
+
+        const Point &s = local[cell.source_index()];
+        if (isExactCell(ring, window.x0 + quant.toReal(s.x()), window.y0 + quant.toReal(s.y()), window)) {
+            found.add(i, ring);
+            todo[i] = 0;
+        }
+        else {
+            done = false;
+        }
+    }
+
+    return done;
+}
+
+Chunk ChunkedWorld::chunk(int64_t cx, int64_t cy) {
+    const double c = m_settings.chunkSize;
+
+    Chunk result;
+    result.cx = cx;
+    result.cy = cy;
+    result.x0 = cx * c;
+    result.y0 = cy * c;
+    result.x1 = std::min(result.x0 + c, m_settings.width);
+    result.y1 = std::min(result.y0 + c, m_settings.height);
+    result.sites = *sites(cx, cy);
+
+    const size_t n = result.sites.size();
+    std::vector<char> todo(n, 1);
+    CellStore::Unordered found;
+
+    // a Poisson sampling leaves no empty disc wider than 2 minDist, so the
+    // first band is almost always enough, and one covering the whole world
+    // always gives exact cells
+    const double widest = std::max(m_settings.width, m_settings.height);
+    double halo = 3.0 * m_settings.minDist;
+    while (!buildCells(result, halo, todo, found) && halo < widest)
+        halo *= 2.0;
+
+    result.cells.assign(n, {&found});
+    return result;
+}
+
+void ChunkedWorld::generate(const ChunkSink &sink) {
+    for (int64_t y0 = 0; y0 < m_chunksY; y0 += STRIPE) {
+        const int64_t y1 = std::min(y0 + STRIPE, m_chunksY);
+        for (int64_t cx = 0; cx < m_chunksX; ++cx) {
+            for (int64_t cy = y0; cy < y1; ++cy)
+                sink(chunk(cx, cy));
+        }
+    }
+}
+
+} // namespace vt
@@ -0,0 +1,114 @@
+#ifndef CHUNKED_WORLD_H
+#define CHUNKED_WORLD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "cell-store.h"
+
+namespace vt {
+
+/// one finished chunk of a chunked world, cell i is the cell of site i
+struct Chunk {
+    int64_t cx, cy;             ///< chunk coordinates
+    double x0, y0, x1, y1;      ///< bounds in world coordinates
+    std::vector<CellVertex> sites;
+    CellStore cells;
+};
+
+using ChunkSink = std::function<void(const Chunk &)>;
+
+struct ChunkedWorldSettings {
+    double width = 0.0;         ///< world size
+    double height = 0.0;
+    double chunkSize = 256.0;   ///< edge of a chunk, at least 4 minDist
+    double minDist = 1.0;       ///< Poisson distance between sites
+    uint64_t seed = 0;
+    int newPointsCount = 30;
+    size_t cachedChunks = 128;  ///< site sets kept around, 0 for no limit
+};
+
+/**
+ * World of Poisson sites and clipped Voronoi cells produced one square chunk
+ * at a time, for worlds too large to be held in memory at once.
+ *
+ * Sites: every site belongs to the chunk it lies in. Chunks are coloured in
+ * a 2x2 pattern, and a chunk samples its own area once the neighbours of the
+ * colours before its own are known, growing from their sites close to its
+ * border and rejecting candidates too close to them. The sites of a chunk
+ * therefore only depend on the seed and on a bounded neighbourhood, any
+ * chunk can be rebuilt on its own, and two chunks always see the same sites
+ * along their shared border: the ones of whichever chunk owns them.
+ *
+ * Cells: a chunk builds the diagram of its sites and those of a narrow band
+ * around it, keeps the cells of its sites and checks them with
+ * isExactCell(). Cells failing the check, which needs an unusually large
+ * empty area, are rebuilt from a band twice as wide. Cells are clipped to
+ * the world rather than the chunk, so they are whole and shared borders are
+ * exact up to rounding.
+ *
+ * Memory is bounded by the site sets in the cache, evicted ones are rebuilt
+ * on demand, and by the cells of the chunk being built.
+ */
+class ChunkedWorld {
+public:
+    using Sites = std::shared_ptr<const std::vector<CellVertex>>;
+
+    explicit ChunkedWorld(const ChunkedWorldSettings &settings);
+
+    const ChunkedWorldSettings &settings() const { return m_settings; }
+    int64_t chunksX() const { return m_chunksX; }
+    int64_t chunksY() const { return m_chunksY; }
+
+    /// sites owned by chunk (cx, cy), in world coordinates
+    Sites sites(int64_t cx, int64_t cy);
+
+    /// sites and clipped cells of chunk (cx, cy)
+    Chunk chunk(int64_t cx, int64_t cy);
+
+    /**
+     * Builds every chunk and hands it to sink. Chunks go by stripes a few
+     * chunks high, column after column, which keeps the site sets needed by
+     * consecutive chunks within the cache.
+     */
+    void generate(const ChunkSink &sink);
+
+    /// number of site sets built so far, evicted ones counting every time
+    size_t sitesBuilt() const { return m_sitesBuilt; }
+
+private:
+    bool contains(int64_t cx, int64_t cy) const;
+    std::vector<CellVertex> sampleSites(int64_t cx, int64_t cy);
+    bool buildCells(Chunk &chunk, double halo, std::vector<char> &todo,
+                    CellStore::Unordered &found);
+
+    struct Key {
+        int64_t cx, cy;
+        bool operator==(const Key &o) const { return cx == o.cx && cy == o.cy; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key &k) const {
+            return std::hash<uint64_t>()(uint64_t(k.cx) * 0x9E3779B97F4A7C15ULL ^ uint64_t(k.cy));
+        }
+    };
+    struct Entry {
+        Sites sites;
+        std::list<Key>::iterator use;
+    };
+
+    ChunkedWorldSettings m_settings;
+    int64_t m_chunksX;
+    int64_t m_chunksY;
+    std::unordered_map<Key, Entry, KeyHash> m_cache;
+    std::list<Key> m_lru;       ///< most recently used first
+    size_t m_sitesBuilt;
+};
+
+} // namespace vt
+
+#endif // CHUNKED_WORLD_H
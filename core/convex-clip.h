@@ -0,0 +1,121 @@
+#ifndef CONVEX_CLIP_H
+#define CONVEX_CLIP_H
+
+#include <cstddef>
+#include <type_traits>
+
+namespace vt {
+
+/// axis-aligned clipping window [x0,x1]x[y0,y1]
+struct ClipRect {
+    double x0, y0, x1, y1;
+
+    template <typename P>
+    bool contains(const P &p) const {
+        return p.x() >= x0 && p.x() <= x1 && p.y() >= y0 && p.y() <= y1;
+    }
+};
+
+namespace detail {
+
+// stands for the edge labels when they are not tracked
+struct NoLabels {
+    using value_type = int;
+
+    void clear() {}
+    void push_back(int) {}
+    int operator[](int) const { return 0; }
+};
+
+// one Sutherland-Hodgman pass against the half plane coord(p) <= bound
+// (or >= bound with KeepAbove), reading src and writing dst. Label i is the
+// label of the edge from vertex i to the next one, the pieces of an edge
+// keep its label and the edges created along the bound get outside.
+template <bool Vertical, bool KeepAbove, typename Poly, typename Labels>
+void clipEdge(const Poly &src, const Labels &src_labels, Poly &dst, Labels &dst_labels,
+              double bound, typename Labels::value_type outside) {
+    using Point = typename std::decay<decltype(src[0])>::type;
+
+    dst.clear();
+    dst_labels.clear();
+    const int n = int(src.size());
+    if (n == 0)
+        return;
+
+    auto coord = [](const Point &p) { return Vertical ? p.x() : p.y(); };
+    auto inside = [&](const Point &p) { return KeepAbove ? coord(p) >= bound : coord(p) <= bound; };
+    auto cut = [&](const Point &p, const Point &q) {
+        const double t = (bound - coord(p)) / (coord(q) - coord(p));
+        return Vertical ? Point(bound, p.y() + t * (q.y() - p.y()))
+                        : Point(p.x() + t * (q.x() - p.x()), bound);
+    };
+
+    Point prev = src[n - 1];
+    int prev_i = n - 1;
+    bool prev_in = inside(prev);
+    for (int i = 0; i < n; ++i) {
+        const Point &cur = src[i];
+        const bool cur_in = inside(cur);
+        if (cur_in != prev_in) {
+            dst.push_back(cut(prev, cur));
+            dst_labels.push_back(prev_in ? outside : src_labels[prev_i]);
+        }
+        if (cur_in) {
+            dst.push_back(cur);
+            dst_labels.push_back(src_labels[i]);
+        }
+        prev = cur;
+        prev_i = i;
+        prev_in = cur_in;
+    }
+}
+
+} // namespace detail
+
+/**
+ * clipConvex() variant also maintaining one label per edge: labels[i] is
+ * the label of the edge going from poly[i] to the next vertex, e.g. the cell
+ * on the other side of it. The pieces of an edge keep its label and the
+ * edges that run along the rectangle get outside.
+ */
+template <typename Poly, typename Labels>
+bool clipConvex(Poly &poly, Labels &labels, const ClipRect &r, Poly &scratch, Labels &label_scratch,
+                typename Labels::value_type outside) {
+    bool inside = true;
+    for (int i = 0, n = int(poly.size()); i < n && inside; ++i)
+        inside = r.contains(poly[i]);
+
+    if (inside)
+        return false;
+
+    detail::clipEdge<true, true>(poly, labels, scratch, label_scratch, r.x0, outside);
+    detail::clipEdge<true, false>(scratch, label_scratch, poly, labels, r.x1, outside);
+    detail::clipEdge<false, true>(poly, labels, scratch, label_scratch, r.y0, outside);
+    detail::clipEdge<false, false>(scratch, label_scratch, poly, labels, r.y1, outside);
+    return true;
+}
+
+/**
+ * Clips a convex polygon against an axis-aligned rectangle, in place.
+ *
+ * poly is an open ring (last vertex not repeated). Polygons lying entirely
+ * inside the rectangle are left untouched, which is the common case for
+ * Voronoi cells away from the tile border. Otherwise the four Sutherland-Hodgman
+ * passes ping-pong between poly and scratch, so that a caller reusing the
+ * same scratch container across cells performs no allocation once both have
+ * grown to the largest cell size.
+ *
+ * Works with any random access container of points offering x(), y(), a
+ * (x, y) constructor, clear() and push_back(), e.g. QPolygonF.
+ *
+ * @return true if the polygon had to be clipped
+ */
+template <typename Poly>
+bool clipConvex(Poly &poly, const ClipRect &r, Poly &scratch) {
+    detail::NoLabels labels, label_scratch;
+    return clipConvex(poly, labels, r, scratch, label_scratch, 0);
+}
+
+} // namespace vt
+
+#endif // CONVEX_CLIP_H
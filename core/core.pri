@@ -0,0 +1,7 @@
+# links a target of a sibling directory against the core library
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+LIBS += -L$$OUT_PWD/../core -lvtcore -lpthread
+PRE_TARGETDEPS += $$OUT_PWD/../core/libvtcore.a
@@ -0,0 +1,39 @@
+include(../common.pri)
+
+TEMPLATE = lib
+TARGET = vtcore
+
+CONFIG += staticlib
+CONFIG -= qt
+
+SOURCES += \
+        cell-raster.cpp \
+        chunked-world.cpp \
+        editable-tiling.cpp \
+        instrument.cpp \
+        regions.cpp \
+        relaxation.cpp \
+        tile-cache.cpp \
+        tile-format.cpp \
+        tiling.cpp
+
+HEADERS += \
+        adjacency.h \
+        cell-builder.h \
+        cell-raster.h \
+        cell-store.h \
+        chunked-world.h \
+        convex-clip.h \
+        csr-rows.h \
+        editable-tiling.h \
+        instrument.h \
+        poisson-grid.h \
+        progress.h \
+        quantizer.h \
+        regions.h \
+        relaxation.h \
+        thread-pool.h \
+        tile-cache.h \
+        tile-format.h \
+        tiling.h \
+        voronoi-cells.h
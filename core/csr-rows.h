@@ -0,0 +1,84 @@
+#ifndef CSR_ROWS_H
+#define CSR_ROWS_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace vt {
+
+namespace detail {
+
+/// items [from, from + size) of kept rows, to be moved to [to, to + size)
+struct RowRun {
+    uint32_t from, to, size;
+};
+
+/**
+ * Resizes rows of a compressed sparse rows layout in place: the rows in
+ * sizes, sorted by index, get their new item count and the layout grows to
+ * n rows, the added ones being empty. Only the offsets past the first
+ * resized row are touched, and the runs of kept items that moved are
+ * returned for moveRuns().
+ */
+inline std::vector<RowRun> resizeRows(std::vector<uint32_t> &offsets, size_t n,
+                                      const std::vector<std::pair<size_t, uint32_t>> &sizes) {
+    assert(n + 1 >= offsets.size());
+    const uint32_t end = offsets.back();
+    offsets.resize(n + 1, end);
+
+    std::vector<RowRun> runs;
+    if (sizes.empty())
+        return runs;
+
+    // offsets[row] is final and old_pos is its value before the resize
+    size_t row = sizes.front().first;
+    uint32_t old_pos = offsets[row];
+    auto keep = [&](size_t end) {
+        const int64_t delta = int64_t(offsets[row]) - old_pos;
+        if (end > row && offsets[end] > old_pos && delta != 0)
+            runs.push_back({old_pos, uint32_t(old_pos + delta), offsets[end] - old_pos});
+        for (size_t j = row + 1; j <= end; ++j)
+            offsets[j] = uint32_t(offsets[j] + delta);
+    };
+
+    for (const auto &s : sizes) {
+        keep(s.first);
+        old_pos = offsets[s.first + 1];
+        offsets[s.first + 1] = offsets[s.first] + s.second;
+        row = s.first + 1;
+    }
+    keep(n);
+
+    return runs;
+}
+
+/// moves the kept items of one array after resizeRows(), size being the new item count
+template <typename T>
+void moveRuns(std::vector<T> &items, const std::vector<RowRun> &runs, size_t size) {
+    if (size > items.size())
+        items.resize(size);
+
+    // runs going to lower positions only overlap the ones before, which
+    // went already, and the other way around
+    for (const RowRun &r : runs) {
+        if (r.to < r.from)
+            std::copy(items.begin() + r.from, items.begin() + r.from + r.size, items.begin() + r.to);
+    }
+    for (auto r = runs.rbegin(); r != runs.rend(); ++r) {
+        if (r->to > r->from)
+            std::copy_backward(items.begin() + r->from, items.begin() + r->from + r->size,
+                               items.begin() + r->to + r->size);
+    }
+
+    items.resize(size);
+}
+
+} // namespace detail
+
+} // namespace vt
+
+#endif // CSR_ROWS_H
@@ -0,0 +1,297 @@
+#include "editable-tiling.h"
+
+#include <algorithm>
+#include <deque>
+
+#include <boost/polygon/voronoi.hpp>
+
+#include "cell-builder.h"
+#include "quantizer.h"
+
+namespace vt {
+
+EditableTiling::EditableTiling(int w, int h, const Grid &sites)
+    : m_w(w)
+    , m_h(h)
+    , m_quant(w, h)
+    , m_sites(sites)
+    , m_removed(sites.size(), 0)
+{
+    m_cells = computeVoronoi(m_sites, w, h, defaultPool(), &m_adjacency, &m_edges);
+    for (size_t i = 0; i < m_cells.size(); ++i) {
+        if (m_cells[i].empty())
+            m_hidden.push_back(i);
+    }
+}
+
+// whether the cell has a vertex closer to q than to its own site, i.e. q
+// would take part of it
+bool EditableTiling::conflicts(size_t cell, const Site &q) const {
+    const double qx = toReal(q.x()), qy = toReal(q.y());
+    const double sx = toReal(m_sites[cell].x()), sy = toReal(m_sites[cell].y());
+
+    for (const CellVertex &v : m_cells[cell]) {
+        const double dq = (v.x() - qx) * (v.x() - qx) + (v.y() - qy) * (v.y() - qy);
+        const double ds = (v.x() - sx) * (v.x() - sx) + (v.y() - sy) * (v.y() - sy);
+        if (dq < ds)
+            return true;
+    }
+    return false;
+}
+
+namespace {
+
+// whether the counter-clockwise ring holds (x, y), its border included
+bool contains(const CellView &ring, double x, double y) {
+    for (size_t i = 0, n = ring.size(); i < n; ++i) {
+        const CellVertex &a = ring[i], &b = ring[(i + 1) % n];
+        const double cross = (b.x() - a.x()) * (y - a.y()) - (b.y() - a.y()) * (x - a.x());
+        if (cross < -1e-9)
+            return false;
+    }
+    return !ring.empty();
+}
+
+} // namespace
+
+// Cell holding q: greedy walk over the adjacency towards q, which ends on
+// the nearest site, and a scan of every cell should it stop short, which
+// only happens along the tile border where clipped edges break the walk.
+size_t EditableTiling::locate(const Site &q, size_t start) const {
+    auto dist2 = [&](size_t i) {
+        const double dx = double(m_sites[i].x()) - q.x();
+        const double dy = double(m_sites[i].y()) - q.y();
+        return dx * dx + dy * dy;
+    };
+
+    if (start >= m_cells.size() || m_cells[start].empty()) {
+        start = 0;
+        while (start < m_cells.size() && m_cells[start].empty())
+            ++start;
+        if (start == m_cells.size())
+            return start;
+    }
+
+    size_t cur = start;
+    double best = dist2(cur);
+    for (bool moved = true; moved;) {
+        moved = false;
+        for (uint32_t n : m_adjacency[cur]) {
+            const double d = dist2(n);
+            if (d < best) {
+                best = d;
+                cur = n;
+                moved = true;
+            }
+        }
+    }
+
+    if (contains(m_cells[cur], toReal(q.x()), toReal(q.y())))
+        return cur;
+
+    for (size_t i = 0; i < m_cells.size(); ++i) {
+        if (!m_cells[i].empty() && dist2(i) < best) {
+            best = dist2(i);
+            cur = i;
+        }
+    }
+    return cur;
+}
+
+std::vector<size_t> EditableTiling::apply(const std::vector<SiteEdit> &edits) {
+    const size_t old = m_sites.size();
+
+    // net effect of the batch: current sites leaving their position, and
+    // positions taken or sites dropped, by index
+    struct Placement {
+        size_t index;
+        Site pos;
+        bool removed;
+    };
+    std::vector<char> gone(old, 0);
+    std::vector<Placement> placements;
+    const size_t NONE = size_t(-1);
+    std::vector<size_t> placement_of;   // by index
+    size_t added = 0;
+
+    auto clamped = [&](double x, double y) {
+        return Site(m_quant.toInt(std::min(std::max(x, 0.0), double(m_w))),
+                    m_quant.toInt(std::min(std::max(y, 0.0), double(m_h))));
+    };
+
+    for (const SiteEdit &e : edits) {
+        if (e.kind == SiteEdit::Add) {
+            const size_t i = old + added++;
+            placement_of.resize(std::max(placement_of.size(), i + 1), NONE);
+            placement_of[i] = placements.size();
+            placements.push_back({i, clamped(e.x, e.y), false});
+            continue;
+        }
+
+        const size_t i = e.index;
+        if (i < old ? m_removed[i] != 0 : i >= old + added)
+            continue;
+
+        placement_of.resize(std::max(placement_of.size(), i + 1), NONE);
+        Placement *p = placement_of[i] != NONE ? &placements[placement_of[i]] : nullptr;
+        if (p && p->removed)
+            continue;
+
+        if (i < old)
+            gone[i] = 1;
+        if (!p) {
+            placement_of[i] = placements.size();
+            placements.push_back({i, m_sites[i], false});
+            p = &placements.back();
+        }
+
+        if (e.kind == SiteEdit::Move)
+            p->pos = clamped(e.x, e.y);
+        else
+            p->removed = true;
+    }
+
+    const size_t total = old + added;
+    std::vector<char> dirty(total, 0);
+
+    // the neighbours of a leaving site take its area, through the other
+    // leaving sites around it if any
+    std::vector<char> seen(old, 0);
+    for (const Placement &placement : placements) {
+        const size_t p = placement.index;
+        if (p >= old || seen[p])
+            continue;
+
+        std::vector<size_t> stack(1, p);
+        seen[p] = 1;
+        while (!stack.empty()) {
+            const size_t s = stack.back();
+            stack.pop_back();
+            dirty[s] = 1;
+            for (uint32_t n : m_adjacency[s]) {
+                if (gone[n] && !seen[n]) {
+                    seen[n] = 1;
+                    stack.push_back(n);
+                }
+                dirty[n] = 1;
+            }
+        }
+
+    }
+
+    // coincident sites hidden behind a leaving one get its cell back
+    for (size_t i : m_hidden) {
+        for (const Placement &p : placements) {
+            if (p.index < old && m_sites[p.index] == m_sites[i])
+                dirty[i] = 1;
+        }
+    }
+
+    // the cells a new position takes area from
+    std::vector<char> visited(old, 0);
+    std::vector<size_t> touched;
+    size_t hint = 0;
+    for (const Placement &p : placements) {
+        dirty[p.index] = 1;
+        if (p.removed || old == 0)
+            continue;
+
+        const size_t first = locate(p.pos, p.index < old ? p.index : hint);
+        if (first >= old)
+            continue;
+        hint = first;
+
+        std::deque<size_t> queue(1, first);
+        visited[first] = 1;
+        touched.assign(1, first);
+        while (!queue.empty()) {
+            const size_t c = queue.front();
+            queue.pop_front();
+            dirty[c] = 1;
+            for (uint32_t n : m_adjacency[c]) {
+                if (!visited[n] && conflicts(n, p.pos)) {
+                    visited[n] = 1;
+                    touched.push_back(n);
+                    queue.push_back(n);
+                }
+            }
+        }
+        for (size_t c : touched)
+            visited[c] = 0;
+    }
+
+    // sites of the local diagram: the dirty ones and the current neighbours
+    // of the dirty ones, with the positions after the batch
+    std::vector<size_t> local_index;
+    for (size_t i = 0; i < total; ++i) {
+        if (!dirty[i])
+            continue;
+        local_index.push_back(i);
+        if (i < old)
+            local_index.insert(local_index.end(), m_adjacency[i].begin(), m_adjacency[i].end());
+    }
+
+    m_sites.resize(total);
+    m_removed.resize(total, 0);
+    for (const Placement &p : placements) {
+        m_sites[p.index] = p.pos;
+        m_removed[p.index] = p.removed;
+    }
+
+    std::sort(local_index.begin(), local_index.end());
+    local_index.erase(std::unique(local_index.begin(), local_index.end()), local_index.end());
+    local_index.erase(std::remove_if(local_index.begin(), local_index.end(),
+                                     [&](size_t i) { return m_removed[i] != 0; }), local_index.end());
+
+    Grid all, local;
+    std::vector<size_t> origin;
+    all.reserve(local_index.size());
+    for (size_t i : local_index)
+        all.push_back(m_sites[i]);
+    uniqueSites(all, local, origin);
+
+    boost::polygon::voronoi_diagram<double> vd;
+    boost::polygon::construct_voronoi(local.begin(), local.end(), &vd);
+
+    CellBuilder builder(ClipRect{0.0, 0.0, double(m_w), double(m_h)}, std::max(m_w, m_h), true);
+    CellStore::Unordered cells;
+    Adjacency::Unordered links;
+    std::vector<char> built(total, 0);
+
+    for (auto &c : vd.cells()) {
+        const size_t i = local_index[origin[c.source_index()]];
+        if (!dirty[i])
+            continue;
+
+        builder.build(c, local, m_quant, [&](size_t l) { return local_index[origin[l]]; });
+        builder.add(i, cells, links);
+        built[i] = 1;
+    }
+
+    // removed sites and the ones hidden behind a coincident site end empty
+    const std::vector<CellVertex> nothing;
+    const std::vector<uint32_t> none;
+    std::vector<size_t> rebuilt;
+    for (size_t i = 0; i < total; ++i) {
+        if (!dirty[i])
+            continue;
+        if (!built[i]) {
+            cells.add(i, nothing, none);
+            links.add(i, none);
+        }
+        rebuilt.push_back(i);
+    }
+
+    m_hidden.erase(std::remove_if(m_hidden.begin(), m_hidden.end(),
+                                  [&](size_t i) { return dirty[i] != 0; }), m_hidden.end());
+    for (size_t i : rebuilt) {
+        if (!built[i] && !m_removed[i])
+            m_hidden.push_back(i);
+    }
+
+    m_cells.patch(total, cells, &m_edges);
+    m_adjacency.patch(total, links);
+    return rebuilt;
+}
+
+} // namespace vt
@@ -0,0 +1,87 @@
+#ifndef EDITABLE_TILING_H
+#define EDITABLE_TILING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "adjacency.h"
+#include "cell-store.h"
+#include "tiling.h"
+
+namespace vt {
+
+/// one change to the sites of an EditableTiling
+struct SiteEdit {
+    enum Kind { Add, Move, Remove };
+
+    Kind kind;
+    size_t index;   ///< site moved or removed, ignored by Add
+    double x, y;    ///< new position in tile coordinates, ignored by Remove
+
+    static SiteEdit add(double x, double y) { return SiteEdit{Add, 0, x, y}; }
+    static SiteEdit move(size_t index, double x, double y) { return SiteEdit{Move, index, x, y}; }
+    static SiteEdit remove(size_t index) { return SiteEdit{Remove, index, 0.0, 0.0}; }
+};
+
+/**
+ * Tiling whose sites can be edited, only the cells the edits reach being
+ * rebuilt.
+ *
+ * Site indices are stable: added sites get the next indices and removed ones
+ * keep theirs with an empty cell and no neighbours.
+ *
+ * The cells an edit changes are found on the current diagram:
+ *  - a removed site (or the old position of a moved one) gives its area to
+ *    its neighbours, and beyond them to the neighbours of any adjacent
+ *    removed site;
+ *  - an inserted site (or the new position of a moved one) takes area from
+ *    exactly the cells having a vertex closer to it than their own site. As
+ *    the cells are convex these form a connected region, found by a walk to
+ *    the cell holding the new position and a flood over the adjacency.
+ * A changed cell can only get neighbours among the other changed cells and
+ * its current neighbours, so the diagram of those sites and of the inserted
+ * ones gives the exact new cells. They are patched into the stores, in
+ * place when their vertex counts do not change.
+ */
+class EditableTiling {
+public:
+    EditableTiling(int w, int h, const Grid &sites);
+
+    int width() const { return m_w; }
+    int height() const { return m_h; }
+
+    /// every site ever added, removed ones included
+    const Grid &sites() const { return m_sites; }
+    bool isRemoved(size_t i) const { return m_removed[i] != 0; }
+
+    const CellStore &cells() const { return m_cells; }
+    const Adjacency &adjacency() const { return m_adjacency; }
+    /// half-edge index, see computeVoronoi()
+    const std::vector<uint32_t> &edges() const { return m_edges; }
+
+    /**
+     * Applies a batch of edits, in order, and returns the indices of the
+     * rebuilt cells. Edits of unknown or removed sites are ignored, and
+     * positions are clamped to the tile.
+     */
+    std::vector<size_t> apply(const std::vector<SiteEdit> &edits);
+
+private:
+    double toReal(int v) const { return m_quant.toReal(v); }
+    size_t locate(const Site &q, size_t start) const;
+    bool conflicts(size_t cell, const Site &q) const;
+
+    int m_w, m_h;
+    GridQuantizer m_quant;
+    Grid m_sites;
+    std::vector<char> m_removed;
+    std::vector<size_t> m_hidden;   // live sites left without a cell by a coincident one
+    CellStore m_cells;
+    Adjacency m_adjacency;
+    std::vector<uint32_t> m_edges;
+};
+
+} // namespace vt
+
+#endif // EDITABLE_TILING_H
@@ -0,0 +1,194 @@
+#include "instrument.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace vt {
+namespace instrument {
+
+namespace {
+
+const char *const COUNTER_NAMES[COUNTER_COUNT] = {
+    "poisson.candidates",
+    "poisson.domain_rejects",
+    "poisson.neighbour_rejects",
+    "poisson.cells_probed",
+    "voronoi.cells_clipped",
+    "voronoi.infinite_edges",
+    "voronoi.vertices",
+};
+
+#ifdef VT_INSTRUMENT
+
+using detail::ThreadLog;
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadLog>> logs;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+Registry &registry() {
+    static Registry r;
+    return r;
+}
+
+#endif
+
+// JSON string contents, names are plain ASCII but better safe
+std::string quoted(const char *s) {
+    std::string out = "\"";
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            out += '\\';
+        out += *s;
+    }
+    return out + "\"";
+}
+
+std::string number(uint64_t v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(v));
+    return buf;
+}
+
+// microseconds with nanosecond digits, the unit of the trace format
+std::string micros(uint64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu.%03u", static_cast<unsigned long long>(ns / 1000), unsigned(ns % 1000));
+    return buf;
+}
+
+} // namespace
+
+const char *counterName(Counter c) {
+    return COUNTER_NAMES[c];
+}
+
+#ifdef VT_INSTRUMENT
+
+namespace detail {
+
+uint64_t now() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - registry().epoch).count());
+}
+
+thread_local ThreadLog *t_log = nullptr;
+
+ThreadLog &registerThread() {
+    std::unique_ptr<ThreadLog> log(new ThreadLog);
+    std::fill(log->counters, log->counters + COUNTER_COUNT, 0);
+
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    log->thread = uint32_t(r.logs.size());
+    t_log = log.get();
+    r.logs.push_back(std::move(log));
+    return *t_log;
+}
+
+void record(const char *name, uint64_t start, uint64_t end) {
+    ThreadLog &log = t_log ? *t_log : registerThread();
+    log.events.push_back(Event{name, log.thread, start, end - start});
+}
+
+} // namespace detail
+
+Report collect() {
+    Report report;
+    std::fill(report.counters, report.counters + COUNTER_COUNT, 0);
+
+    std::map<std::string, Timing> timings;
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto &log : r.logs) {
+        for (int c = 0; c < COUNTER_COUNT; ++c)
+            report.counters[c] += log->counters[c];
+
+        for (const Event &e : log->events) {
+            Timing &t = timings.emplace(e.name, Timing{e.name, 0, 0}).first->second;
+            ++t.calls;
+            t.total += e.duration;
+        }
+        report.events.insert(report.events.end(), log->events.begin(), log->events.end());
+    }
+
+    for (const auto &t : timings)
+        report.timings.push_back(t.second);
+    std::sort(report.timings.begin(), report.timings.end(), [](const Timing &a, const Timing &b) {
+        return a.total > b.total;
+    });
+    std::sort(report.events.begin(), report.events.end(), [](const Event &a, const Event &b) {
+        return a.start < b.start;
+    });
+    return report;
+}
+
+void reset() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto &log : r.logs) {
+        std::fill(log->counters, log->counters + COUNTER_COUNT, 0);
+        log->events.clear();
+    }
+}
+
+#else
+
+Report collect() {
+    Report report;
+    std::fill(report.counters, report.counters + COUNTER_COUNT, 0);
+    return report;
+}
+
+void reset() {
+}
+
+#endif
+
+std::string toJson(const Report &report) {
+    std::string out = "{\n  \"counters\": {";
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+        out += c ? ",\n    " : "\n    ";
+        out += quoted(COUNTER_NAMES[c]) + ": " + number(report.counters[c]);
+    }
+    out += "\n  },\n  \"timings\": [";
+    for (size_t i = 0; i < report.timings.size(); ++i) {
+        const Timing &t = report.timings[i];
+        out += i ? ",\n    " : "\n    ";
+        out += "{\"name\": " + quoted(t.name) + ", \"calls\": " + number(t.calls) +
+               ", \"total_ns\": " + number(t.total) + "}";
+    }
+    out += "\n  ]\n}\n";
+    return out;
+}
+
+std::string toChromeTrace(const Report &report) {
+    std::string out = "{\"traceEvents\": [";
+    for (size_t i = 0; i < report.events.size(); ++i) {
+        const Event &e = report.events[i];
+        out += i ? ",\n" : "\n";
+        out += "{\"name\": " + quoted(e.name) + ", \"ph\": \"X\", \"pid\": 1, \"tid\": " + number(e.thread) +
+               ", \"ts\": " + micros(e.start) + ", \"dur\": " + micros(e.duration) + "}";
+    }
+
+    // the counters as a last sample, shown as tracks over the whole trace
+    uint64_t end = 0;
+    for (const Event &e : report.events)
+        end = std::max(end, e.start + e.duration);
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+        out += report.events.empty() && !c ? "\n" : ",\n";
+        out += "{\"name\": " + quoted(COUNTER_NAMES[c]) + ", \"ph\": \"C\", \"pid\": 1, \"ts\": " + micros(end) +
+               ", \"args\": {\"value\": " + number(report.counters[c]) + "}}";
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+} // namespace instrument
+} // namespace vt
@@ -0,0 +1,122 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Scoped timers and counters of the pipeline, compiled in with
+ * VT_INSTRUMENT defined (qmake CONFIG+=vt_instrument).
+ *
+ *     VT_SCOPE("voronoi.sweep");                 // times the enclosing block
+ *     VT_COUNT(vt::instrument::VORONOI_VERTICES, ring.size());
+ *
+ * Without VT_INSTRUMENT both macros expand to nothing and collect() returns
+ * an empty report. With it, each thread records into its own log, without
+ * locking nor atomics: a counter costs a thread local load and an add, a
+ * scope two clock reads. collect() merges the logs of every thread, it is
+ * meant to be called once the instrumented work is over, e.g. at the end of
+ * a run.
+ */
+namespace vt {
+namespace instrument {
+
+enum Counter {
+    POISSON_CANDIDATES,          ///< candidates generated around active points
+    POISSON_DOMAIN_REJECTS,      ///< candidates outside of the sampling domain
+    POISSON_NEIGHBOUR_REJECTS,   ///< candidates too close to a sample
+    POISSON_CELLS_PROBED,        ///< grid cells visited by the distance tests
+    VORONOI_CELLS_CLIPPED,       ///< cells crossing the tile border
+    VORONOI_INFINITE_EDGES,      ///< infinite edges closed far away
+    VORONOI_VERTICES,            ///< vertices of the clipped cells
+    COUNTER_COUNT
+};
+
+/// name of a counter in the reports
+const char *counterName(Counter c);
+
+/// one timed scope, in nanoseconds since the first instrumented event
+struct Event {
+    const char *name;
+    uint32_t thread;
+    uint64_t start;
+    uint64_t duration;
+};
+
+/// per-name totals of the timed scopes
+struct Timing {
+    const char *name;
+    uint64_t calls;
+    uint64_t total;   ///< nanoseconds, nested scopes counted in their parents too
+};
+
+struct Report {
+    uint64_t counters[COUNTER_COUNT];
+    std::vector<Timing> timings;   // by decreasing total
+    std::vector<Event> events;     // by start time
+};
+
+/// merges the logs of every thread so far
+Report collect();
+/// empties the logs of every thread
+void reset();
+
+/// counters and timings as a JSON object
+std::string toJson(const Report &report);
+/// events in the Chrome trace event format, for chrome://tracing or Perfetto
+std::string toChromeTrace(const Report &report);
+
+#ifdef VT_INSTRUMENT
+
+namespace detail {
+
+uint64_t now();
+void record(const char *name, uint64_t start, uint64_t end);
+
+// log of one thread, only written by it and kept after it ends
+struct ThreadLog {
+    uint32_t thread;
+    uint64_t counters[COUNTER_COUNT];
+    std::vector<Event> events;
+};
+
+extern thread_local ThreadLog *t_log;
+ThreadLog &registerThread();
+
+inline void add(Counter c, uint64_t n) {
+    (t_log ? *t_log : registerThread()).counters[c] += n;
+}
+
+class Scope {
+public:
+    explicit Scope(const char *name) : m_name(name), m_start(now()) {}
+    ~Scope() { record(m_name, m_start, now()); }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const char *m_name;
+    uint64_t m_start;
+};
+
+} // namespace detail
+
+#endif
+
+} // namespace instrument
+} // namespace vt
+
+#ifdef VT_INSTRUMENT
+#define VT_INSTRUMENT_CAT2(a, b) a##b
+#define VT_INSTRUMENT_CAT(a, b) VT_INSTRUMENT_CAT2(a, b)
+#define VT_SCOPE(name) ::vt::instrument::detail::Scope VT_INSTRUMENT_CAT(vt_scope_, __LINE__)(name)
+#define VT_COUNT(counter, n) ::vt::instrument::detail::add(counter, uint64_t(n))
+#else
+#define VT_SCOPE(name) do {} while (false)
+#define VT_COUNT(counter, n) do {} while (false)
+#endif
+
+#endif // INSTRUMENT_H
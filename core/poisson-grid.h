@@ -0,0 +1,1768 @@
+#ifndef POISSONGRID_H
+#define POISSONGRID_H
+
+/**
+ * \file PoissonGenerator.h
+ * \brief
+ *
+ * Poisson Disk Points Generator
+ *
+ * \version 1.1.4
+ * \date 19/10/2016
+ * \author Sergey Kosarevsky, 2014-2016
+ * \author support@linderdaum.com   http://www.linderdaum.com   http://blog.linderdaum.com
+ */
+
+/*
+    POISSON_SIMD runs the batched candidate path of GeneratePoissonPoints on
+    SSE, AVX or NEON lanes: all the candidates around an active point are
+    built at once and go through the domain and distance tests together. It
+    is enabled by default, and sSettings::Batched still picks the one-
+    candidate-at-a-time path at run time. Both produce exactly the same
+    points, as long as the compiler does not contract a*b+c into FMA
+    instructions (build with -ffp-contract=off when targeting FMA hardware).
+
+    Usage example:
+
+        #include "PoissonGenerator.h"
+        ...
+        PoissonGenerator::DefaultPRNG PRNG;
+        PoissonGenerator::sSettings Settings;
+        Settings.Progress = []( float Done ) { printf( "%.0f%%\r", 100.0f * Done ); return true; };
+        const auto Points = PoissonGenerator::GeneratePoissonPoints( NumPoints, PRNG, Settings );
+
+    Any class providing RandomFloat() in [0, 1] and RandomInt(Max) in [0, Max]
+    can be used as PRNG. An optional FillFloats(Out, Count) lets the batched
+    path pull its random numbers in blocks. PcgPRNG is a much faster
+    alternative to the mt19937 based DefaultPRNG.
+*/
+
+// Fast Poisson Disk Sampling in Arbitrary Dimensions
+// http://people.cs.ubc.ca/~rbridson/docs/bridson-siggraph07-poissondisk.pdf
+
+// Implementation based on http://devmag.org.za/2009/05/03/poisson-disk-sampling/
+
+/* Versions history:
+ *		1.1.4 	Oct 19, 2016		POISSON_PROGRESS_INDICATOR can be defined outside of the header file, disabled by default
+ *		1.1.3a	Jun  9, 2016		Update constructor for DefaultPRNG
+ *		1.1.3		Mar 10, 2016		Header-only library, no global mutable state
+ *		1.1.2		Apr  9, 2015		Output a text file with XY coordinates
+ *		1.1.1		May 23, 2014		Initialize PRNG seed, fixed uninitialized fields
+ *    1.1		May  7, 2014		Support of density maps
+ *		1.0		May  6, 2014
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <random>
+#include <stdexcept>
+#include <stdint.h>
+#include <time.h>
+
+#include "instrument.h"
+#include "thread-pool.h"
+
+#ifndef POISSON_SIMD
+#  define POISSON_SIMD 1
+#endif
+
+#if POISSON_SIMD
+#  if defined(__AVX__)
+#    include <immintrin.h>
+#  elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#  elif defined(__ARM_NEON) && defined(__aarch64__)
+#    include <arm_neon.h>
+#  endif
+#endif
+
+namespace PoissonGenerator {
+
+/// Thin wrappers over the widest float vector available, one lane otherwise
+namespace Simd {
+
+#if POISSON_SIMD && defined(__AVX__)
+    constexpr int Lanes = 8;
+    using Pack = __m256;
+
+    inline Pack Load(const float *P) { return _mm256_loadu_ps(P); }
+    inline void Store(float *P, Pack A) { _mm256_storeu_ps(P, A); }
+    inline Pack Set1(float V) { return _mm256_set1_ps(V); }
+    inline Pack Add(Pack A, Pack B) { return _mm256_add_ps(A, B); }
+    inline Pack Sub(Pack A, Pack B) { return _mm256_sub_ps(A, B); }
+    inline Pack Mul(Pack A, Pack B) { return _mm256_mul_ps(A, B); }
+    inline uint32_t Lt(Pack A, Pack B) { return uint32_t(_mm256_movemask_ps(_mm256_cmp_ps(A, B, _CMP_LT_OQ))); }
+    inline uint32_t Le(Pack A, Pack B) { return uint32_t(_mm256_movemask_ps(_mm256_cmp_ps(A, B, _CMP_LE_OQ))); }
+#elif POISSON_SIMD && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    constexpr int Lanes = 4;
+    using Pack = __m128;
+
+    inline Pack Load(const float *P) { return _mm_loadu_ps(P); }
+    inline void Store(float *P, Pack A) { _mm_storeu_ps(P, A); }
+    inline Pack Set1(float V) { return _mm_set1_ps(V); }
+    inline Pack Add(Pack A, Pack B) { return _mm_add_ps(A, B); }
+    inline Pack Sub(Pack A, Pack B) { return _mm_sub_ps(A, B); }
+    inline Pack Mul(Pack A, Pack B) { return _mm_mul_ps(A, B); }
+    inline uint32_t Lt(Pack A, Pack B) { return uint32_t(_mm_movemask_ps(_mm_cmplt_ps(A, B))); }
+    inline uint32_t Le(Pack A, Pack B) { return uint32_t(_mm_movemask_ps(_mm_cmple_ps(A, B))); }
+#elif POISSON_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+    constexpr int Lanes = 4;
+    using Pack = float32x4_t;
+
+    inline uint32_t MoveMask(uint32x4_t M) {
+        const uint32x4_t Bits = { 1, 2, 4, 8 };
+        return vaddvq_u32(vandq_u32(M, Bits));
+    }
+
+    inline Pack Load(const float *P) { return vld1q_f32(P); }
+    inline void Store(float *P, Pack A) { vst1q_f32(P, A); }
+    inline Pack Set1(float V) { return vdupq_n_f32(V); }
+    inline Pack Add(Pack A, Pack B) { return vaddq_f32(A, B); }
+    inline Pack Sub(Pack A, Pack B) { return vsubq_f32(A, B); }
+    inline Pack Mul(Pack A, Pack B) { return vmulq_f32(A, B); }
+    inline uint32_t Lt(Pack A, Pack B) { return MoveMask(vcltq_f32(A, B)); }
+    inline uint32_t Le(Pack A, Pack B) { return MoveMask(vcleq_f32(A, B)); }
+#else
+    constexpr int Lanes = 1;
+    using Pack = float;
+
+    inline Pack Load(const float *P) { return *P; }
+    inline void Store(float *P, Pack A) { *P = A; }
+    inline Pack Set1(float V) { return V; }
+    inline Pack Add(Pack A, Pack B) { return A + B; }
+    inline Pack Sub(Pack A, Pack B) { return A - B; }
+    inline Pack Mul(Pack A, Pack B) { return A * B; }
+    inline uint32_t Lt(Pack A, Pack B) { return A < B ? 1u : 0u; }
+    inline uint32_t Le(Pack A, Pack B) { return A <= B ? 1u : 0u; }
+#endif
+
+    /// Bit mask selecting the first N lanes of a pack
+    inline uint32_t FirstLanes(int N) {
+        return N >= Lanes ? (1u << Lanes) - 1u : (1u << N) - 1u;
+    }
+
+    /// Rounds N up to a whole number of packs
+    inline size_t RoundUp(size_t N) {
+        return (N + Lanes - 1) / Lanes * Lanes;
+    }
+
+} // namespace Simd
+
+const char* const Version = "1.1.4 (19/10/2016)";
+
+class DefaultPRNG {
+public:
+    DefaultPRNG()
+        : m_Gen(std::random_device()()),
+          m_Dis(0.0f, 1.0f),
+          m_Seed(uint32_t(time(nullptr)))
+    {
+        // prepare PRNG
+        m_Gen.seed(m_Seed);
+    }
+
+    explicit DefaultPRNG(uint32_t seed)
+        : m_Gen(seed),
+          m_Dis(0.0f, 1.0f),
+          m_Seed(seed)
+    {
+    }
+
+    /// Generator seeded from the same seed and a stream id
+    inline DefaultPRNG Stream(uint64_t StreamId) const {
+        DefaultPRNG G(m_Seed);
+        std::seed_seq Seq{ m_Seed, uint32_t(StreamId), uint32_t(StreamId >> 32) };
+        G.m_Gen.seed(Seq);
+        return G;
+    }
+
+    inline float RandomFloat() {
+        return static_cast<float>(m_Dis(m_Gen));
+    }
+
+    inline int RandomInt(int Max) {
+        return m_DisInt(m_Gen, std::uniform_int_distribution<>::param_type(0, Max));
+    }
+
+    inline void FillFloats(float *Out, size_t Count) {
+        for ( size_t i = 0; i < Count; i++ )
+            Out[i] = RandomFloat();
+    }
+
+private:
+    std::mt19937 m_Gen;
+    std::uniform_real_distribution<float> m_Dis;
+    std::uniform_int_distribution<> m_DisInt;
+    uint32_t m_Seed;
+};
+
+/**
+    PCG32 generator (O'Neill, pcg-random.org), XSH-RR output on a 64-bit LCG.
+
+    Much cheaper than mt19937 and only 16 bytes of state. The stream id selects
+    one of 2^63 independent sequences for the same seed, so parallel workers
+    can each get their own generator with Stream().
+**/
+class PcgPRNG {
+public:
+    PcgPRNG()
+        : PcgPRNG(uint64_t(time(nullptr)))
+    {
+    }
+
+    explicit PcgPRNG(uint64_t Seed, uint64_t StreamId = 0)
+        : m_Seed(Seed)
+        , m_State(0)
+        , m_Inc((StreamId << 1u) | 1u)
+    {
+        Next();
+        m_State += Seed;
+        Next();
+    }
+
+    /// Generator with the same seed on another independent sequence
+    inline PcgPRNG Stream(uint64_t StreamId) const {
+        return PcgPRNG(m_Seed, StreamId);
+    }
+
+    inline uint32_t Next() {
+        const uint64_t Old = m_State;
+        m_State = Old * 6364136223846793005ULL + m_Inc;
+        const uint32_t XorShifted = uint32_t(((Old >> 18u) ^ Old) >> 27u);
+        const uint32_t Rot = uint32_t(Old >> 59u);
+        return (XorShifted >> Rot) | (XorShifted << ((32u - Rot) & 31u));
+    }
+
+    /// Uniform float in [0, 1) built from the top 24 bits
+    inline float RandomFloat() {
+        return float(Next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    /// Uniform integer in [0, Max], Lemire's multiply-and-reject method
+    inline int RandomInt(int Max) {
+        const uint32_t Range = uint32_t(Max) + 1u;
+        uint64_t M = uint64_t(Next()) * Range;
+
+        if ( uint32_t(M) < Range )
+        {
+            const uint32_t Threshold = (0u - Range) % Range;
+            while ( uint32_t(M) < Threshold )
+                M = uint64_t(Next()) * Range;
+        }
+
+        return int(M >> 32);
+    }
+
+    inline void FillFloats(float *Out, size_t Count) {
+        for ( size_t i = 0; i < Count; i++ )
+            Out[i] = float(Next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+private:
+    uint64_t m_Seed;
+    uint64_t m_State;
+    uint64_t m_Inc;
+};
+
+/// Calls Generator.FillFloats when the PRNG has it, RandomFloat otherwise
+template <typename PRNG>
+auto FillRandomFloats(PRNG &Generator, float *Out, size_t Count, int) -> decltype(Generator.FillFloats(Out, Count), void())
+{
+    Generator.FillFloats(Out, Count);
+}
+
+template <typename PRNG>
+void FillRandomFloats(PRNG &Generator, float *Out, size_t Count, long)
+{
+    for ( size_t i = 0; i < Count; i++ )
+        Out[i] = Generator.RandomFloat();
+}
+
+template <typename PRNG>
+inline void FillRandomFloats(PRNG &Generator, float *Out, size_t Count)
+{
+    FillRandomFloats(Generator, Out, Count, 0);
+}
+
+struct sPoint {
+    constexpr sPoint() : x(0), y(0), m_Valid(false) {}
+    constexpr sPoint(float X, float Y) : x(X), y(Y), m_Valid(true) {}
+
+    //
+    inline bool IsInRectangle() const {
+        return x >= 0 && y >= 0 && x <= 1 && y <= 1;
+    }
+    //
+    inline bool IsInCircle() const {
+        float fx = x - 0.5f;
+        float fy = y - 0.5f;
+        return ( fx*fx + fy*fy ) <= 0.25f;
+    }
+
+    inline float Dist2(sPoint &P) {
+        return (x - P.x) * (x - P.x) + (y - P.y) * (y - P.y);
+    }
+
+    float x;
+    float y;
+    bool m_Valid;
+};
+
+/**
+    Sampling domains
+
+    The samplers are templates on the domain, so each one gets its own inner
+    loop: the domain test is inlined, with no virtual call nor branch on the
+    domain kind per candidate. A domain provides
+
+        sBounds Bounds() const;                      // where first points are drawn
+        bool Contains(const sPoint &P) const;        // scalar test
+        uint32_t Contains(Simd::Pack X, Simd::Pack Y) const;   // lane mask
+
+    and must lie in the unit square, the acceleration grid covers it. Both
+    tests must give the same answer for a point, the batched and scalar paths
+    produce the same samples. Domains without a packed test can derive from
+    sScalarDomain, which runs the scalar one lane by lane.
+**/
+struct sBounds {
+    float X0, Y0, X1, Y1;
+};
+
+struct sRectangleDomain {
+    static constexpr sBounds Bounds() { return sBounds{ 0.0f, 0.0f, 1.0f, 1.0f }; }
+
+    inline bool Contains(const sPoint &P) const {
+        return P.IsInRectangle();
+    }
+
+    inline uint32_t Contains(Simd::Pack X, Simd::Pack Y) const {
+        const Simd::Pack Zero = Simd::Set1(0.0f);
+        const Simd::Pack One = Simd::Set1(1.0f);
+        return Simd::Le(Zero, X) & Simd::Le(Zero, Y) & Simd::Le(X, One) & Simd::Le(Y, One);
+    }
+};
+
+struct sCircleDomain {
+    static constexpr sBounds Bounds() { return sBounds{ 0.0f, 0.0f, 1.0f, 1.0f }; }
+
+    inline bool Contains(const sPoint &P) const {
+        return P.IsInCircle();
+    }
+
+    inline uint32_t Contains(Simd::Pack X, Simd::Pack Y) const {
+        const Simd::Pack Half = Simd::Set1(0.5f);
+        const Simd::Pack FX = Simd::Sub(X, Half);
+        const Simd::Pack FY = Simd::Sub(Y, Half);
+        return Simd::Le(Simd::Add(Simd::Mul(FX, FX), Simd::Mul(FY, FY)), Simd::Set1(0.25f));
+    }
+};
+
+/// Packed test of Derived built from its scalar Contains()
+template <typename Derived>
+struct sScalarDomain {
+    inline uint32_t Contains(Simd::Pack X, Simd::Pack Y) const {
+        float PX[Simd::Lanes];
+        float PY[Simd::Lanes];
+        Simd::Store(PX, X);
+        Simd::Store(PY, Y);
+
+        uint32_t Mask = 0;
+        for ( int i = 0; i < Simd::Lanes; i++ )
+            Mask |= uint32_t(static_cast<const Derived &>(*this).Contains(sPoint(PX[i], PY[i]))) << i;
+        return Mask;
+    }
+};
+
+/**
+    Simple polygon in the unit square, e.g. a coastline, under the even-odd
+    rule. Each edge stores its slope so that both tests run the same
+    multiply-add per edge, the packed one on every lane at once.
+**/
+struct sPolygonDomain {
+    explicit sPolygonDomain(const std::vector<sPoint> &Polygon)
+        : m_Bounds{ 1.0f, 1.0f, 0.0f, 0.0f }
+    {
+        for ( size_t i = 0, j = Polygon.size() - 1; i < Polygon.size(); j = i++ )
+        {
+            const sPoint &A = Polygon[i];
+            const sPoint &B = Polygon[j];
+            // horizontal edges never straddle a point, any slope does
+            m_Edges.push_back(sEdge{ A.x, A.y, B.y, A.y != B.y ? (B.x - A.x) / (B.y - A.y) : 0.0f });
+
+            m_Bounds.X0 = std::min(m_Bounds.X0, A.x);
+            m_Bounds.Y0 = std::min(m_Bounds.Y0, A.y);
+            m_Bounds.X1 = std::max(m_Bounds.X1, A.x);
+            m_Bounds.Y1 = std::max(m_Bounds.Y1, A.y);
+        }
+    }
+
+    inline sBounds Bounds() const {
+        return m_Bounds;
+    }
+
+    inline bool Contains(const sPoint &P) const {
+        bool Inside = false;
+        for ( const sEdge &E : m_Edges )
+        {
+            if ( (P.y < E.Y0) != (P.y < E.Y1) && P.x < E.X0 + (P.y - E.Y0) * E.Slope )
+                Inside = !Inside;
+        }
+        return Inside;
+    }
+
+    inline uint32_t Contains(Simd::Pack X, Simd::Pack Y) const {
+        uint32_t Inside = 0;
+        for ( const sEdge &E : m_Edges )
+        {
+            const Simd::Pack Y0 = Simd::Set1(E.Y0);
+            const uint32_t Straddles = Simd::Lt(Y, Y0) ^ Simd::Lt(Y, Simd::Set1(E.Y1));
+            const Simd::Pack Cross = Simd::Add(Simd::Set1(E.X0), Simd::Mul(Simd::Sub(Y, Y0), Simd::Set1(E.Slope)));
+            Inside ^= Straddles & Simd::Lt(X, Cross);
+        }
+        return Inside;
+    }
+
+private:
+    struct sEdge {
+        float X0, Y0, Y1, Slope;
+    };
+
+    std::vector<sEdge> m_Edges;
+    sBounds m_Bounds;
+};
+
+struct sGridPoint {
+    int x;
+    int y;
+};
+
+/**
+    Acceleration grid stored as a single row-major buffer.
+
+    Each cell holds at most one sample. Its coordinates live in two parallel
+    float arrays (SoA) and its occupancy in a bitmap, so that a neighbourhood
+    probe walks a few contiguous cache lines instead of following one heap
+    pointer per row. The bitmap words are atomic: concurrent tiles writing
+    distinct cells may share a word, but never a coordinate slot.
+
+    The buffer is padded by the probe reach on every side, which lets the
+    neighbourhood query use plain index offsets without bounds checks. Empty
+    cells hold far away coordinates, so the packed query can test whole rows
+    of cells without looking at the bitmap.
+
+    Along a wrapped axis the unit square is periodic: samples near one border
+    are also stored, shifted by one period, in the padding along the opposite
+    border. Both queries then measure toroidal distances with the very same
+    probes, and Wrap() brings candidates that left the square back into it.
+
+    Reset() empties the grid for another run, reusing the buffers as long as
+    they are large enough.
+**/
+struct sGrid {
+    sGrid()
+        : m_W(0)
+        , m_H(0)
+        , m_Reach(0)
+        , m_Stride(0)
+        , m_MinDist2(0.0f)
+        , m_WrapX(false)
+        , m_WrapY(false)
+        , m_Words(0)
+        , m_Capacity(0)
+    {
+    }
+
+    sGrid( int W, int H, float MinDist, bool WrapX = false, bool WrapY = false )
+        : sGrid()
+    {
+        Reset(W, H, MinDist, WrapX, WrapY);
+    }
+
+    void Reset( int W, int H, float MinDist, bool WrapX = false, bool WrapY = false )
+    {
+        m_W = W;
+        m_H = H;
+        m_MinDist2 = MinDist * MinDist;
+        m_WrapX = WrapX;
+        m_WrapY = WrapY;
+
+        // a cell can only hold a conflicting sample if the gap between it and
+        // the cell of the candidate is shorter than MinDist
+        const double CellW = 1.0 / W;
+        const double CellH = 1.0 / H;
+        const double MinDist2 = double(MinDist) * double(MinDist);
+
+        m_Reach = std::max(int(std::ceil(MinDist / std::min(CellW, CellH))), 1);
+
+        // the packed query reads whole packs, up to Lanes - 1 cells past the
+        // end of a probe row: the right padding is that much wider, so that
+        // these reads stay within the row and only see cells never written
+        m_Stride = m_W + 2 * m_Reach + Simd::Lanes - 1;
+
+        const size_t Size = size_t(m_Stride) * size_t(m_H + 2 * m_Reach);
+        m_X.assign(Size, EmptyCoord());
+        m_Y.assign(Size, EmptyCoord());
+        m_Words = (Size + 63) / 64;
+        if ( m_Words > m_Capacity )
+        {
+            m_Occupied.reset(new std::atomic<uint64_t>[m_Words]);
+            m_Capacity = m_Words;
+        }
+        for ( size_t i = 0; i < m_Words; i++ )
+            m_Occupied[i].store(0, std::memory_order_relaxed);
+
+        struct sOffset { double Gap2; int Manhattan; ptrdiff_t Delta; };
+        std::vector<sOffset> Offsets;
+        std::vector<int> HalfWidth(2 * m_Reach + 1, -1);
+        m_Offsets.clear();
+        m_Rows.clear();
+
+        for ( int dy = -m_Reach; dy <= m_Reach; dy++ )
+        {
+            for ( int dx = -m_Reach; dx <= m_Reach; dx++ )
+            {
+                const double GX = std::max(std::abs(dx) - 1, 0) * CellW;
+                const double GY = std::max(std::abs(dy) - 1, 0) * CellH;
+                const double Gap2 = GX * GX + GY * GY;
+
+                if ( Gap2 < MinDist2 )
+                {
+                    Offsets.push_back({ Gap2, std::abs(dx) + std::abs(dy), ptrdiff_t(dy) * m_Stride + dx });
+                    HalfWidth[dy + m_Reach] = std::max(HalfWidth[dy + m_Reach], std::abs(dx));
+                }
+            }
+        }
+
+        // closest cells first so that a rejection exits as early as possible
+        std::stable_sort(Offsets.begin(), Offsets.end(), [](const sOffset &A, const sOffset &B) {
+            return A.Gap2 < B.Gap2 || (A.Gap2 == B.Gap2 && A.Manhattan < B.Manhattan);
+        });
+
+        for (const auto &O : Offsets)
+            m_Offsets.push_back(O.Delta);
+
+        // the same cells seen as one horizontal run per row, centre row first
+        for ( int dy = 0; dy <= m_Reach; dy++ )
+        {
+            const int Half = HalfWidth[dy + m_Reach];
+
+            if ( Half >= 0 )
+                m_Rows.push_back({ ptrdiff_t(dy) * m_Stride - Half, 2 * Half + 1 });
+            if ( Half >= 0 && dy > 0 )
+                m_Rows.push_back({ -ptrdiff_t(dy) * m_Stride - Half, 2 * Half + 1 });
+        }
+    }
+
+    inline sGridPoint GridPoint(const sPoint &P) const {
+        // points lying exactly on the upper border belong to the last cell
+        return { std::min(int(P.x * m_W), m_W - 1), std::min(int(P.y * m_H), m_H - 1) };
+    }
+
+    /// Coordinate stored in empty cells, far enough to never be a neighbour
+    static constexpr float EmptyCoord() {
+        return 1.0e18f;
+    }
+
+    inline size_t Index(int X, int Y) const {
+        return size_t(Y + m_Reach) * size_t(m_Stride) + size_t(X + m_Reach);
+    }
+
+    inline bool IsOccupied(size_t Idx) const {
+        return (m_Occupied[Idx >> 6].load(std::memory_order_relaxed) >> (Idx & 63)) & 1u;
+    }
+
+    inline int Width() const {
+        return m_W;
+    }
+
+    inline int Height() const {
+        return m_H;
+    }
+
+    /// Number of cells around a candidate cell that a probe may visit
+    inline int Reach() const {
+        return m_Reach;
+    }
+
+    inline bool WrapsX() const {
+        return m_WrapX;
+    }
+
+    inline bool WrapsY() const {
+        return m_WrapY;
+    }
+
+    /// Whether Wrap() may move a point, i.e. any axis wraps
+    inline bool Wraps() const {
+        return m_WrapX || m_WrapY;
+    }
+
+    /// Coordinate of a candidate at most one period away, back in [0,1):
+    /// a tiny negative V rounds to exactly 1 once shifted, which is 0 again
+    static inline float WrapCoord(float V) {
+        const float R = V < 0.0f ? V + 1.0f : (V >= 1.0f ? V - 1.0f : V);
+        return R < 1.0f ? R : 0.0f;
+    }
+
+    /// P moved back into the unit square along the wrapped axes
+    inline sPoint Wrap(const sPoint &P) const {
+        return sPoint( m_WrapX ? WrapCoord(P.x) : P.x, m_WrapY ? WrapCoord(P.y) : P.y );
+    }
+
+    /// Sample stored in cell (X, Y), if any
+    inline bool Lookup(int X, int Y, sPoint &P) const {
+        const size_t Idx = Index(X, Y);
+        if ( !IsOccupied(Idx) )
+            return false;
+        P = sPoint( m_X[Idx], m_Y[Idx] );
+        return true;
+    }
+
+    /// Number of cells visited by a full neighbourhood probe
+    inline size_t ProbeSize() const {
+        return m_Offsets.size();
+    }
+
+    inline void Insert(const sPoint &P) {
+        auto G = GridPoint(P);
+        Store(Index(G.x, G.y), P.x, P.y);
+        if ( Wraps() )
+            InsertGhosts(G, P);
+    }
+
+    bool IsInNeighbourhood(sPoint Point) const {
+        sGridPoint G = GridPoint(Point);
+        const size_t Base = Index(G.x, G.y);
+
+        // scan the cells that may hold a sample closer than MinDist
+        for (const ptrdiff_t Delta : m_Offsets)
+        {
+            const size_t Idx = size_t(ptrdiff_t(Base) + Delta);
+            VT_COUNT(vt::instrument::POISSON_CELLS_PROBED, 1);
+
+            if ( IsOccupied(Idx) )
+            {
+                const float DX = m_X[Idx] - Point.x;
+                const float DY = m_Y[Idx] - Point.y;
+
+                if ( DX * DX + DY * DY < m_MinDist2 ) { return true; }
+            }
+        }
+
+        return false;
+    }
+
+    /// Same query as IsInNeighbourhood, testing a run of cells per pack
+    bool IsInNeighbourhoodPacked(sPoint Point) const {
+        sGridPoint G = GridPoint(Point);
+        const size_t Base = Index(G.x, G.y);
+
+        const Simd::Pack PX = Simd::Set1(Point.x);
+        const Simd::Pack PY = Simd::Set1(Point.y);
+        const Simd::Pack MinDist2 = Simd::Set1(m_MinDist2);
+
+        for (const auto &Row : m_Rows)
+        {
+            VT_COUNT(vt::instrument::POISSON_CELLS_PROBED, Row.Count);
+            const float *X = m_X.data() + ptrdiff_t(Base) + Row.First;
+            const float *Y = m_Y.data() + ptrdiff_t(Base) + Row.First;
+
+            for ( int i = 0; i < Row.Count; i += Simd::Lanes )
+            {
+                const Simd::Pack DX = Simd::Sub(Simd::Load(X + i), PX);
+                const Simd::Pack DY = Simd::Sub(Simd::Load(Y + i), PY);
+                const Simd::Pack D2 = Simd::Add(Simd::Mul(DX, DX), Simd::Mul(DY, DY));
+
+                if ( Simd::Lt(D2, MinDist2) & Simd::FirstLanes(Row.Count - i) ) { return true; }
+            }
+        }
+
+        return false;
+    }
+
+private:
+    struct sRow {
+        ptrdiff_t First;
+        int Count;
+    };
+
+    inline void Store(size_t Idx, float X, float Y) {
+        m_X[Idx] = X;
+        m_Y[Idx] = Y;
+        m_Occupied[Idx >> 6].fetch_or(uint64_t(1) << (Idx & 63), std::memory_order_relaxed);
+    }
+
+    // the copies of P one period away that land in the padding; each padding
+    // cell mirrors a single cell, so concurrent tiles still write distinct slots
+    void InsertGhosts(sGridPoint G, const sPoint &P) {
+        for ( int OY = m_WrapY ? -1 : 0; OY <= (m_WrapY ? 1 : 0); OY++ )
+        {
+            const int GY = G.y + OY * m_H;
+            if ( GY < -m_Reach || GY >= m_H + m_Reach )
+                continue;
+
+            for ( int OX = m_WrapX ? -1 : 0; OX <= (m_WrapX ? 1 : 0); OX++ )
+            {
+                const int GX = G.x + OX * m_W;
+                if ( (OX == 0 && OY == 0) || GX < -m_Reach || GX >= m_W + m_Reach )
+                    continue;
+                Store(Index(GX, GY), P.x + float(OX), P.y + float(OY));
+            }
+        }
+    }
+
+    int m_W;
+    int m_H;
+    int m_Reach;
+    int m_Stride;
+    float m_MinDist2;
+    bool m_WrapX;
+    bool m_WrapY;
+    std::vector<ptrdiff_t> m_Offsets;
+    std::vector<sRow> m_Rows;
+    std::vector<float> m_X;
+    std::vector<float> m_Y;
+    size_t m_Words;
+    size_t m_Capacity;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_Occupied;
+};
+
+template <typename PRNG>
+sPoint PopRandom(std::vector<sPoint> &Points, PRNG &Generator)
+{
+    const int Idx = Generator.RandomInt(Points.size()-1);
+    auto P = Points[Idx];
+    std::iter_swap(Points.begin() + Idx, Points.end()-1);
+    Points.pop_back();
+    return P;
+}
+
+template <typename PRNG>
+sPoint GenerateRandomPointAround(const sPoint& P, float MinDist, PRNG& Generator)
+{
+    // start with non-uniform distribution
+    float R1 = Generator.RandomFloat();
+
+    // radius should be between MinDist and 2 * MinDist
+    float Radius = MinDist * ( R1 + 1.0f );
+
+    // random angle
+    float C = 2.0f * Generator.RandomFloat() - 1.0f; // cos
+    float S = 2.0f * Generator.RandomFloat() - 1.0f; // sin
+
+    // the new point is generated around the point (x, y)
+    float X = P.x + Radius * C;
+    float Y = P.y + Radius * S;
+
+    return sPoint( X, Y );
+}
+
+/**
+    Scratch buffers holding every candidate generated around one active point.
+
+    Random numbers are drawn in the same order as repeated calls to
+    GenerateRandomPointAround, and the arithmetic is done lane by lane with the
+    same operations, so the candidates are bit-identical to the scalar ones.
+**/
+struct sCandidateBatch {
+    sCandidateBatch()
+        : m_Count(0)
+    {
+    }
+
+    explicit sCandidateBatch(int Count)
+    {
+        Reset(Count);
+    }
+
+    void Reset(int Count)
+    {
+        m_Count = Count;
+        m_R.assign(Simd::RoundUp(size_t(Count)), 0.0f);
+        m_C.assign(m_R.size(), 0.0f);
+        m_S.assign(m_R.size(), 0.0f);
+        m_X.assign(m_R.size(), 0.0f);
+        m_Y.assign(m_R.size(), 0.0f);
+        m_Fits.assign(m_R.size() / Simd::Lanes, 0);
+        m_Draws.assign(3 * size_t(Count), 0.0f);
+    }
+
+    /// Candidates around P, brought back into the square along the axes Grid wraps
+    template <typename Domain, typename PRNG>
+    void Generate(const sPoint &P, float MinDist, const Domain &D, PRNG &Generator, const sGrid &Grid)
+    {
+        // one block of draws, interleaved as the scalar path consumes them
+        FillRandomFloats(Generator, m_Draws.data(), m_Draws.size());
+
+        for ( int i = 0; i < m_Count; i++ )
+        {
+            m_R[i] = m_Draws[3 * i];
+            m_C[i] = m_Draws[3 * i + 1];
+            m_S[i] = m_Draws[3 * i + 2];
+        }
+
+        const Simd::Pack One = Simd::Set1(1.0f);
+        const Simd::Pack Two = Simd::Set1(2.0f);
+        const Simd::Pack Dist = Simd::Set1(MinDist);
+        const Simd::Pack PX = Simd::Set1(P.x);
+        const Simd::Pack PY = Simd::Set1(P.y);
+
+        for ( size_t i = 0; i < m_R.size(); i += Simd::Lanes )
+        {
+            const Simd::Pack Radius = Simd::Mul(Dist, Simd::Add(Simd::Load(&m_R[i]), One));
+            const Simd::Pack C = Simd::Sub(Simd::Mul(Two, Simd::Load(&m_C[i])), One);
+            const Simd::Pack S = Simd::Sub(Simd::Mul(Two, Simd::Load(&m_S[i])), One);
+            Simd::Pack X = Simd::Add(PX, Simd::Mul(Radius, C));
+            Simd::Pack Y = Simd::Add(PY, Simd::Mul(Radius, S));
+
+            Simd::Store(&m_X[i], X);
+            Simd::Store(&m_Y[i], Y);
+            if ( Grid.Wraps() )
+            {
+                // lane by lane, the same arithmetic as the scalar path
+                for ( size_t j = i; j < i + Simd::Lanes; j++ )
+                {
+                    const sPoint W = Grid.Wrap( sPoint( m_X[j], m_Y[j] ) );
+                    m_X[j] = W.x;
+                    m_Y[j] = W.y;
+                }
+                X = Simd::Load(&m_X[i]);
+                Y = Simd::Load(&m_Y[i]);
+            }
+            m_Fits[i / Simd::Lanes] = D.Contains(X, Y);
+        }
+    }
+
+    inline int Count() const {
+        return m_Count;
+    }
+
+    /// Whether candidate I lies inside the sampling domain
+    inline bool Fits(int I) const {
+        return (m_Fits[size_t(I) / Simd::Lanes] >> (size_t(I) % Simd::Lanes)) & 1u;
+    }
+
+    inline sPoint Candidate(int I) const {
+        return sPoint( m_X[I], m_Y[I] );
+    }
+
+private:
+    int m_Count;
+    std::vector<float> m_R;
+    std::vector<float> m_C;
+    std::vector<float> m_S;
+    std::vector<float> m_X;
+    std::vector<float> m_Y;
+    std::vector<uint32_t> m_Fits;
+    std::vector<float> m_Draws;
+};
+
+/**
+    Parameters of GeneratePoissonPoints
+
+    NewPointsCount - refer to bridson-siggraph07-poissondisk.pdf for details (the value 'k')
+    Circle  - 'true' to fill a circle, 'false' to fill a rectangle, when no
+              domain is given to the sampler
+    MinDist - minimal distance estimator, use negative value for default
+    Threads - 1 runs the classic sequential sampler, 0 uses every core and
+              any other value that many threads, see GenerateTiledPoissonPoints
+    Pool    - pool running the tiles, a temporary one is created when null
+    Progress - called with the fraction done in [0, 1], replaces the former
+              POISSON_PROGRESS_INDICATOR dots. Returning false stops the
+              sampling, which returns the points placed so far. The tiled
+              sampler calls it from the pool threads, concurrently.
+    WrapX, WrapY - make the square periodic along that axis, for maps that
+              repeat: spacing is measured across the border and the samples
+              lie in [0, 1) along it, see sGrid. Meant for the rectangle
+              domain, the variable radius sampler ignores them.
+    Batched - 'true' builds the candidates around an active point in one
+              batch, see POISSON_SIMD, 'false' tries them one at a time. The
+              points are the same, the scalar path is the reference to test
+              the batched one against.
+**/
+struct sSettings {
+    int NewPointsCount = 30;
+    bool Circle = true;
+    float MinDist = -1.0f;
+    unsigned Threads = 1;
+    vt::ThreadPool *Pool = nullptr;
+    std::function<bool(float)> Progress;
+    bool WrapX = false;
+    bool WrapY = false;
+    bool Batched = true;
+};
+
+// samples placed between two progress reports of the sequential sampler
+const size_t ProgressStep = 4096;
+
+/// Edge in cells of the acceleration grid used for a given minimal distance
+inline int GridSizeFor(float MinDist)
+{
+    const float CellSize = MinDist / sqrt(2.0f);
+    return (int)ceil(1.0f / CellSize);
+}
+
+/// Minimal distance used for NumPoints samples when the settings leave it negative
+inline float MinDistFor(size_t NumPoints, const sSettings &Settings)
+{
+    return Settings.MinDist < 0.0f ? sqrt(float(NumPoints)) / float(NumPoints) : Settings.MinDist;
+}
+
+/// Samples a maximal sampling of the unit square holds, about 1 / MinDist^2
+inline size_t ExpectedPointsFor(float MinDist)
+{
+    return size_t(std::ceil(1.0 / (double(MinDist) * double(MinDist))));
+}
+
+/// Scratch of one tile of GenerateTiledPoissonPoints
+struct sTile {
+    int X0, Y0, X1, Y1;
+    std::vector<sPoint> Points;
+    std::vector<sPoint> ProcessList;
+    sCandidateBatch Batch;
+};
+
+/**
+    Buffers of GeneratePoissonPoints kept from one run to the next.
+
+    Passing the same context to successive runs lets them reuse the output,
+    the active list, the acceleration grid and the per-tile scratch: once a
+    run has sized them, runs of the same size or smaller do not allocate.
+    Reserve() sizes them upfront from the expected sample count, Reset()
+    empties them without freeing anything.
+**/
+struct sContext {
+    std::vector<sPoint> SamplePoints;
+    std::vector<sPoint> ProcessList;
+    sGrid Grid;
+    sCandidateBatch Batch;
+    std::vector<sTile> Tiles;
+
+    void Reserve( size_t Count )
+    {
+        SamplePoints.reserve(Count);
+        ProcessList.reserve(Count);
+    }
+
+    void Reset()
+    {
+        SamplePoints.clear();
+        ProcessList.clear();
+        for (auto &Tile : Tiles)
+        {
+            Tile.Points.clear();
+            Tile.ProcessList.clear();
+        }
+    }
+};
+
+/// Scalar reference of TryPointsAround, Count candidates generated one at a time
+template <typename Domain, typename PRNG, typename KeepFn, typename AcceptFn>
+void TryPointsOneByOne(
+    const sPoint &Point,
+    float MinDist,
+    const Domain &D,
+    PRNG &Generator,
+    int Count,
+    const sGrid &Grid,
+    KeepFn &Keep,
+    AcceptFn &Accept
+)
+{
+    for ( int i = 0; i < Count; i++ )
+    {
+        sPoint NewPoint = GenerateRandomPointAround( Point, MinDist, Generator );
+        if ( Grid.Wraps() )
+            NewPoint = Grid.Wrap( NewPoint );
+
+        if ( !D.Contains( NewPoint ) )
+        {
+            VT_COUNT(vt::instrument::POISSON_DOMAIN_REJECTS, 1);
+            continue;
+        }
+
+        if ( !Keep( NewPoint ) )
+            continue;
+
+        if ( Grid.IsInNeighbourhood( NewPoint ) )
+            VT_COUNT(vt::instrument::POISSON_NEIGHBOUR_REJECTS, 1);
+        else
+            Accept( NewPoint );
+    }
+}
+
+/**
+    Tries every candidate around Point and calls Accept for each of them which
+    lies in Domain, satisfies Keep and is far enough from the grid samples.
+    Candidates crossing a border the grid wraps come back on the other side.
+    Accept is expected to insert the point, later candidates must see it.
+    Candidates failing Keep belong to another tile and count as no rejection.
+    Batched selects the path of sSettings::Batched, with the same outcome.
+**/
+template <typename Domain, typename PRNG, typename KeepFn, typename AcceptFn>
+void TryPointsAround(
+    const sPoint &Point,
+    float MinDist,
+    const Domain &D,
+    PRNG &Generator,
+    sCandidateBatch &Batch,
+    const sGrid &Grid,
+    KeepFn &&Keep,
+    AcceptFn &&Accept,
+    bool Batched = true
+)
+{
+    VT_COUNT(vt::instrument::POISSON_CANDIDATES, Batch.Count());
+
+    if ( !Batched )
+    {
+        TryPointsOneByOne( Point, MinDist, D, Generator, Batch.Count(), Grid, Keep, Accept );
+        return;
+    }
+
+    Batch.Generate( Point, MinDist, D, Generator, Grid );
+
+    // commit in generation order so that later candidates see earlier ones
+    for ( int i = 0; i < Batch.Count(); i++ )
+    {
+        if ( !Batch.Fits( i ) )
+        {
+            VT_COUNT(vt::instrument::POISSON_DOMAIN_REJECTS, 1);
+            continue;
+        }
+
+        sPoint NewPoint = Batch.Candidate( i );
+
+        if ( !Keep( NewPoint ) )
+            continue;
+
+        if ( Grid.IsInNeighbourhoodPacked( NewPoint ) )
+            VT_COUNT(vt::instrument::POISSON_NEIGHBOUR_REJECTS, 1);
+        else
+            Accept( NewPoint );
+    }
+}
+
+/**
+    Tile layout of GenerateTiledPoissonPoints along one axis of GridSize cells.
+
+    Tiles of TileSize cells, the last one possibly narrower, unless the axis
+    wraps: the first and last tiles are then neighbours too, so the count must
+    be even for the 2x2 colouring to hold across the border, and every tile at
+    least TileSize wide. The cells are then split evenly among the largest
+    even count of such tiles, or left to a single tile.
+**/
+inline int TileCountFor(int GridSize, int TileSize, bool Wrap)
+{
+    if ( !Wrap )
+        return (GridSize + TileSize - 1) / TileSize;
+    return std::max((GridSize / TileSize) & ~1, 1);
+}
+
+inline int TileEdgeFor(int T, int GridSize, int TileSize, int Tiles, bool Wrap)
+{
+    if ( !Wrap )
+        return std::min(T * TileSize, GridSize);
+    return int(int64_t(T) * GridSize / Tiles);
+}
+
+/// Cells [First, Last) within Reach of the tile [T0, T1), modulo GridSize when wrapping
+struct sBand {
+    int First, Last;
+};
+
+inline sBand BandFor(int T0, int T1, int Reach, int GridSize, bool Wrap)
+{
+    if ( !Wrap )
+        return sBand{ std::max(T0 - Reach, 0), std::min(T1 + Reach, GridSize) };
+    // a band wrapping onto itself would list the same samples twice
+    if ( T1 - T0 + 2 * Reach >= GridSize )
+        return sBand{ 0, GridSize };
+    return sBand{ T0 - Reach, T1 + Reach };
+}
+
+/**
+    Parallel variant of GeneratePoissonPoints.
+
+    The grid is cut into square tiles at least as wide as the probe reach,
+    plus the cells the packed probe reads past it (see sGrid::Reset()), and
+    coloured in a 2x2 pattern. Tiles of one colour are never adjacent, so a
+    tile only reads cells of tiles that are idle during its phase and only
+    writes its own cells: the four phases run their tiles concurrently on the
+    shared grid without locks. Each tile first grows from the samples already
+    placed around it by earlier phases, or from a random dart, then runs
+    Bridson's algorithm restricted to its own cells.
+
+    Tile t draws from Generator.Stream(t) and the output is the concatenation
+    of the tiles in phase order, so the result only depends on the seed. The
+    sampler fills the whole domain and does not stop at NumPoints. Wrapped
+    axes are cut as TileCountFor() says, to keep the colouring periodic.
+**/
+template <typename PRNG, typename Domain>
+const std::vector<sPoint> &GenerateTiledPoissonPoints(
+    size_t NumPoints,
+    PRNG& Generator,
+    const sSettings &Settings,
+    const Domain &D,
+    sContext &Context
+)
+{
+    VT_SCOPE("poisson.tiled");
+
+    const float MinDist = MinDistFor(NumPoints, Settings);
+    const int GridSize = GridSizeFor(MinDist);
+
+    Context.Reset();
+    Context.Grid.Reset(GridSize, GridSize, MinDist, Settings.WrapX, Settings.WrapY);
+    sGrid &Grid = Context.Grid;
+
+    // 16 tiles per side keep every phase busy on a large host. The packed
+    // probe reads up to Lanes - 1 cells past its reach, which must still
+    // stop short of the next tile of the same colour
+    const int TileSize = std::max(Grid.Reach() + Simd::Lanes - 1, (GridSize + 15) / 16);
+    const int TilesX = TileCountFor(GridSize, TileSize, Settings.WrapX);
+    const int TilesY = TileCountFor(GridSize, TileSize, Settings.WrapY);
+
+    // each tile gets its share of the expected samples, the active list also
+    // starts with those of the surrounding band
+    const size_t Expected = ExpectedPointsFor(MinDist);
+    const size_t Share = Expected / (size_t(TilesX) * size_t(TilesY)) + 1;
+
+    std::vector<sTile> &TileList = Context.Tiles;
+    TileList.resize(size_t(TilesX) * size_t(TilesY));
+
+    size_t Next = 0;
+    for ( int Phase = 0; Phase < 4; Phase++ )
+        for ( int ty = Phase / 2; ty < TilesY; ty += 2 )
+            for ( int tx = Phase % 2; tx < TilesX; tx += 2 )
+            {
+                sTile &Tile = TileList[Next++];
+                Tile.X0 = TileEdgeFor(tx, GridSize, TileSize, TilesX, Settings.WrapX);
+                Tile.Y0 = TileEdgeFor(ty, GridSize, TileSize, TilesY, Settings.WrapY);
+                Tile.X1 = TileEdgeFor(tx + 1, GridSize, TileSize, TilesX, Settings.WrapX);
+                Tile.Y1 = TileEdgeFor(ty + 1, GridSize, TileSize, TilesY, Settings.WrapY);
+                Tile.Points.reserve(Share);
+                Tile.ProcessList.reserve(2 * Share);
+                if ( Tile.Batch.Count() != Settings.NewPointsCount )
+                    Tile.Batch.Reset(Settings.NewPointsCount);
+            }
+
+    std::atomic<size_t> TilesDone(0);
+    std::atomic<bool> Stopped(false);
+
+    auto SampleTile = [&](size_t Index)
+    {
+        if ( Stopped.load(std::memory_order_relaxed) )
+            return;
+
+        VT_SCOPE("poisson.tile");
+
+        sTile &Tile = TileList[Index];
+        PRNG TileGenerator = Generator.Stream(Index);
+        std::vector<sPoint> &ProcessList = Tile.ProcessList;
+
+        auto Owns = [&](const sPoint &P) {
+            const sGridPoint G = Grid.GridPoint(P);
+            return G.x >= Tile.X0 && G.x < Tile.X1 && G.y >= Tile.Y0 && G.y < Tile.Y1;
+        };
+
+        auto Accept = [&](const sPoint &P) {
+            ProcessList.push_back( P );
+            Tile.Points.push_back( P );
+            Grid.Insert( P );
+        };
+
+        // grow from the samples already placed in the surrounding band,
+        // which goes on across a wrapped border
+        const int R = Grid.Reach();
+        const sBand BY = BandFor(Tile.Y0, Tile.Y1, R, GridSize, Settings.WrapY);
+        const sBand BX = BandFor(Tile.X0, Tile.X1, R, GridSize, Settings.WrapX);
+        for ( int y = BY.First; y < BY.Last; y++ )
+        {
+            for ( int x = BX.First; x < BX.Last; x++ )
+            {
+                sPoint P;
+                if ( Grid.Lookup((x + GridSize) % GridSize, (y + GridSize) % GridSize, P) )
+                    ProcessList.push_back( P );
+            }
+        }
+
+        // a few darts for tiles with no sample around them yet
+        for ( int Try = 0; ProcessList.empty() && Try < Settings.NewPointsCount; Try++ )
+        {
+            const float X = (Tile.X0 + TileGenerator.RandomFloat() * (Tile.X1 - Tile.X0)) / GridSize;
+            const float Y = (Tile.Y0 + TileGenerator.RandomFloat() * (Tile.Y1 - Tile.Y0)) / GridSize;
+            const sPoint P( std::min(X, 1.0f), std::min(Y, 1.0f) );
+
+            if ( D.Contains(P) && Owns(P) && !Grid.IsInNeighbourhood(P) )
+                Accept( P );
+        }
+
+        while ( !ProcessList.empty() )
+        {
+            sPoint Point = PopRandom<PRNG>( ProcessList, TileGenerator );
+            TryPointsAround( Point, MinDist, D, TileGenerator, Tile.Batch, Grid, Owns, Accept, Settings.Batched );
+        }
+
+        const size_t Done = TilesDone.fetch_add(1) + 1;
+        if ( Settings.Progress && !Settings.Progress(float(Done) / TileList.size()) )
+            Stopped = true;
+    };
+
+    std::unique_ptr<vt::ThreadPool> OwnPool;
+    vt::ThreadPool *Pool = Settings.Pool;
+    if ( !Pool )
+    {
+        const unsigned Threads = Settings.Threads ? Settings.Threads : std::thread::hardware_concurrency();
+        OwnPool.reset(new vt::ThreadPool(std::max(Threads, 1u) - 1));
+        Pool = OwnPool.get();
+    }
+
+    // phases must not overlap, the pool drains each one before the next starts
+    size_t First = 0;
+    for ( int Phase = 0; Phase < 4 && !Stopped; Phase++ )
+    {
+        const int CountX = (TilesX - Phase % 2 + 1) / 2;
+        const int CountY = (TilesY - Phase / 2 + 1) / 2;
+        const size_t Last = First + size_t(CountX) * size_t(CountY);
+        Pool->parallelFor(First, Last, 1, SampleTile);
+        First = Last;
+    }
+
+    size_t Total = 0;
+    for (const auto &Tile : TileList)
+        Total += Tile.Points.size();
+
+    std::vector<sPoint> &SamplePoints = Context.SamplePoints;
+    SamplePoints.reserve(Total);
+    for (const auto &Tile : TileList)
+        SamplePoints.insert(SamplePoints.end(), Tile.Points.begin(), Tile.Points.end());
+
+    return SamplePoints;
+}
+
+/// Tiled sampler over the rectangle or circle selected by Settings.Circle
+template <typename PRNG = DefaultPRNG>
+const std::vector<sPoint> &GenerateTiledPoissonPoints(
+    size_t NumPoints,
+    PRNG& Generator,
+    const sSettings &Settings,
+    sContext &Context
+)
+{
+    if ( Settings.Circle )
+        return GenerateTiledPoissonPoints(NumPoints, Generator, Settings, sCircleDomain(), Context);
+    return GenerateTiledPoissonPoints(NumPoints, Generator, Settings, sRectangleDomain(), Context);
+}
+
+template <typename PRNG = DefaultPRNG>
+std::vector<sPoint> GenerateTiledPoissonPoints(
+    size_t NumPoints,
+    PRNG& Generator,
+    const sSettings &Settings
+)
+{
+    sContext Context;
+    GenerateTiledPoissonPoints(NumPoints, Generator, Settings, Context);
+    return std::move(Context.SamplePoints);
+}
+
+/**
+    Generates the points of domain D into the buffers of Context and returns
+    them, see sSettings for the parameters. The points stay valid until the
+    next run on the same context.
+**/
+template <typename PRNG, typename Domain>
+const std::vector<sPoint> &GeneratePoissonPoints(
+    size_t NumPoints,
+    PRNG& Generator,
+    const sSettings &Settings,
+    const Domain &D,
+    sContext &Context
+)
+{
+    if ( Settings.Threads != 1 )
+        return GenerateTiledPoissonPoints(NumPoints, Generator, Settings, D, Context);
+
+    VT_SCOPE("poisson.serial");
+
+    const float MinDist = MinDistFor(NumPoints, Settings);
+    const sBounds Bounds = D.Bounds();
+
+    Context.Reset();
+    Context.Reserve(std::min(NumPoints, ExpectedPointsFor(MinDist)));
+
+    std::vector<sPoint> &SamplePoints = Context.SamplePoints;
+    std::vector<sPoint> &ProcessList = Context.ProcessList;
+
+    // create the grid
+    const int GridSize = GridSizeFor(MinDist);
+
+    sGrid &Grid = Context.Grid;
+    Grid.Reset(GridSize, GridSize, MinDist, Settings.WrapX, Settings.WrapY);
+    sCandidateBatch &Batch = Context.Batch;
+    if ( Batch.Count() != Settings.NewPointsCount )
+        Batch.Reset(Settings.NewPointsCount);
+    sPoint FirstPoint;
+
+    do {
+        FirstPoint = sPoint( Bounds.X0 + Generator.RandomFloat() * (Bounds.X1 - Bounds.X0),
+                             Bounds.Y0 + Generator.RandomFloat() * (Bounds.Y1 - Bounds.Y0) );
+    } while (!D.Contains( FirstPoint ));
+
+    // update containers
+    ProcessList.push_back( FirstPoint );
+    SamplePoints.push_back( FirstPoint );
+    Grid.Insert( FirstPoint );
+
+    auto Everywhere = [](const sPoint &) { return true; };
+    auto Accept = [&](const sPoint &P) {
+        ProcessList.push_back( P );
+        SamplePoints.push_back( P );
+        Grid.Insert( P );
+    };
+
+    // generate new points for each point in the queue
+    size_t NextReport = ProgressStep;
+    while ( !ProcessList.empty() && SamplePoints.size() < NumPoints )
+    {
+        sPoint Point = PopRandom<PRNG>( ProcessList, Generator );
+        TryPointsAround( Point, MinDist, D, Generator, Batch, Grid, Everywhere, Accept, Settings.Batched );
+
+        if ( Settings.Progress && SamplePoints.size() >= NextReport )
+        {
+            NextReport = SamplePoints.size() + ProgressStep;
+            if ( !Settings.Progress( std::min(float(SamplePoints.size()) / NumPoints, 1.0f) ) )
+                return SamplePoints;
+        }
+    }
+
+    if ( Settings.Progress )
+        Settings.Progress( 1.0f );
+
+    return SamplePoints;
+}
+
+/// Sampler over the rectangle or circle selected by Settings.Circle
+template <typename PRNG = DefaultPRNG>
+const std::vector<sPoint> &GeneratePoissonPoints(
+    size_t NumPoints,
+    PRNG& Generator,
+    const sSettings &Settings,
+    sContext &Context
+)
+{
+    if ( Settings.Circle )
+        return GeneratePoissonPoints(NumPoints, Generator, Settings, sCircleDomain(), Context);
+    return GeneratePoissonPoints(NumPoints, Generator, Settings, sRectangleDomain(), Context);
+}
+
+/**
+    Return a vector of generated points, see sSettings for the parameters
+**/
+template <typename PRNG = DefaultPRNG>
+std::vector<sPoint> GeneratePoissonPoints(
+    size_t NumPoints,
+    PRNG& Generator,
+    const sSettings &Settings
+)
+{
+    sContext Context;
+    GeneratePoissonPoints(NumPoints, Generator, Settings, Context);
+    return std::move(Context.SamplePoints);
+}
+
+/**
+    Return a vector of points generated in domain D, see sSettings for the
+    parameters, Settings.Circle is not used
+**/
+template <typename PRNG, typename Domain>
+std::vector<sPoint> GeneratePoissonPoints(
+    size_t NumPoints,
+    PRNG& Generator,
+    const sSettings &Settings,
+    const Domain &D
+)
+{
+    sContext Context;
+    GeneratePoissonPoints(NumPoints, Generator, Settings, D, Context);
+    return std::move(Context.SamplePoints);
+}
+
+/**
+    Return a vector of generated points
+
+    NewPointsCount - refer to bridson-siggraph07-poissondisk.pdf for details (the value 'k')
+    Circle  - 'true' to fill a circle, 'false' to fill a rectangle
+    MinDist - minimal distance estimator, use negative value for default
+**/
+template <typename PRNG = DefaultPRNG>
+std::vector<sPoint> GeneratePoissonPoints(
+    size_t NumPoints,
+    PRNG& Generator,
+    int NewPointsCount = 30,
+    bool Circle = true,
+    float MinDist = -1.0f
+)
+{
+    sSettings Settings;
+    Settings.NewPointsCount = NewPointsCount;
+    Settings.Circle = Circle;
+    Settings.MinDist = MinDist;
+    return GeneratePoissonPoints(NumPoints, Generator, Settings);
+}
+
+/**
+    Density texture over the unit square, sampled bilinearly, mapping each
+    point to the distance its sample keeps from the others: density 1 gives
+    MinDist, density 0 gives MaxDist, radii are linear in between.
+
+    Values holds Width x Height densities in [0, 1], row by row from y = 0,
+    the first and last texels of a row sitting on the borders of the square.
+    Throws std::invalid_argument on an empty map, a Values of another size or
+    a MinDist that is not positive.
+**/
+struct sDensityMap {
+    sDensityMap( int Width, int Height, std::vector<float> Values, float MinDist, float MaxDist )
+        : m_W(Width)
+        , m_H(Height)
+        , m_Values(std::move(Values))
+        , m_MinDist(MinDist)
+        , m_MaxDist(std::max(MaxDist, MinDist))
+    {
+        if ( m_W <= 0 || m_H <= 0 || m_Values.size() != size_t(m_W) * size_t(m_H) )
+            throw std::invalid_argument("sDensityMap: Values must hold Width x Height densities");
+        if ( !(m_MinDist > 0.0f) )
+            throw std::invalid_argument("sDensityMap: MinDist must be positive");
+    }
+
+    inline float Density(const sPoint &P) const {
+        const float U = std::min(std::max(P.x, 0.0f), 1.0f) * float(m_W - 1);
+        const float V = std::min(std::max(P.y, 0.0f), 1.0f) * float(m_H - 1);
+        const int X0 = std::min(int(U), m_W - 1);
+        const int Y0 = std::min(int(V), m_H - 1);
+        const int X1 = std::min(X0 + 1, m_W - 1);
+        const int Y1 = std::min(Y0 + 1, m_H - 1);
+        const float FX = U - float(X0);
+        const float FY = V - float(Y0);
+
+        const float *Row0 = &m_Values[size_t(Y0) * size_t(m_W)];
+        const float *Row1 = &m_Values[size_t(Y1) * size_t(m_W)];
+        const float D0 = Row0[X0] + (Row0[X1] - Row0[X0]) * FX;
+        const float D1 = Row1[X0] + (Row1[X1] - Row1[X0]) * FX;
+        return D0 + (D1 - D0) * FY;
+    }
+
+    inline float Radius(const sPoint &P) const {
+        const float D = std::min(std::max(Density(P), 0.0f), 1.0f);
+        return m_MaxDist + (m_MinDist - m_MaxDist) * D;
+    }
+
+    inline float MinDist() const {
+        return m_MinDist;
+    }
+
+    inline float MaxDist() const {
+        return m_MaxDist;
+    }
+
+    /// Samples a maximal sampling of the unit square holds, about the sum of 1 / r^2 over the texels
+    size_t ExpectedPoints() const {
+        double Sum = 0.0;
+        for ( int y = 0; y < m_H; y++ )
+            for ( int x = 0; x < m_W; x++ )
+            {
+                const double R = Radius(sPoint( float(x) / std::max(m_W - 1, 1), float(y) / std::max(m_H - 1, 1) ));
+                Sum += 1.0 / (R * R);
+            }
+        return size_t(std::ceil(Sum / (double(m_W) * double(m_H))));
+    }
+
+private:
+    int m_W;
+    int m_H;
+    std::vector<float> m_Values;
+    float m_MinDist;
+    float m_MaxDist;
+};
+
+/**
+    Acceleration structure of the variable radius sampler.
+
+    Samples go to the level matching their radius: level L holds radii in
+    [MinDist * 2^L, MinDist * 2^(L+1)) in cells of MinDist * 2^(L+1), so a
+    cell never holds more than a handful of them and a query scans at most
+    3x3 cells per level, whatever the spread of the radii. The cells of a level
+    live in an open addressing hash table keyed on their coordinates, its
+    memory follows the samples of the level instead of the area: a uniform
+    grid sized for MinDist would mostly store empty ocean.
+**/
+struct sMultiGrid {
+    void Reset( float MinDist, float MaxDist )
+    {
+        int Levels = 1;
+        while ( MinDist * float(1u << Levels) <= MaxDist && Levels < 31 )
+            Levels++;
+
+        // keep the tables of the previous run, only emptied
+        m_Levels.resize(size_t(Levels));
+        for ( int l = 0; l < Levels; l++ )
+        {
+            sLevel &Level = m_Levels[size_t(l)];
+            Level.MinRadius = MinDist * float(1u << l);
+            Level.CellSize = 2.0f * Level.MinRadius;
+            Level.MaxRadius = 0.0f;
+            Level.Count = 0;
+            if ( Level.Slots.empty() )
+                Level.Slots.resize(64);
+            Level.Shift = 64;
+            for ( size_t Size = Level.Slots.size(); Size > 1; Size /= 2 )
+                Level.Shift--;
+            std::fill(Level.Slots.begin(), Level.Slots.end(), sSlot{ EmptyKey(), 0.0f, 0.0f, 0.0f });
+        }
+    }
+
+    inline int Levels() const {
+        return int(m_Levels.size());
+    }
+
+    void Insert( const sPoint &P, float Radius )
+    {
+        sLevel &Level = m_Levels[size_t(LevelOf(Radius))];
+        if ( 2 * (Level.Count + 1) > Level.Slots.size() )
+            Grow(Level);
+
+        Place(Level, sSlot{ Key(int(P.x / Level.CellSize), int(P.y / Level.CellSize)), P.x, P.y, Radius });
+        Level.Count++;
+        Level.MaxRadius = std::max(Level.MaxRadius, Radius);
+    }
+
+    /// Whether a sample is closer to P than the smaller of their radii
+    bool IsInNeighbourhood( const sPoint &P, float Radius ) const
+    {
+        // the level of the radius first, it holds most conflicts
+        const int First = LevelOf(Radius);
+        for ( int l = 0; l < Levels(); l++ )
+        {
+            const sLevel &Level = m_Levels[size_t((First + l) % Levels())];
+            if ( !Level.Count )
+                continue;
+
+            // pairs only conflict closer than the smaller radius
+            const float Reach = std::min(Radius, Level.MaxRadius);
+            const int X0 = std::max(int(std::floor((P.x - Reach) / Level.CellSize)), 0);
+            const int Y0 = std::max(int(std::floor((P.y - Reach) / Level.CellSize)), 0);
+            const int X1 = int((P.x + Reach) / Level.CellSize);
+            const int Y1 = int((P.y + Reach) / Level.CellSize);
+
+            // the cell of P first, most rejections are found there
+            const int CX = int(P.x / Level.CellSize);
+            const int CY = int(P.y / Level.CellSize);
+            if ( IsInCell(Level, CX, CY, P, Radius) )
+                return true;
+
+            for ( int y = Y0; y <= Y1; y++ )
+                for ( int x = X0; x <= X1; x++ )
+                    if ( (x != CX || y != CY) && IsInCell(Level, x, y, P, Radius) )
+                        return true;
+        }
+        return false;
+    }
+
+private:
+    struct sSlot {
+        uint64_t Key;
+        float X, Y, R;
+    };
+
+    struct sLevel {
+        float MinRadius;
+        float CellSize;
+        float MaxRadius;
+        size_t Count;
+        int Shift;                  // 64 - log2 of the slot count
+        std::vector<sSlot> Slots;   // power of two, at most half full
+    };
+
+    static constexpr uint64_t EmptyKey() {
+        return ~uint64_t(0);
+    }
+
+    static inline uint64_t Key(int X, int Y) {
+        return (uint64_t(uint32_t(Y)) << 32) | uint32_t(X);
+    }
+
+    // Fibonacci hashing, the top bits of the product are the well mixed ones
+    static inline size_t Hash(uint64_t K, int Shift) {
+        return size_t((K * 0x9E3779B97F4A7C15ull) >> Shift);
+    }
+
+    inline int LevelOf(float Radius) const {
+        int l = 0;
+        while ( l + 1 < Levels() && Radius >= m_Levels[size_t(l + 1)].MinRadius )
+            l++;
+        return l;
+    }
+
+    static bool IsInCell( const sLevel &Level, int X, int Y, const sPoint &P, float Radius )
+    {
+        VT_COUNT(vt::instrument::POISSON_CELLS_PROBED, 1);
+
+        const uint64_t K = Key(X, Y);
+        const size_t Mask = Level.Slots.size() - 1;
+        for ( size_t i = Hash(K, Level.Shift); Level.Slots[i].Key != EmptyKey(); i = (i + 1) & Mask )
+        {
+            const sSlot &S = Level.Slots[i];
+            if ( S.Key != K )
+                continue;
+
+            const float R = std::min(Radius, S.R);
+            const float DX = S.X - P.x;
+            const float DY = S.Y - P.y;
+            if ( DX * DX + DY * DY < R * R )
+                return true;
+        }
+        return false;
+    }
+
+    // several samples may share a cell, they just take the next free slots
+    static void Place( sLevel &Level, const sSlot &S )
+    {
+        const size_t Mask = Level.Slots.size() - 1;
+        size_t i = Hash(S.Key, Level.Shift);
+        while ( Level.Slots[i].Key != EmptyKey() )
+            i = (i + 1) & Mask;
+        Level.Slots[i] = S;
+    }
+
+    static void Grow( sLevel &Level )
+    {
+        std::vector<sSlot> Old(2 * Level.Slots.size(), sSlot{ EmptyKey(), 0.0f, 0.0f, 0.0f });
+        Old.swap(Level.Slots);
+        Level.Shift--;
+        for ( const sSlot &S : Old )
+            if ( S.Key != EmptyKey() )
+                Place(Level, S);
+    }
+
+    std::vector<sLevel> m_Levels;
+};
+
+/// Buffers of GenerateVariablePoissonPoints kept from one run to the next, see sContext
+struct sVariableContext {
+    std::vector<sPoint> SamplePoints;
+    std::vector<sPoint> ProcessList;
+    sMultiGrid Grid;
+};
+
+/**
+    Variable radius variant of GeneratePoissonPoints: each sample keeps the
+    radius Density gives at its position and two samples are at least the
+    smaller of their radii apart. With a smooth density neighbours have
+    close radii, the samples are then dense where the density is high and
+    sparse where it is low, e.g. around cities and over oceans.
+
+    Candidates are drawn at one to two radii of their active sample, as in
+    Bridson's algorithm. Settings.NewPointsCount and Settings.Progress are
+    used, the distances come from Density and the sampler is sequential.
+**/
+template <typename PRNG, typename Domain>
+const std::vector<sPoint> &GenerateVariablePoissonPoints(
+    size_t NumPoints,
+    PRNG& Generator,
+    const sDensityMap &Density,
+    const sSettings &Settings,
+    const Domain &D,
+    sVariableContext &Context
+)
+{
+    VT_SCOPE("poisson.variable");
+
+    std::vector<sPoint> &SamplePoints = Context.SamplePoints;
+    std::vector<sPoint> &ProcessList = Context.ProcessList;
+    sMultiGrid &Grid = Context.Grid;
+
+    SamplePoints.clear();
+    ProcessList.clear();
+    SamplePoints.reserve(std::min(NumPoints, Density.ExpectedPoints()));
+    Grid.Reset(Density.MinDist(), Density.MaxDist());
+
+    const sBounds Bounds = D.Bounds();
+    sPoint FirstPoint;
+
+    do {
+        FirstPoint = sPoint( Bounds.X0 + Generator.RandomFloat() * (Bounds.X1 - Bounds.X0),
+                             Bounds.Y0 + Generator.RandomFloat() * (Bounds.Y1 - Bounds.Y0) );
+    } while (!D.Contains( FirstPoint ));
+
+    ProcessList.push_back( FirstPoint );
+    SamplePoints.push_back( FirstPoint );
+    Grid.Insert( FirstPoint, Density.Radius( FirstPoint ) );
+
+    size_t NextReport = ProgressStep;
+    while ( !ProcessList.empty() && SamplePoints.size() < NumPoints )
+    {
+        const sPoint Point = PopRandom<PRNG>( ProcessList, Generator );
+        const float Radius = Density.Radius( Point );
+        VT_COUNT(vt::instrument::POISSON_CANDIDATES, Settings.NewPointsCount);
+
+        for ( int i = 0; i < Settings.NewPointsCount; i++ )
+        {
+            const sPoint NewPoint = GenerateRandomPointAround( Point, Radius, Generator );
+
+            if ( !D.Contains( NewPoint ) )
+            {
+                VT_COUNT(vt::instrument::POISSON_DOMAIN_REJECTS, 1);
+                continue;
+            }
+
+            const float NewRadius = Density.Radius( NewPoint );
+            if ( Grid.IsInNeighbourhood( NewPoint, NewRadius ) )
+            {
+                VT_COUNT(vt::instrument::POISSON_NEIGHBOUR_REJECTS, 1);
+                continue;
+            }
+
+            ProcessList.push_back( NewPoint );
+            SamplePoints.push_back( NewPoint );
+            Grid.Insert( NewPoint, NewRadius );
+        }
+
+        if ( Settings.Progress && SamplePoints.size() >= NextReport )
+        {
+            NextReport = SamplePoints.size() + ProgressStep;
+            if ( !Settings.Progress( std::min(float(SamplePoints.size()) / NumPoints, 1.0f) ) )
+                return SamplePoints;
+        }
+    }
+
+    if ( Settings.Progress )
+        Settings.Progress( 1.0f );
+
+    return SamplePoints;
+}
+
+/// Return a vector of points of the unit square, spaced as Density says
+template <typename PRNG = DefaultPRNG>
+std::vector<sPoint> GenerateVariablePoissonPoints(
+    size_t NumPoints,
+    PRNG& Generator,
+    const sDensityMap &Density,
+    const sSettings &Settings = sSettings()
+)
+{
+    sVariableContext Context;
+    GenerateVariablePoissonPoints(NumPoints, Generator, Density, Settings, sRectangleDomain(), Context);
+    return std::move(Context.SamplePoints);
+}
+
+} // namespace PoissonGenerator
+
+
+#endif // POISSONGRID_H
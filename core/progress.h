@@ -0,0 +1,31 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <exception>
+#include <functional>
+
+namespace vt {
+
+/**
+ * Progress report of a long computation, called with the fraction done in
+ * [0, 1]. Returning false cancels the computation, which then throws
+ * Cancelled. Computations running on a pool may call it from any of its
+ * threads, concurrently.
+ */
+using Progress = std::function<bool(double)>;
+
+/// thrown by a computation its Progress callback cancelled
+class Cancelled : public std::exception {
+public:
+    const char *what() const noexcept override { return "cancelled"; }
+};
+
+/// reports to progress if any, throwing Cancelled when asked to stop
+inline void report(const Progress &progress, double done) {
+    if (progress && !progress(done))
+        throw Cancelled();
+}
+
+} // namespace vt
+
+#endif // PROGRESS_H
@@ -0,0 +1,154 @@
+#ifndef QUANTIZER_H
+#define QUANTIZER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <boost/polygon/voronoi.hpp>
+
+namespace vt {
+
+namespace detail {
+
+// largest coordinate magnitude a quantizer may produce: the whole int32
+// range for the default Boost traits
+template <typename Int> struct QuantizerLimit;
+template <> struct QuantizerLimit<int32_t> {
+    static double value() { return double(std::numeric_limits<int32_t>::max()); }
+};
+
+} // namespace detail
+
+/**
+ * Conversion between tile coordinates and the integer coordinates fed to
+ * Boost.Polygon, which only works robustly on integers.
+ *
+ * The scale is the largest power of two that keeps [0,w]x[0,h] within the
+ * safe range of Int, so a 10x10 tile gets much finer steps than a 1000x1000
+ * one, and going back to tile coordinates is an exact division in double.
+ */
+template <typename Int>
+class Quantizer {
+public:
+    using IntType = Int;
+
+    Quantizer() : m_scale(1.0), m_inv(1.0) {}
+
+    Quantizer(double w, double h) {
+        const double extent = std::max(std::max(w, h), 1.0);
+        int e = 0;
+        std::frexp(detail::QuantizerLimit<Int>::value() / extent, &e);
+        // frexp gives limit/extent in [2^(e-1), 2^e)
+        m_scale = std::ldexp(1.0, e - 1);
+        m_inv = 1.0 / m_scale;
+    }
+
+    double scale() const { return m_scale; }
+
+    /// nearest integer coordinate
+    Int toInt(double v) const { return Int(std::llround(v * m_scale)); }
+
+    /// tile coordinate of an integer (or integer-based) coordinate, exact
+    double toReal(double v) const { return v * m_inv; }
+
+private:
+    double m_scale;
+    double m_inv;
+};
+
+using Quantizer32 = Quantizer<int32_t>;
+
+namespace detail {
+
+// indices of the distinct sites by x, then y, the lowest index first among
+// equal sites
+template <typename Point>
+void distinctSites(const std::vector<Point> &sites, std::vector<size_t> &origin) {
+    origin.resize(sites.size());
+    for (size_t i = 0; i < sites.size(); ++i)
+        origin[i] = i;
+
+    std::sort(origin.begin(), origin.end(), [&](size_t a, size_t b) {
+        if (sites[a].x() != sites[b].x())
+            return sites[a].x() < sites[b].x();
+        if (sites[a].y() != sites[b].y())
+            return sites[a].y() < sites[b].y();
+        return a < b;
+    });
+    origin.erase(std::unique(origin.begin(), origin.end(), [&](size_t a, size_t b) {
+        return sites[a] == sites[b];
+    }), origin.end());
+}
+
+} // namespace detail
+
+/**
+ * Drops the sites that coincide once quantized, keeping the one with the
+ * lowest index. unique receives the remaining sites and origin their index
+ * in sites, both in increasing index order.
+ */
+template <typename Point>
+void uniqueSites(const std::vector<Point> &sites, std::vector<Point> &unique,
+                 std::vector<size_t> &origin) {
+    detail::distinctSites(sites, origin);
+    std::sort(origin.begin(), origin.end());
+
+    unique.clear();
+    unique.reserve(origin.size());
+    for (size_t i : origin)
+        unique.push_back(sites[i]);
+}
+
+/**
+ * Same merge as uniqueSites(), in sweep order instead: by x, then by y, the
+ * order in which Boost's sweep line visits the sites. Fed to the sweep in
+ * that order, they spare it most of its own sort, and a pass over the cells
+ * of the diagram walks them sequentially.
+ */
+template <typename Point>
+void sweepUniqueSites(const std::vector<Point> &sites, std::vector<Point> &unique,
+                      std::vector<size_t> &origin) {
+    detail::distinctSites(sites, origin);
+
+    unique.clear();
+    unique.reserve(origin.size());
+    for (size_t i : origin)
+        unique.push_back(sites[i]);
+}
+
+/**
+ * Coordinate traits for Boost.Polygon Voronoi on 64-bit integer sites. The
+ * products of coordinate differences need 128 bits, and the lazy exact
+ * predicates a proportionally wider big integer. Only the ghost band of
+ * computeVoronoiWrapped() needs them, when it runs past the int32 range:
+ * tile sites are always quantized to int32.
+ */
+struct VoronoiTraits64 {
+    typedef boost::int64_t int_type;
+    typedef boost::polygon::detail::extended_int<4> int_x2_type;
+    typedef boost::polygon::detail::extended_int<4> uint_x2_type;
+    typedef boost::polygon::detail::extended_int<128> big_int_type;
+    typedef double fpt_type;
+    typedef boost::polygon::detail::extended_exponent_fpt<fpt_type> efpt_type;
+    typedef boost::polygon::detail::ulp_comparison<fpt_type> ulp_cmp_type;
+    typedef boost::polygon::detail::type_converter_fpt to_fpt_converter_type;
+    typedef boost::polygon::detail::type_converter_efpt to_efpt_converter_type;
+};
+
+using VoronoiBuilder64 = boost::polygon::voronoi_builder<boost::int64_t, VoronoiTraits64>;
+
+/// construct_voronoi() counterpart for sites with 64-bit coordinates
+template <typename It>
+void constructVoronoi64(It first, It last, boost::polygon::voronoi_diagram<double> *vd) {
+    VoronoiBuilder64 builder;
+    for (It it = first; it != last; ++it)
+        builder.insert_point(boost::int64_t(it->x()), boost::int64_t(it->y()));
+    builder.construct(vd);
+}
+
+} // namespace vt
+
+#endif // QUANTIZER_H
@@ -0,0 +1,451 @@
+#include "regions.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "instrument.h"
+#include "poisson-grid.h"
+
+namespace vt {
+
+namespace {
+
+// stream of the seed the region seeds draw from, the tiling sampler and
+// the jitter use the others
+const uint64_t REGION_STREAM = 2;
+
+// a maximal Poisson sampling of the unit square with spacing d holds about
+// 0.65 / d^2 points
+const float SAMPLE_DENSITY = 0.65f;
+
+// shortest signed offset of d along an axis of the given period, 0 for an
+// axis that does not wrap
+double periodic(double d, double period) {
+    return period > 0.0 ? d - period * std::round(d / period) : d;
+}
+
+double wrapInto(double v, double period) {
+    if (period <= 0.0)
+        return v;
+    v = std::fmod(v, period);
+    return v < 0.0 ? v + period : v;
+}
+
+std::vector<CellVertex> sampleSeeds(int w, int h, int k, uint32_t seed, Wrap wrap) {
+    PoissonGenerator::sSettings settings;
+    settings.MinDist = std::sqrt(SAMPLE_DENSITY / float(k));
+    settings.WrapX = (wrap & WRAP_X) != 0;
+    settings.WrapY = (wrap & WRAP_Y) != 0;
+
+    PoissonGenerator::PcgPRNG prng(seed, REGION_STREAM);
+    PoissonGenerator::sContext context;
+    const auto &points = PoissonGenerator::GeneratePoissonPoints(size_t(-1), prng, settings,
+                                                                 PoissonGenerator::sRectangleDomain(), context);
+
+    std::vector<CellVertex> seeds;
+    seeds.reserve(points.size());
+    for (const auto &p : points)
+        seeds.emplace_back(double(p.x) * w, double(p.y) * h);
+    return seeds;
+}
+
+/// nearest seed lookups through a bucket grid of about one seed per bucket
+class SeedIndex {
+public:
+    SeedIndex(const std::vector<CellVertex> &seeds, double w, double h, double px, double py)
+        : m_seeds(seeds)
+        , m_px(px)
+        , m_py(py)
+    {
+        m_size = std::max(std::sqrt(w * h / double(std::max<size_t>(seeds.size(), 1))), 1e-9);
+        m_cols = std::max(int(std::ceil(w / m_size)), 1);
+        m_rows = std::max(int(std::ceil(h / m_size)), 1);
+
+        m_offsets.assign(size_t(m_cols) * size_t(m_rows) + 1, 0);
+        for (const CellVertex &s : seeds)
+            ++m_offsets[bucketOf(s) + 1];
+        for (size_t b = 1; b < m_offsets.size(); ++b)
+            m_offsets[b] += m_offsets[b - 1];
+        m_items.resize(seeds.size());
+        std::vector<uint32_t> fill(m_offsets.begin(), m_offsets.end() - 1);
+        for (size_t i = 0; i < seeds.size(); ++i)
+            m_items[fill[bucketOf(seeds[i])]++] = uint32_t(i);
+    }
+
+    /// nearest seed of p, the lowest index among the nearest ones
+    uint32_t nearest(const CellVertex &p) const {
+        const double x = wrapInto(p.x(), m_px), y = wrapInto(p.y(), m_py);
+        const int bx = column(p.x()), by = row(p.y());
+        uint32_t best = NO_CELL;
+        double best_d = 0.0;
+
+        // the buckets of ring r and beyond lie outside of the block of the
+        // rings before, at least as far from p as the sides of that block
+        const int rings = std::max(m_cols, m_rows);
+        for (int r = 0; r <= rings; ++r) {
+            const double reach = std::max(std::min(std::min(x - (bx - r + 1) * m_size, (bx + r) * m_size - x),
+                                                   std::min(y - (by - r + 1) * m_size, (by + r) * m_size - y)),
+                                          0.0);
+            if (r > 0 && best != NO_CELL && best_d <= reach * reach)
+                break;
+            for (int j = by - r; j <= by + r; ++j) {
+                const bool edge = j == by - r || j == by + r;
+                for (int i = bx - r; i <= bx + r; i += edge || r == 0 ? 1 : 2 * r) {
+                    const int cx = m_px > 0.0 ? wrap(i, m_cols) : i;
+                    const int cy = m_py > 0.0 ? wrap(j, m_rows) : j;
+                    if (cx < 0 || cx >= m_cols || cy < 0 || cy >= m_rows)
+                        continue;
+                    const size_t b = size_t(cy) * size_t(m_cols) + size_t(cx);
+                    for (uint32_t k = m_offsets[b]; k < m_offsets[b + 1]; ++k) {
+                        const uint32_t s = m_items[k];
+                        const double dx = periodic(m_seeds[s].x() - p.x(), m_px);
+                        const double dy = periodic(m_seeds[s].y() - p.y(), m_py);
+                        const double d = dx * dx + dy * dy;
+                        if (best == NO_CELL || d < best_d || (d == best_d && s < best)) {
+                            best = s;
+                            best_d = d;
+                        }
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+private:
+    static int wrap(int i, int n) {
+        i %= n;
+        return i < 0 ? i + n : i;
+    }
+
+    int column(double x) const {
+        const int c = int(std::floor(wrapInto(x, m_px) / m_size));
+        return std::min(std::max(c, 0), m_cols - 1);
+    }
+    int row(double y) const {
+        const int r = int(std::floor(wrapInto(y, m_py) / m_size));
+        return std::min(std::max(r, 0), m_rows - 1);
+    }
+    size_t bucketOf(const CellVertex &p) const {
+        return size_t(row(p.y())) * size_t(m_cols) + size_t(column(p.x()));
+    }
+
+    const std::vector<CellVertex> &m_seeds;
+    double m_px, m_py;
+    double m_size;
+    int m_cols, m_rows;
+    std::vector<uint32_t> m_offsets, m_items;
+};
+
+/// boundary rings of one region, ring sizes and vertices back to back
+struct Outline {
+    std::vector<uint32_t> sizes;
+    std::vector<CellVertex> vertices;
+};
+
+/**
+ * Walks the boundary of the regions along the half-edges of the cells: the
+ * edges with another region or no cell across. The next boundary edge after
+ * one ending at P is found by turning around P through the cells of the
+ * region, from an inner edge to its twin in the cell across, so that no
+ * vertex has to be matched by its coordinates. On wrapped tiles the cells
+ * across a wrapped border lie on the other side, the walk then shifts them
+ * back next to the ring.
+ */
+class OutlineWalker {
+public:
+    OutlineWalker(const CellStore &cells, const std::vector<uint32_t> &edges, const std::vector<uint32_t> &labels,
+                  bool wrapped)
+        : m_cells(cells)
+        , m_edges(edges)
+        , m_labels(labels)
+        , m_wrapped(wrapped)
+        , m_visited(cells.vertices().size(), 0)
+    {
+    }
+
+    /// rings of the region made of the given cells, in cell then ring order
+    void walk(const uint32_t *begin, const uint32_t *end, Outline &out) {
+        size_t limit = 1;
+        for (const uint32_t *c = begin; c != end; ++c)
+            limit += m_cells[*c].size();
+
+        for (const uint32_t *c = begin; c != end; ++c) {
+            for (size_t j = 0; j < m_cells[*c].size(); ++j) {
+                if (isBoundary(*c, j) && !m_visited[edgeIndex(*c, j)])
+                    ring(*c, j, limit, out);
+            }
+        }
+    }
+
+private:
+    size_t edgeIndex(uint32_t c, size_t j) const { return m_cells.offsets()[c] + j; }
+
+    bool isBoundary(uint32_t c, size_t j) const {
+        const uint32_t across = m_edges[edgeIndex(c, j)];
+        return across == NO_CELL || m_labels[across] != m_labels[c];
+    }
+
+    // half-edge of d going back along edge j of c, best matching its
+    // geometry in case d borders c twice, which only tiny wrapped tiles do
+    size_t twin(uint32_t d, uint32_t c, size_t j) const {
+        const CellView from = m_cells[c];
+        const CellView to = m_cells[d];
+        const CellVertex &p = from[j];
+        const CellVertex &q = from[(j + 1) % from.size()];
+
+        size_t best = size_t(-1);
+        double best_d = 0.0;
+        for (size_t t = 0; t < to.size(); ++t) {
+            if (m_edges[edgeIndex(d, t)] != c)
+                continue;
+            const CellVertex &a = to[t];
+            const CellVertex &b = to[(t + 1) % to.size()];
+            const double dx = (a.x() - b.x()) - (q.x() - p.x());
+            const double dy = (a.y() - b.y()) - (q.y() - p.y());
+            const double dd = dx * dx + dy * dy;
+            if (best == size_t(-1) || dd < best_d) {
+                best = t;
+                best_d = dd;
+            }
+        }
+        return best;
+    }
+
+    void ring(uint32_t c0, size_t j0, size_t limit, Outline &out) {
+        const size_t first = out.vertices.size();
+        double sx = 0.0, sy = 0.0;   // from the frame of cell c to the one of the ring
+        uint32_t c = c0;
+        size_t j = j0;
+
+        for (size_t steps = 0; steps < limit; ++steps) {
+            m_visited[edgeIndex(c, j)] = 1;
+            const CellView cell = m_cells[c];
+            out.vertices.emplace_back(cell[j].x() + sx, cell[j].y() + sy);
+
+            // around the end of the edge up to the next boundary edge
+            j = (j + 1) % cell.size();
+            for (size_t turns = 0; !isBoundary(c, j) && turns < limit; ++turns) {
+                const uint32_t d = m_edges[edgeIndex(c, j)];
+                const size_t t = twin(d, c, j);
+                if (t == size_t(-1))
+                    break;
+
+                const CellView across = m_cells[d];
+                const size_t next = (t + 1) % across.size();
+                if (m_wrapped) {
+                    sx += m_cells[c][j].x() - across[next].x();
+                    sy += m_cells[c][j].y() - across[next].y();
+                }
+                c = d;
+                j = next;
+            }
+
+            if (c == c0 && j == j0)
+                break;
+        }
+
+        const size_t size = out.vertices.size() - first;
+        if (size < 3)
+            out.vertices.resize(first);
+        else
+            out.sizes.push_back(uint32_t(size));
+    }
+
+    const CellStore &m_cells;
+    const std::vector<uint32_t> &m_edges;
+    const std::vector<uint32_t> &m_labels;
+    const bool m_wrapped;
+    std::vector<uint8_t> m_visited;   // per half-edge, each region only touches its own
+};
+
+} // namespace
+
+Regions clusterCells(const std::vector<CellVertex> &sites, const CellStore &cells, const Adjacency &adjacency,
+                     const std::vector<uint32_t> &edges, int w, int h, int k, uint32_t seed, ThreadPool &pool,
+                     Wrap wrap, int iterations) {
+    VT_SCOPE("regions");
+
+    assert(edges.size() == cells.vertices().size() && adjacency.size() == cells.size());
+
+    Regions regions;
+    const size_t n = cells.size();
+    if (n == 0 || k <= 0)
+        return regions;
+
+    const double px = (wrap & WRAP_X) ? double(w) : 0.0;
+    const double py = (wrap & WRAP_Y) ? double(h) : 0.0;
+    std::vector<uint32_t> &labels = regions.labels;
+    labels.assign(n, NO_CELL);
+
+    if (size_t(k) > n)
+        k = int(n);
+    std::vector<CellVertex> seeds = sampleSeeds(w, h, k, seed, wrap);
+
+    std::vector<double> areas(n);
+    std::vector<CellVertex> centres(n);
+    pool.parallelFor(0, n, [&](size_t i) {
+        areas[i] = std::fabs(area(cells[i]));
+        centres[i] = centroid(cells[i]);
+    });
+
+    // nearest seeds, and Lloyd steps moving the seeds to the centroids of
+    // their regions; summed in cell order, the same on any pool
+    {
+        VT_SCOPE("regions.label");
+        for (int it = 0;; ++it) {
+            const SeedIndex index(seeds, w, h, px, py);
+            pool.parallelFor(0, n, [&](size_t i) {
+                if (!cells[i].empty())
+                    labels[i] = index.nearest(sites[i]);
+            });
+            if (it >= iterations)
+                break;
+
+            std::vector<double> mass(seeds.size(), 0.0), mx(seeds.size(), 0.0), my(seeds.size(), 0.0);
+            for (size_t i = 0; i < n; ++i) {
+                const uint32_t r = labels[i];
+                if (r == NO_CELL)
+                    continue;
+                mass[r] += areas[i];
+                mx[r] += areas[i] * periodic(centres[i].x() - seeds[r].x(), px);
+                my[r] += areas[i] * periodic(centres[i].y() - seeds[r].y(), py);
+            }
+            for (size_t r = 0; r < seeds.size(); ++r) {
+                if (mass[r] > 0.0)
+                    seeds[r] = CellVertex(wrapInto(seeds[r].x() + mx[r] / mass[r], px),
+                                          wrapInto(seeds[r].y() + my[r] / mass[r], py));
+            }
+        }
+    }
+
+    // only the largest piece of each region along adjacency keeps it, the
+    // others go to the regions around them, nearest settled cells first
+    {
+        VT_SCOPE("regions.connect");
+        std::vector<uint32_t> component(n, NO_CELL);
+        std::vector<double> component_area;
+        std::vector<uint32_t> largest(seeds.size(), NO_CELL);
+        std::vector<uint32_t> stack;
+        for (size_t i = 0; i < n; ++i) {
+            if (labels[i] == NO_CELL || component[i] != NO_CELL)
+                continue;
+            const uint32_t id = uint32_t(component_area.size());
+            double total = 0.0;
+            component[i] = id;
+            stack.push_back(uint32_t(i));
+            while (!stack.empty()) {
+                const uint32_t c = stack.back();
+                stack.pop_back();
+                total += areas[c];
+                for (uint32_t d : adjacency[c]) {
+                    if (component[d] == NO_CELL && labels[d] == labels[i]) {
+                        component[d] = id;
+                        stack.push_back(d);
+                    }
+                }
+            }
+            component_area.push_back(total);
+
+            uint32_t &best = largest[labels[i]];
+            if (best == NO_CELL || total > component_area[best])
+                best = id;
+        }
+
+        std::vector<uint8_t> settled(n, 0);
+        for (size_t i = 0; i < n; ++i)
+            settled[i] = labels[i] != NO_CELL && component[i] == largest[labels[i]];
+
+        std::vector<uint32_t> queue;
+        std::vector<uint8_t> queued(n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            if (settled[i] || labels[i] == NO_CELL)
+                continue;
+            for (uint32_t d : adjacency[i]) {
+                if (settled[d]) {
+                    queue.push_back(uint32_t(i));
+                    queued[i] = 1;
+                    break;
+                }
+            }
+        }
+        for (size_t q = 0; q < queue.size(); ++q) {
+            const uint32_t c = queue[q];
+            for (uint32_t d : adjacency[c]) {
+                if (settled[d]) {
+                    labels[c] = labels[d];
+                    break;
+                }
+            }
+            settled[c] = 1;
+            for (uint32_t d : adjacency[c]) {
+                if (!settled[d] && !queued[d] && labels[d] != NO_CELL) {
+                    queue.push_back(d);
+                    queued[d] = 1;
+                }
+            }
+        }
+    }
+
+    // regions left without cells are dropped, the others numbered in seed order
+    std::vector<uint32_t> counts(seeds.size() + 1, 0);
+    for (uint32_t r : labels) {
+        if (r != NO_CELL)
+            ++counts[r + 1];
+    }
+    std::vector<uint32_t> renumber(seeds.size(), NO_CELL);
+    uint32_t count = 0;
+    for (size_t r = 0; r < seeds.size(); ++r) {
+        if (counts[r + 1])
+            renumber[r] = count++;
+    }
+    for (uint32_t &r : labels) {
+        if (r != NO_CELL)
+            r = renumber[r];
+    }
+
+    // cells of each region, then their outlines region by region
+    std::vector<uint32_t> offsets(size_t(count) + 1, 0);
+    for (uint32_t r : labels) {
+        if (r != NO_CELL)
+            ++offsets[r + 1];
+    }
+    for (size_t r = 0; r < count; ++r)
+        offsets[r + 1] += offsets[r];
+    std::vector<uint32_t> members(offsets[count]);
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        if (labels[i] != NO_CELL)
+            members[fill[labels[i]]++] = uint32_t(i);
+    }
+
+    std::vector<Outline> outlines(count);
+    {
+        VT_SCOPE("regions.outlines");
+        OutlineWalker walker(cells, edges, labels, wrap != WRAP_NONE);
+        pool.parallelFor(0, count, [&](size_t r) {
+            walker.walk(members.data() + offsets[r], members.data() + offsets[r + 1], outlines[r]);
+        });
+    }
+
+    size_t rings = 0, vertices = 0;
+    for (const Outline &o : outlines) {
+        rings += o.sizes.size();
+        vertices += o.vertices.size();
+    }
+    regions.outlines.reserve(rings, vertices);
+    regions.ringOffsets.reserve(size_t(count) + 1);
+    regions.ringOffsets.push_back(0);
+    for (const Outline &o : outlines) {
+        const CellVertex *v = o.vertices.data();
+        for (uint32_t size : o.sizes) {
+            regions.outlines.append(CellView(v, v + size));
+            v += size;
+        }
+        regions.ringOffsets.push_back(uint32_t(regions.outlines.size()));
+    }
+    return regions;
+}
+
+} // namespace vt
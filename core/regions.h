@@ -0,0 +1,62 @@
+#ifndef REGIONS_H
+#define REGIONS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "adjacency.h"
+#include "cell-store.h"
+#include "thread-pool.h"
+#include "tiling.h"
+
+namespace vt {
+
+/**
+ * Cells of a tiling merged into larger connected regions, provinces of the
+ * map, with their outlines as a coarser level of detail of it.
+ *
+ * The outline rings are stored back to back like cells, the rings of
+ * region r spanning [ringOffsets[r], ringOffsets[r+1]) of them: its outer
+ * boundary turns the way the cells do and its holes the other way. Ring
+ * vertices are cell vertices, outlines follow the cell edges exactly.
+ */
+struct Regions {
+    std::vector<uint32_t> labels;        ///< region of each cell, NO_CELL for empty cells
+    std::vector<uint32_t> ringOffsets;   ///< size() + 1, rings of each region in outlines
+    CellStore outlines;
+
+    /// number of regions
+    size_t size() const { return ringOffsets.empty() ? 0 : ringOffsets.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    void clear() {
+        labels.clear();
+        ringOffsets.clear();
+        outlines.clear();
+    }
+};
+
+/**
+ * Groups the cells of a w x h tile into about k connected regions of even
+ * areas.
+ *
+ * The region seeds are a second Poisson sample of the tile, k sites large,
+ * drawn from a stream of seed of its own. Every cell goes to the seed
+ * nearest to its site, which iterations Lloyd steps then move to the
+ * area-weighted centroids of their regions. Pieces of a region cut off
+ * from its largest one go to the regions around them, so that each region
+ * is connected along adjacency. Labelling and the outlines run in parallel
+ * on the pool, the result does not depend on it.
+ *
+ * sites are in tile coordinates, adjacency and edges as computeVoronoi()
+ * gives them. On wrapped tiles distances run across the wrapped borders and
+ * outlines follow the cells over them, see computeVoronoiWrapped().
+ */
+Regions clusterCells(const std::vector<CellVertex> &sites, const CellStore &cells, const Adjacency &adjacency,
+                     const std::vector<uint32_t> &edges, int w, int h, int k, uint32_t seed,
+                     ThreadPool &pool = defaultPool(), Wrap wrap = WRAP_NONE, int iterations = 3);
+
+} // namespace vt
+
+#endif // REGIONS_H
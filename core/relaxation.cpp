@@ -0,0 +1,68 @@
+#include "relaxation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "instrument.h"
+
+namespace vt {
+
+Relaxation::Relaxation(int w, int h, ThreadPool &pool)
+    : m_w(w)
+    , m_h(h)
+    , m_pool(pool)
+    , m_quant(w, h)
+    , m_last_shift(0.0)
+    , m_context(pool)
+    , m_shifts(8 * pool.concurrency(), 0.0)
+{
+}
+
+// moves each site to the centroid of its cell, sites left without a cell
+// by a coincident one stay where they are
+double Relaxation::moveSites(Grid &sites) {
+    VT_SCOPE("relax.centroids");
+    const size_t n = sites.size();
+    const size_t blocks = m_shifts.size();
+
+    m_pool.parallelFor(0, blocks, 1, [&](size_t b) {
+        double shift = 0.0;
+        for (size_t i = n * b / blocks, end = n * (b + 1) / blocks; i < end; ++i) {
+            const CellView cell = m_context.cells()[i];
+            if (cell.empty())
+                continue;
+
+            const CellVertex c = centroid(cell);
+            const double x = std::min(std::max(c.x(), 0.0), double(m_w));
+            const double y = std::min(std::max(c.y(), 0.0), double(m_h));
+            const double dx = x - m_quant.toReal(sites[i].x());
+            const double dy = y - m_quant.toReal(sites[i].y());
+
+            shift = std::max(shift, dx * dx + dy * dy);
+            sites[i] = Site(m_quant.toInt(x), m_quant.toInt(y));
+        }
+        m_shifts[b] = shift;
+    });
+
+    return std::sqrt(*std::max_element(m_shifts.begin(), m_shifts.end()));
+}
+
+int Relaxation::relax(Grid &sites, int iterations, double tolerance, const Progress &progress) {
+    m_context.computeVoronoi(sites, m_w, m_h);
+    m_last_shift = 0.0;
+
+    int done = 0;
+    while (done < iterations) {
+        m_last_shift = moveSites(sites);
+        m_context.computeVoronoi(sites, m_w, m_h);
+        ++done;
+
+        if (m_last_shift <= tolerance)
+            break;
+        report(progress, double(done) / iterations);
+    }
+    report(progress, 1.0);
+    return done;
+}
+
+} // namespace vt
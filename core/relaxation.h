@@ -0,0 +1,54 @@
+#ifndef RELAXATION_H
+#define RELAXATION_H
+
+#include <cstddef>
+#include <vector>
+
+#include "cell-store.h"
+#include "progress.h"
+#include "thread-pool.h"
+#include "tiling.h"
+
+namespace vt {
+
+/**
+ * Lloyd relaxation: each iteration moves every site to the area-weighted
+ * centroid of its cell and rebuilds the cells, evening out their sizes.
+ *
+ * Centroids are computed in parallel over the cell store. The cells are
+ * built in a TilingContext kept from one iteration and one relax() call to
+ * the next, so the iterations do not allocate once the first one has sized
+ * its buffers, see TilingContext for the exceptions.
+ */
+class Relaxation {
+public:
+    Relaxation(int w, int h, ThreadPool &pool = defaultPool());
+
+    /**
+     * Runs up to iterations Lloyd steps on sites, in place, stopping early
+     * once no site moves by more than tolerance in tile units. Returns the
+     * number of iterations run, cells() then holding the cells of the
+     * relaxed sites. progress is told after each iteration, if it cancels
+     * sites are left as the last completed iteration made them.
+     */
+    int relax(Grid &sites, int iterations, double tolerance = 0.0, const Progress &progress = Progress());
+
+    const CellStore &cells() const { return m_context.cells(); }
+    /// largest site displacement of the last iteration, in tile units
+    double lastShift() const { return m_last_shift; }
+
+private:
+    double moveSites(Grid &sites);
+
+    int m_w, m_h;
+    ThreadPool &m_pool;
+    GridQuantizer m_quant;
+    double m_last_shift;
+
+    TilingContext m_context;
+    std::vector<double> m_shifts;
+};
+
+} // namespace vt
+
+#endif // RELAXATION_H
@@ -0,0 +1,195 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vt {
+
+/**
+ * Small work-stealing thread pool.
+ *
+ * Every worker owns a task deque: it pops its own tasks from the back and
+ * steals from the front of the other deques once its own is empty. The thread
+ * calling parallelFor() also runs tasks until its loop is done, so loops can
+ * be nested and a pool with no worker simply runs everything inline.
+ */
+class ThreadPool {
+public:
+    /// @param workers number of background threads, 0 runs every loop on the caller
+    explicit ThreadPool(unsigned workers = std::max(std::thread::hardware_concurrency(), 1u) - 1)
+        : m_queues(workers + 1)
+    {
+        for (auto &q : m_queues)
+            q.reset(new Queue);
+
+        for (unsigned i = 0; i < workers; ++i)
+            m_workers.emplace_back([this, i] { work(i + 1); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+
+        for (auto &t : m_workers)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// number of threads taking part in a loop, the caller included
+    unsigned concurrency() const {
+        return unsigned(m_workers.size()) + 1;
+    }
+
+    /**
+     * Calls fn(i) for every i in [begin, end) and waits for all of them.
+     * Indices are handed out in chunks of grain consecutive values. The first
+     * exception thrown by fn is rethrown here once the loop has drained.
+     */
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F &&fn) {
+        if (begin >= end)
+            return;
+
+        grain = std::max<size_t>(grain, 1);
+        const size_t chunks = (end - begin + grain - 1) / grain;
+
+        if (chunks == 1 || m_workers.empty()) {
+            for (size_t i = begin; i < end; ++i)
+                fn(i);
+            return;
+        }
+
+        auto group = std::make_shared<Group>();
+        group->remaining = chunks;
+
+        for (size_t c = 0; c < chunks; ++c) {
+            const size_t first = begin + c * grain;
+            const size_t last = std::min(first + grain, end);
+
+            push(c % m_queues.size(), [group, first, last, &fn] {
+                try {
+                    if (!group->failed.load(std::memory_order_relaxed)) {
+                        for (size_t i = first; i < last; ++i)
+                            fn(i);
+                    }
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(group->mutex);
+                    if (!group->failed.exchange(true))
+                        group->error = std::current_exception();
+                }
+                group->remaining.fetch_sub(1, std::memory_order_acq_rel);
+            });
+        }
+
+        // help until every chunk of this loop has run
+        while (group->remaining.load(std::memory_order_acquire) > 0) {
+            if (!runOne(0))
+                std::this_thread::yield();
+        }
+
+        if (group->error)
+            std::rethrow_exception(group->error);
+    }
+
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, F &&fn) {
+        const size_t n = end > begin ? end - begin : 0;
+        parallelFor(begin, end, std::max<size_t>(n / (8 * concurrency()), 1), std::forward<F>(fn));
+    }
+
+private:
+    using Task = std::function<void()>;
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct Group {
+        std::atomic<size_t> remaining{0};
+        std::atomic<bool> failed{false};
+        std::mutex mutex;
+        std::exception_ptr error;
+    };
+
+    void push(size_t queue, Task task) {
+        {
+            std::lock_guard<std::mutex> lock(m_queues[queue]->mutex);
+            m_queues[queue]->tasks.push_back(std::move(task));
+        }
+        m_pending.fetch_add(1, std::memory_order_release);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wake.notify_one();
+    }
+
+    // pops from our own deque first, then steals from the others
+    bool runOne(size_t self) {
+        Task task;
+
+        for (size_t k = 0; k < m_queues.size() && !task; ++k) {
+            auto &q = *m_queues[(self + k) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+
+            if (q.tasks.empty())
+                continue;
+
+            if (k == 0) {
+                task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+            }
+            else {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+            }
+        }
+
+        if (!task)
+            return false;
+
+        m_pending.fetch_sub(1, std::memory_order_acq_rel);
+        task();
+        return true;
+    }
+
+    void work(size_t self) {
+        for (;;) {
+            if (runOne(self))
+                continue;
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] {
+                return m_stop || m_pending.load(std::memory_order_acquire) > 0;
+            });
+
+            if (m_stop)
+                return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<size_t> m_pending{0};
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+};
+
+} // namespace vt
+
+#endif // THREAD_POOL_H
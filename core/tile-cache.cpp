@@ -0,0 +1,211 @@
+#include "tile-cache.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "poisson-grid.h"
+#include "tile-format.h"
+
+namespace vt {
+
+namespace {
+
+// FNV-1a, the key is canonicalized as text first so that the hash does not
+// depend on struct layout nor byte order
+uint64_t fnv1a(const std::string &s) {
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : s)
+        h = (h ^ c) * 1099511628211ull;
+    return h;
+}
+
+// distinct names for the files being written, across threads and processes
+std::atomic<uint64_t> g_pending(0);
+
+} // namespace
+
+TileKey tileKey(int w, int h, int num, uint32_t seed, int iterations, bool adjacency, Wrap wrap, int regions) {
+    return TileKey{w, h, num, seed, PoissonGenerator::sSettings().NewPointsCount, iterations, adjacency, wrap,
+                   regions};
+}
+
+uint64_t hashKey(const TileKey &key) {
+    char text[256];
+    std::snprintf(text, sizeof(text), "vt-tile w=%d h=%d num=%d seed=%" PRIu32 " k=%d iterations=%d adjacency=%d"
+                  " wrap=%u regions=%d poisson=%s format=%" PRIu32 " revision=%" PRIu32,
+                  key.w, key.h, key.num, key.seed, key.newPointsCount, key.iterations, int(key.adjacency),
+                  key.wrap, key.regions, PoissonGenerator::Version, TILE_FILE_VERSION, TILE_CACHE_REVISION);
+    return fnv1a(text);
+}
+
+TileCache::TileCache(size_t memoryBudget, const std::string &directory)
+    : m_budget(memoryBudget)
+    , m_directory(directory)
+{
+    std::memset(&m_stats, 0, sizeof(m_stats));
+}
+
+TileCache::Tile TileCache::find(const TileKey &key) {
+    const uint64_t hash = hashKey(key);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(hash);
+        if (it != m_index.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+            ++m_stats.memoryHits;
+            return it->second->tile;
+        }
+    }
+
+    // the disk is read unlocked, other lookups go on meanwhile
+    Tile tile = readFile(hash);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!tile) {
+        ++m_stats.misses;
+        return tile;
+    }
+    ++m_stats.diskHits;
+    keep(hash, tile);
+    return tile;
+}
+
+void TileCache::insert(const TileKey &key, Tile tile) {
+    const uint64_t hash = hashKey(key);
+    writeFile(hash, *tile);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.insertions;
+    keep(hash, std::move(tile));
+}
+
+TileCacheStats TileCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void TileCache::keep(uint64_t hash, Tile tile) {
+    auto it = m_index.find(hash);
+    if (it != m_index.end()) {
+        m_stats.memoryBytes -= it->second->tile->size();
+        m_lru.erase(it->second);
+        m_index.erase(it);
+    }
+
+    // larger than the whole budget, the disk keeps it if any
+    if (tile->size() > m_budget)
+        return;
+
+    m_stats.memoryBytes += tile->size();
+    m_lru.push_front(Entry{hash, std::move(tile)});
+    m_index[hash] = m_lru.begin();
+
+    while (m_stats.memoryBytes > m_budget) {
+        const Entry &last = m_lru.back();
+        m_stats.memoryBytes -= last.tile->size();
+        m_index.erase(last.hash);
+        m_lru.pop_back();
+        ++m_stats.evictions;
+    }
+}
+
+std::string TileCache::pathOf(uint64_t hash) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016" PRIx64 ".vttile", hash);
+    return m_directory + "/" + name;
+}
+
+TileCache::Tile TileCache::readFile(uint64_t hash) const {
+    if (m_directory.empty())
+        return Tile();
+
+    std::FILE *f = std::fopen(pathOf(hash).c_str(), "rb");
+    if (!f)
+        return Tile();
+
+    std::shared_ptr<std::string> tile = std::make_shared<std::string>();
+    char buf[65536];
+    for (size_t n; (n = std::fread(buf, 1, sizeof(buf), f)) > 0;)
+        tile->append(buf, n);
+    const bool ok = !std::ferror(f);
+    std::fclose(f);
+
+    // a file of another byte order or a corrupted one is a miss
+    TileFile check;
+    if (!ok || !check.view(tile->data(), tile->size()))
+        return Tile();
+    return tile;
+}
+
+void TileCache::writeFile(uint64_t hash, const std::string &tile) const {
+    if (m_directory.empty())
+        return;
+
+    const std::string path = pathOf(hash);
+    const std::string temp = path + "." + std::to_string(getpid()) + "." + std::to_string(g_pending++) + ".tmp";
+
+    std::FILE *f = std::fopen(temp.c_str(), "wb");
+    if (!f)
+        return;
+    const bool written = std::fwrite(tile.data(), 1, tile.size(), f) == tile.size();
+    if (std::fclose(f) == 0 && written && std::rename(temp.c_str(), path.c_str()) == 0)
+        return;
+    std::remove(temp.c_str());
+}
+
+bool decodeTile(const std::string &tile, std::vector<CellVertex> &sites, CellStore &cells, std::string *error) {
+    TileFile file;
+    if (!file.view(tile.data(), tile.size(), error))
+        return false;
+
+    sites.assign(file.sites(), file.sites() + file.siteCount());
+
+    cells.clear();
+    cells.reserve(file.cellCount(), size_t(file.header().vertexCount));
+    for (size_t i = 0; i < file.cellCount(); ++i)
+        cells.append(file.cell(i));
+    return true;
+}
+
+bool decodeTile(const std::string &tile, Grid &sites, CellStore &cells, std::string *error) {
+    std::vector<CellVertex> coordinates;
+    if (!decodeTile(tile, coordinates, cells, error))
+        return false;
+
+    // quantized coordinates are exact in tile coordinates, this gives them back
+    const TileFileHeader &h = *reinterpret_cast<const TileFileHeader *>(tile.data());
+    const GridQuantizer quant(h.width, h.height);
+    sites.clear();
+    sites.reserve(coordinates.size());
+    for (const CellVertex &v : coordinates)
+        sites.emplace_back(quant.toInt(v.x()), quant.toInt(v.y()));
+    return true;
+}
+
+bool decodeRegions(const std::string &tile, Regions &regions, std::string *error) {
+    TileFile file;
+    if (!file.view(tile.data(), tile.size(), error))
+        return false;
+
+    regions.clear();
+    if (!file.regionCount())
+        return true;
+
+    regions.labels.resize(file.cellCount());
+    for (size_t i = 0; i < file.cellCount(); ++i)
+        regions.labels[i] = file.regionOf(i);
+    regions.ringOffsets.resize(file.regionCount() + 1);
+    for (size_t r = 0; r < file.regionCount(); ++r)
+        regions.ringOffsets[r] = uint32_t(file.ringsBegin(r));
+    regions.ringOffsets.back() = uint32_t(file.outlineCount());
+    regions.outlines.reserve(file.outlineCount(), size_t(file.header().outlineVertexCount));
+    for (size_t j = 0; j < file.outlineCount(); ++j)
+        regions.outlines.append(file.outline(j));
+    return true;
+}
+
+} // namespace vt
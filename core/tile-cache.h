@@ -0,0 +1,122 @@
+#ifndef TILE_CACHE_H
+#define TILE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cell-store.h"
+#include "regions.h"
+#include "tiling.h"
+
+namespace vt {
+
+/**
+ * Every parameter the sites and cells of a tile depend on. A tile is fully
+ * determined by them and by the generator version, which the hash includes.
+ */
+struct TileKey {
+    int w, h;
+    int num;
+    uint32_t seed;
+    int newPointsCount;   ///< PoissonGenerator::sSettings::NewPointsCount
+    int iterations;       ///< Lloyd iterations, 0 for none
+    bool adjacency;       ///< whether the tile stores its adjacency
+    unsigned wrap;        ///< vt::Wrap of the tile
+    int regions;          ///< k of clusterCells(), 0 for no region LOD
+};
+
+/// key with the sampler defaults, as generateGrid() uses them
+TileKey tileKey(int w, int h, int num, uint32_t seed, int iterations = 0, bool adjacency = false,
+                Wrap wrap = WRAP_NONE, int regions = 0);
+
+/**
+ * Revision of the generation pipeline, part of every key: bump it when the
+ * same parameters start giving other sites or cells, it retires the stale
+ * entries of the disk caches.
+ */
+const uint32_t TILE_CACHE_REVISION = 1;
+
+/// 64-bit hash of the key, PoissonGenerator::Version and the revisions
+uint64_t hashKey(const TileKey &key);
+
+struct TileCacheStats {
+    uint64_t memoryHits;
+    uint64_t diskHits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;   ///< from memory, the disk is never trimmed
+    size_t memoryBytes;   ///< held right now
+};
+
+/**
+ * Generated tiles in the binary tile format, by key.
+ *
+ * The most recently used tiles stay in memory up to a byte budget, the
+ * least recently used are dropped first. With a directory, every inserted
+ * tile is also written there as <hash>.vttile and tiles missing from memory
+ * are looked up there, so that the cache outlives the process and is shared
+ * by every process using the same directory. Entries written by other
+ * generator versions or revisions are never found, their hashes differ.
+ *
+ * Thread safe. Files are written aside and renamed into place, readers
+ * never see partial ones; unreadable or invalid files count as misses.
+ */
+class TileCache {
+public:
+    typedef std::shared_ptr<const std::string> Tile;
+
+    explicit TileCache(size_t memoryBudget = DEFAULT_MEMORY_BUDGET, const std::string &directory = std::string());
+
+    TileCache(const TileCache &) = delete;
+    TileCache &operator=(const TileCache &) = delete;
+
+    /// bytes of the tile of key, null if neither memory nor disk have it
+    Tile find(const TileKey &key);
+    /// keeps the bytes of the tile of key, see encodeTile()
+    void insert(const TileKey &key, Tile tile);
+
+    TileCacheStats stats() const;
+    const std::string &directory() const { return m_directory; }
+
+    static const size_t DEFAULT_MEMORY_BUDGET = size_t(256) << 20;
+
+private:
+    struct Entry {
+        uint64_t hash;
+        Tile tile;
+    };
+
+    std::string pathOf(uint64_t hash) const;
+    Tile readFile(uint64_t hash) const;
+    void writeFile(uint64_t hash, const std::string &tile) const;
+    // under m_mutex
+    void keep(uint64_t hash, Tile tile);
+
+    const size_t m_budget;
+    const std::string m_directory;
+
+    mutable std::mutex m_mutex;
+    std::list<Entry> m_lru;   // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+    TileCacheStats m_stats;
+};
+
+/// sites and cells of the tile bytes, false if they are not a valid tile
+bool decodeTile(const std::string &tile, std::vector<CellVertex> &sites, CellStore &cells,
+                std::string *error = nullptr);
+
+/// the same, sites quantized back as generateGrid() gives them
+bool decodeTile(const std::string &tile, Grid &sites, CellStore &cells, std::string *error = nullptr);
+
+/// region LOD of the tile bytes, empty if the tile has none
+bool decodeRegions(const std::string &tile, Regions &regions, std::string *error = nullptr);
+
+} // namespace vt
+
+#endif // TILE_CACHE_H
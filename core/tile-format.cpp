@@ -0,0 +1,328 @@
+#include "tile-format.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "poisson-grid.h"
+
+namespace vt {
+
+static_assert(sizeof(CellVertex) == 2 * sizeof(double), "cell vertices are mapped as pairs of doubles");
+static_assert(sizeof(TileFileHeader) % 8 == 0, "sections must stay 8 byte aligned");
+
+namespace {
+
+const char MAGIC[8] = {'V', 'T', 'T', 'I', 'L', 'E', 0, 0};
+
+// the fields of version 1, before the region LOD ones
+const size_t V1_HEADER_SIZE = offsetof(TileFileHeader, regionCount);
+
+uint64_t align8(uint64_t v) {
+    return (v + 7) & ~uint64_t(7);
+}
+
+bool fail(std::string *error, const std::string &message) {
+    if (error)
+        *error = message;
+    return false;
+}
+
+// whether count elements of the given size at offset lie within the file
+bool fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t file) {
+    return offset % 8 == 0 && offset <= file && count <= (file - offset) / size;
+}
+
+// header of a tile with these contents, sections laid out in file order
+bool layout(double width, double height, const std::vector<CellVertex> &sites, const CellStore &cells,
+            const Adjacency *adjacency, const Regions *regions, uint32_t flags, TileFileHeader &h,
+            std::string *error) {
+    if (sites.size() != cells.size())
+        return fail(error, "sites and cells differ in number");
+    if (adjacency && adjacency->size() != cells.size())
+        return fail(error, "adjacency and cells differ in number");
+    if (regions && !regions->empty() && regions->labels.size() != cells.size())
+        return fail(error, "region labels and cells differ in number");
+
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = TILE_FILE_VERSION;
+    h.byteOrder = TILE_FILE_BYTE_ORDER;
+    h.headerSize = sizeof(TileFileHeader);
+    h.flags = flags;
+    h.width = width;
+    h.height = height;
+    h.siteCount = sites.size();
+    h.cellCount = cells.size();
+    h.vertexCount = cells.vertices().size();
+    h.adjacencyCount = adjacency ? adjacency->neighbours().size() : 0;
+    if (regions && !regions->empty()) {
+        h.regionCount = regions->size();
+        h.outlineCount = regions->outlines.size();
+        h.outlineVertexCount = regions->outlines.vertices().size();
+    }
+    std::strncpy(h.generator, PoissonGenerator::Version, sizeof(h.generator) - 1);
+
+    const uint64_t offsets = (h.cellCount + 1) * sizeof(uint32_t);
+    uint64_t at = sizeof(h);
+    h.sitesOffset = at;
+    at = align8(at + h.siteCount * sizeof(CellVertex));
+    h.cellOffsetsOffset = at;
+    at = align8(at + offsets);
+    h.verticesOffset = at;
+    at = align8(at + h.vertexCount * sizeof(CellVertex));
+    if (h.adjacencyCount) {
+        h.adjacencyOffsetsOffset = at;
+        at = align8(at + offsets);
+        h.neighboursOffset = at;
+        at = align8(at + h.adjacencyCount * sizeof(uint32_t));
+    }
+    if (h.regionCount) {
+        h.labelsOffset = at;
+        at = align8(at + h.cellCount * sizeof(uint32_t));
+        h.regionOffsetsOffset = at;
+        at = align8(at + (h.regionCount + 1) * sizeof(uint32_t));
+        h.outlineOffsetsOffset = at;
+        at = align8(at + (h.outlineCount + 1) * sizeof(uint32_t));
+        h.outlineVerticesOffset = at;
+        at = align8(at + h.outlineVertexCount * sizeof(CellVertex));
+    }
+    h.fileSize = at;
+    return true;
+}
+
+// the header then the sections, in one pass through put(data, bytes)
+template <typename Put>
+void writeSections(const TileFileHeader &h, const std::vector<CellVertex> &sites, const CellStore &cells,
+                   const Adjacency *adjacency, const Regions *regions, Put put) {
+    const uint64_t offsets = (h.cellCount + 1) * sizeof(uint32_t);
+    uint64_t written = 0;
+    auto write = [&](const void *data, uint64_t bytes) {
+        put(data, bytes);
+        written += bytes;
+    };
+    auto padTo = [&](uint64_t offset) {
+        static const char zeros[8] = {};
+        write(zeros, offset - written);
+    };
+
+    write(&h, sizeof(h));
+    padTo(h.sitesOffset);
+    write(sites.data(), h.siteCount * sizeof(CellVertex));
+    padTo(h.cellOffsetsOffset);
+    write(cells.offsets().data(), offsets);
+    padTo(h.verticesOffset);
+    write(cells.vertices().data(), h.vertexCount * sizeof(CellVertex));
+    if (h.adjacencyCount) {
+        padTo(h.adjacencyOffsetsOffset);
+        write(adjacency->offsets().data(), offsets);
+        padTo(h.neighboursOffset);
+        write(adjacency->neighbours().data(), h.adjacencyCount * sizeof(uint32_t));
+    }
+    if (h.regionCount) {
+        padTo(h.labelsOffset);
+        write(regions->labels.data(), h.cellCount * sizeof(uint32_t));
+        padTo(h.regionOffsetsOffset);
+        write(regions->ringOffsets.data(), (h.regionCount + 1) * sizeof(uint32_t));
+        padTo(h.outlineOffsetsOffset);
+        write(regions->outlines.offsets().data(), (h.outlineCount + 1) * sizeof(uint32_t));
+        padTo(h.outlineVerticesOffset);
+        write(regions->outlines.vertices().data(), h.outlineVertexCount * sizeof(CellVertex));
+    }
+    padTo(h.fileSize);
+}
+
+} // namespace
+
+bool writeTileFile(const std::string &path, double width, double height,
+                   const std::vector<CellVertex> &sites, const CellStore &cells,
+                   const Adjacency *adjacency, const Regions *regions, uint32_t flags, std::string *error) {
+    TileFileHeader h;
+    if (!layout(width, height, sites, cells, adjacency, regions, flags, h, error))
+        return false;
+
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return fail(error, "cannot create " + path + ": " + std::strerror(errno));
+
+    bool ok = true;
+    writeSections(h, sites, cells, adjacency, regions, [&](const void *data, uint64_t bytes) {
+        ok = ok && std::fwrite(data, 1, size_t(bytes), f) == bytes;
+    });
+
+    ok = std::fclose(f) == 0 && ok;
+    return ok || fail(error, "cannot write " + path);
+}
+
+bool encodeTile(double width, double height, const std::vector<CellVertex> &sites, const CellStore &cells,
+                const Adjacency *adjacency, const Regions *regions, std::string &out, uint32_t flags,
+                std::string *error) {
+    TileFileHeader h;
+    if (!layout(width, height, sites, cells, adjacency, regions, flags, h, error))
+        return false;
+
+    out.clear();
+    out.reserve(size_t(h.fileSize));
+    writeSections(h, sites, cells, adjacency, regions, [&](const void *data, uint64_t bytes) {
+        out.append(static_cast<const char *>(data), size_t(bytes));
+    });
+    return true;
+}
+
+TileFile::TileFile()
+    : m_data(nullptr)
+    , m_size(0)
+    , m_mapped(false)
+    , m_header(nullptr)
+    , m_sites(nullptr)
+    , m_cellOffsets(nullptr)
+    , m_vertices(nullptr)
+    , m_adjacencyOffsets(nullptr)
+    , m_neighbours(nullptr)
+    , m_labels(nullptr)
+    , m_regionOffsets(nullptr)
+    , m_outlineOffsets(nullptr)
+    , m_outlineVertices(nullptr)
+{
+}
+
+TileFile::~TileFile() {
+    close();
+}
+
+void TileFile::close() {
+    if (m_mapped)
+        munmap(const_cast<unsigned char *>(m_data), m_size);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_header = nullptr;
+    m_sites = nullptr;
+    m_cellOffsets = nullptr;
+    m_vertices = nullptr;
+    m_adjacencyOffsets = nullptr;
+    m_neighbours = nullptr;
+    m_labels = nullptr;
+    m_regionOffsets = nullptr;
+    m_outlineOffsets = nullptr;
+    m_outlineVertices = nullptr;
+}
+
+bool TileFile::open(const std::string &path, std::string *error) {
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return fail(error, "cannot open " + path + ": " + std::strerror(errno));
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < off_t(V1_HEADER_SIZE)) {
+        ::close(fd);
+        return fail(error, path + " is not a tile file");
+    }
+
+    void *map = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return fail(error, "cannot map " + path + ": " + std::strerror(errno));
+
+    std::string problem;
+    if (!view(map, size_t(st.st_size), &problem)) {
+        munmap(map, size_t(st.st_size));
+        return fail(error, path + ": " + problem);
+    }
+
+    m_mapped = true;
+    return true;
+}
+
+bool TileFile::view(const void *data, size_t size, std::string *error) {
+    close();
+
+    // the sections are used in place, they must stay aligned
+    if (size < V1_HEADER_SIZE || reinterpret_cast<uintptr_t>(data) % 8 != 0)
+        return fail(error, "not a tile file");
+
+    m_data = static_cast<const unsigned char *>(data);
+    m_size = size;
+
+    const TileFileHeader *mapped = reinterpret_cast<const TileFileHeader *>(m_data);
+    const uint64_t file = m_size;
+    std::string problem;
+
+    // version 1 headers are shorter, the fields they lack read as zeros
+    if (std::memcmp(mapped->magic, MAGIC, sizeof(MAGIC)) == 0 && mapped->byteOrder == TILE_FILE_BYTE_ORDER &&
+        mapped->version == 1 && mapped->headerSize >= V1_HEADER_SIZE) {
+        std::memset(&m_v1, 0, sizeof(m_v1));
+        std::memcpy(&m_v1, mapped, V1_HEADER_SIZE);
+        mapped = &m_v1;
+    }
+    const TileFileHeader &h = *mapped;
+    const size_t header_size = h.version == 1 ? V1_HEADER_SIZE : sizeof(TileFileHeader);
+
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0)
+        problem = "not a tile file";
+    else if (h.byteOrder != TILE_FILE_BYTE_ORDER)
+        problem = "written with another byte order";
+    else if (h.version < 1 || h.version > TILE_FILE_VERSION || h.headerSize < header_size || m_size < header_size)
+        problem = "unsupported version " + std::to_string(h.version);
+    else if (h.fileSize > file)
+        problem = "truncated";
+    else if (h.siteCount != h.cellCount || h.cellCount >= UINT32_MAX ||
+             !fits(h.sitesOffset, h.siteCount, sizeof(CellVertex), file) ||
+             !fits(h.cellOffsetsOffset, h.cellCount + 1, sizeof(uint32_t), file) ||
+             !fits(h.verticesOffset, h.vertexCount, sizeof(CellVertex), file) ||
+             (h.adjacencyCount && (!fits(h.adjacencyOffsetsOffset, h.cellCount + 1, sizeof(uint32_t), file) ||
+                                   !fits(h.neighboursOffset, h.adjacencyCount, sizeof(uint32_t), file))) ||
+             (h.regionCount && (h.regionCount >= UINT32_MAX || h.outlineCount >= UINT32_MAX ||
+                                !fits(h.labelsOffset, h.cellCount, sizeof(uint32_t), file) ||
+                                !fits(h.regionOffsetsOffset, h.regionCount + 1, sizeof(uint32_t), file) ||
+                                !fits(h.outlineOffsetsOffset, h.outlineCount + 1, sizeof(uint32_t), file) ||
+                                !fits(h.outlineVerticesOffset, h.outlineVertexCount, sizeof(CellVertex), file))))
+        problem = "sections out of bounds";
+
+    if (problem.empty()) {
+        m_header = &h;
+        m_sites = reinterpret_cast<const CellVertex *>(m_data + h.sitesOffset);
+        m_cellOffsets = reinterpret_cast<const uint32_t *>(m_data + h.cellOffsetsOffset);
+        m_vertices = reinterpret_cast<const CellVertex *>(m_data + h.verticesOffset);
+
+        if (m_cellOffsets[0] != 0 || m_cellOffsets[h.cellCount] != h.vertexCount)
+            problem = "inconsistent cell offsets";
+
+        if (h.adjacencyCount) {
+            m_adjacencyOffsets = reinterpret_cast<const uint32_t *>(m_data + h.adjacencyOffsetsOffset);
+            m_neighbours = reinterpret_cast<const uint32_t *>(m_data + h.neighboursOffset);
+
+            if (m_adjacencyOffsets[0] != 0 || m_adjacencyOffsets[h.cellCount] != h.adjacencyCount)
+                problem = "inconsistent adjacency offsets";
+        }
+
+        if (h.regionCount) {
+            m_labels = reinterpret_cast<const uint32_t *>(m_data + h.labelsOffset);
+            m_regionOffsets = reinterpret_cast<const uint32_t *>(m_data + h.regionOffsetsOffset);
+            m_outlineOffsets = reinterpret_cast<const uint32_t *>(m_data + h.outlineOffsetsOffset);
+            m_outlineVertices = reinterpret_cast<const CellVertex *>(m_data + h.outlineVerticesOffset);
+
+            if (m_regionOffsets[0] != 0 || m_regionOffsets[h.regionCount] != h.outlineCount ||
+                m_outlineOffsets[0] != 0 || m_outlineOffsets[h.outlineCount] != h.outlineVertexCount)
+                problem = "inconsistent region offsets";
+        }
+    }
+
+    if (!problem.empty()) {
+        close();
+        return fail(error, problem);
+    }
+
+    return true;
+}
+
+} // namespace vt
@@ -0,0 +1,160 @@
+#ifndef TILE_FORMAT_H
+#define TILE_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "adjacency.h"
+#include "cell-store.h"
+#include "regions.h"
+
+namespace vt {
+
+/**
+ * Binary tile file, meant to be memory mapped and used in place.
+ *
+ * Layout, every section starting on an 8 byte boundary:
+ *  - TileFileHeader
+ *  - sites:             siteCount x (double x, double y)
+ *  - cell offsets:      (cellCount + 1) x uint32_t
+ *  - cell vertices:     vertexCount x (double x, double y)
+ *  - adjacency offsets: (cellCount + 1) x uint32_t, if adjacencyCount > 0
+ *  - neighbours:        adjacencyCount x uint32_t
+ *  - region LOD, if regionCount > 0, see vt::Regions:
+ *    - labels:          cellCount x uint32_t, region of each cell
+ *    - region offsets:  (regionCount + 1) x uint32_t, rings of each region
+ *    - outline offsets: (outlineCount + 1) x uint32_t
+ *    - outline vertices: outlineVertexCount x (double x, double y)
+ *
+ * Coordinates are tile coordinates. Cells, adjacency and outlines are the
+ * CSR arrays of CellStore and Adjacency as they are in memory, cell i being
+ * the cell of site i. Everything is stored in the byte order of the writer,
+ * which the byteOrder field lets a reader detect.
+ *
+ * A reader must reject files whose version it does not know. Fields may only
+ * be appended to the header, a new version bumping headerSize: version 1
+ * headers end at regionCount and have no region LOD.
+ */
+struct TileFileHeader {
+    char magic[8];              ///< "VTTILE" followed by two zero bytes
+    uint32_t version;           ///< TILE_FILE_VERSION
+    uint32_t byteOrder;         ///< TILE_FILE_BYTE_ORDER as written
+    uint32_t headerSize;        ///< sizeof(TileFileHeader) of the writer
+    uint32_t flags;             ///< TILE_FLAG_* bits
+    double width, height;
+    uint64_t siteCount;
+    uint64_t cellCount;
+    uint64_t vertexCount;
+    uint64_t adjacencyCount;
+    uint64_t sitesOffset;       ///< byte offsets from the start of the file
+    uint64_t cellOffsetsOffset;
+    uint64_t verticesOffset;
+    uint64_t adjacencyOffsetsOffset;
+    uint64_t neighboursOffset;
+    uint64_t fileSize;
+    char generator[32];         ///< PoissonGenerator::Version, zero padded
+    // version 2
+    uint64_t regionCount;       ///< 0 without region LOD
+    uint64_t outlineCount;      ///< rings of the region outlines
+    uint64_t outlineVertexCount;
+    uint64_t labelsOffset;
+    uint64_t regionOffsetsOffset;
+    uint64_t outlineOffsetsOffset;
+    uint64_t outlineVerticesOffset;
+};
+
+const uint32_t TILE_FILE_VERSION = 2;
+const uint32_t TILE_FILE_BYTE_ORDER = 0x01020304;
+
+/// the tile repeats along x, resp. y: the cells of the border sites run over
+/// that border, see vt::computeVoronoiWrapped()
+const uint32_t TILE_FLAG_WRAP_X = 1;
+const uint32_t TILE_FLAG_WRAP_Y = 2;
+
+/**
+ * Writes a tile file in one pass, sections in file order. sites are in tile
+ * coordinates, adjacency and regions may be null.
+ */
+bool writeTileFile(const std::string &path, double width, double height,
+                   const std::vector<CellVertex> &sites, const CellStore &cells,
+                   const Adjacency *adjacency, const Regions *regions, uint32_t flags = 0,
+                   std::string *error = nullptr);
+
+/// the bytes writeTileFile() writes, into out
+bool encodeTile(double width, double height, const std::vector<CellVertex> &sites, const CellStore &cells,
+                const Adjacency *adjacency, const Regions *regions, std::string &out, uint32_t flags = 0,
+                std::string *error = nullptr);
+
+/**
+ * Read-only memory mapping of a tile file. Opening only checks the header,
+ * the section bounds and the first and last offsets of the CSR arrays, the
+ * arrays are then used where they lie in the mapping.
+ *
+ * view() does the same on tile bytes already in memory, e.g. from
+ * encodeTile(), which must stay alive and 8 byte aligned meanwhile.
+ *
+ * header() of a version 1 file is a copy with the version 2 fields zeroed.
+ */
+class TileFile {
+public:
+    TileFile();
+    ~TileFile();
+
+    TileFile(const TileFile &) = delete;
+    TileFile &operator=(const TileFile &) = delete;
+
+    bool open(const std::string &path, std::string *error = nullptr);
+    bool view(const void *data, size_t size, std::string *error = nullptr);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    const TileFileHeader &header() const { return *m_header; }
+    double width() const { return m_header->width; }
+    double height() const { return m_header->height; }
+
+    size_t siteCount() const { return size_t(m_header->siteCount); }
+    const CellVertex *sites() const { return m_sites; }
+
+    size_t cellCount() const { return size_t(m_header->cellCount); }
+    CellView cell(size_t i) const {
+        return CellView(m_vertices + m_cellOffsets[i], m_vertices + m_cellOffsets[i + 1]);
+    }
+
+    bool hasAdjacency() const { return m_adjacencyOffsets != nullptr; }
+    NeighbourView neighbours(size_t i) const {
+        return NeighbourView(m_neighbours + m_adjacencyOffsets[i], m_neighbours + m_adjacencyOffsets[i + 1]);
+    }
+
+    /// region LOD, regionCount() is 0 without one
+    size_t regionCount() const { return size_t(m_header->regionCount); }
+    uint32_t regionOf(size_t cell) const { return m_labels[cell]; }
+    /// rings [begin, end) of the outline of region r
+    size_t ringsBegin(size_t r) const { return m_regionOffsets[r]; }
+    size_t ringsEnd(size_t r) const { return m_regionOffsets[r + 1]; }
+    size_t outlineCount() const { return size_t(m_header->outlineCount); }
+    CellView outline(size_t ring) const {
+        return CellView(m_outlineVertices + m_outlineOffsets[ring], m_outlineVertices + m_outlineOffsets[ring + 1]);
+    }
+
+private:
+    const unsigned char *m_data;
+    size_t m_size;
+    bool m_mapped;
+    const TileFileHeader *m_header;
+    const CellVertex *m_sites;
+    const uint32_t *m_cellOffsets;
+    const CellVertex *m_vertices;
+    const uint32_t *m_adjacencyOffsets;
+    const uint32_t *m_neighbours;
+    const uint32_t *m_labels;
+    const uint32_t *m_regionOffsets;
+    const uint32_t *m_outlineOffsets;
+    const CellVertex *m_outlineVertices;
+    TileFileHeader m_v1;   // version 1 header, zero extended
+};
+
+} // namespace vt
+
+#endif // TILE_FORMAT_H
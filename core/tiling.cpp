@@ -0,0 +1,676 @@
+#include "tiling.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#include <boost/polygon/voronoi.hpp>
+
+#include "cell-builder.h"
+#include "instrument.h"
+#include "poisson-grid.h"
+
+namespace vt {
+
+namespace {
+
+// cells built between two progress reports of the serial construction
+const size_t PROGRESS_STEP = 4096;
+
+// stream of the seed the jitter draws from, the sampler uses its own
+// generator: with the same mt19937 sequence both would be correlated
+const uint64_t JITTER_STREAM = 1;
+
+// diagram cells one block of the cell pass builds at least, and blocks per
+// thread of the pool, a few for the balance
+const size_t CELL_BLOCK = 2048;
+const size_t BLOCKS_PER_THREAD = 4;
+
+// Second pass of the construction: layout() sizes the store, and the
+// topology if asked for, from the vertex counts of the batches, then every
+// batch copies its cells into their final ranges, concurrently on the pool
+// when given one since the ranges are disjoint.
+template <typename Parts, typename AdjacencyParts>
+void assemble(size_t n, const Parts &parts, const AdjacencyParts &adjacency_parts, ThreadPool *pool,
+              CellStore &cells, Adjacency *adjacency, std::vector<uint32_t> *edges) {
+    VT_SCOPE("voronoi.assemble");
+    std::vector<const CellStore::Unordered *> cell_ptrs;
+    for (const auto &p : parts)
+        cell_ptrs.push_back(&p);
+
+    std::vector<const Adjacency::Unordered *> adjacency_ptrs;
+    if (adjacency) {
+        for (const auto &p : adjacency_parts)
+            adjacency_ptrs.push_back(&p);
+    }
+
+    cells.layout(n, cell_ptrs, edges);
+    if (adjacency)
+        adjacency->layout(n, adjacency_ptrs);
+
+    auto fill = [&](size_t k) {
+        cells.fill(*cell_ptrs[k], edges);
+        if (adjacency)
+            adjacency->fill(*adjacency_ptrs[k]);
+    };
+    if (pool) {
+        pool->parallelFor(0, cell_ptrs.size(), 1, fill);
+    }
+    else {
+        for (size_t k = 0; k < cell_ptrs.size(); ++k)
+            fill(k);
+    }
+}
+
+/// GridQuantizer of integer sites moved by -offset on both axes
+struct ShiftedQuantizer {
+    GridQuantizer quant;
+    double offset;
+
+    double scale() const { return quant.scale(); }
+    double toReal(double v) const { return quant.toReal(v + offset); }
+};
+
+/**
+ * First pass of the construction over a whole diagram: its cells are cut
+ * into blocks of consecutive cells, each block walked, closed and clipped by
+ * its own builder into its own batch, on the pool when given one. Every cell
+ * is independent, the blocks neither share nor lock anything.
+ *
+ * The builders and batches are kept from one run to the next.
+ */
+class CellBlocks {
+public:
+    CellBlocks() : m_w(0), m_h(0), m_topology(false) {}
+
+    template <typename Diagram>
+    void build(const Diagram &vd, const Grid &sites, const std::vector<size_t> &origin, int w, int h,
+               bool topology, ThreadPool *pool, const Progress &progress) {
+        VT_SCOPE("voronoi.cells");
+        const size_t n = vd.num_cells();
+        const size_t wanted = pool ? BLOCKS_PER_THREAD * pool->concurrency() : 1;
+        const size_t count = std::max<size_t>(std::min(wanted, n / CELL_BLOCK), 1);
+
+        if (w != m_w || h != m_h || topology != m_topology) {
+            m_w = w;
+            m_h = h;
+            m_topology = topology;
+            m_builders.clear();
+        }
+        m_builders.resize(count, CellBuilder(ClipRect{0.0, 0.0, double(w), double(h)}, std::max(w, h), topology));
+        m_found.resize(count);
+        m_links.resize(count);
+
+        const GridQuantizer quant(w, h);
+        std::atomic<size_t> built(0);
+        auto block = [&](size_t k) {
+            CellBuilder &builder = m_builders[k];
+            CellStore::Unordered &found = m_found[k];
+            Adjacency::Unordered &links = m_links[k];
+            found.clear();
+            links.clear();
+
+            const size_t first = k * n / count;
+            const size_t last = (k + 1) * n / count;
+            for (size_t i = first; i < last; ++i) {
+                const auto &c = vd.cells()[i];
+                builder.build(c, sites, quant, [&](size_t l) { return origin[l]; });
+                builder.add(origin[c.source_index()], found, links);
+
+                if ((i - first + 1) % PROGRESS_STEP == 0)
+                    report(progress, double(built += PROGRESS_STEP) / n);
+            }
+        };
+
+        if (pool) {
+            pool->parallelFor(0, count, 1, block);
+        }
+        else {
+            for (size_t k = 0; k < count; ++k)
+                block(k);
+        }
+    }
+
+    const std::vector<CellStore::Unordered> &found() const { return m_found; }
+    const std::vector<Adjacency::Unordered> &links() const { return m_links; }
+
+private:
+    int m_w, m_h;
+    bool m_topology;
+    std::vector<CellBuilder> m_builders;
+    std::vector<CellStore::Unordered> m_found;
+    std::vector<Adjacency::Unordered> m_links;
+};
+
+// one sweep over the whole tile, then the two passes over its cells
+CellStore sweepVoronoi(const Grid &g, int w, int h, ThreadPool *pool, Adjacency *adjacency,
+                       std::vector<uint32_t> *edges, const Progress &progress) {
+    Grid sites;
+    std::vector<size_t> origin;
+    uniqueSites(g, sites, origin);
+
+    report(progress, 0.0);
+    boost::polygon::voronoi_diagram<double> vd;
+    {
+        VT_SCOPE("voronoi.sweep");
+        boost::polygon::construct_voronoi(sites.begin(), sites.end(), &vd);
+    }
+
+    CellBlocks blocks;
+    blocks.build(vd, sites, origin, w, h, adjacency || edges, pool, progress);
+    report(progress, 1.0);
+
+    CellStore cells;
+    assemble(g.size(), blocks.found(), blocks.links(), pool, cells, adjacency, edges);
+    return cells;
+}
+
+using Site64 = boost::polygon::point_data<int64_t>;
+
+void constructDiagram(const std::vector<Site> &sites, boost::polygon::voronoi_diagram<double> &vd) {
+    boost::polygon::construct_voronoi(sites.begin(), sites.end(), &vd);
+}
+
+void constructDiagram(const std::vector<Site64> &sites, boost::polygon::voronoi_diagram<double> &vd) {
+    constructVoronoi64(sites.begin(), sites.end(), &vd);
+}
+
+// halo band of computeVoronoiWrapped(), in integer site coordinates; the
+// diagram is built on sites recentred by -centre along both axes
+struct WrapBand {
+    bool wrap_x, wrap_y;
+    int64_t period_x, period_y;
+    int64_t halo_x, halo_y;
+    int64_t centre;
+    bool closed;   ///< every cell taken as is
+
+    /// largest recentred coordinate magnitude of a site or a ghost
+    int64_t reach() const {
+        return std::max(std::max(centre + halo_x, period_x + halo_x - centre),
+                        std::max(centre + halo_y, period_y + halo_y - centre));
+    }
+};
+
+// one diagram of the tile sites and their ghosts in the band, on Point
+// sites; false as soon as a tile cell is not exact, the band is too thin
+template <typename Point>
+bool wrappedPass(const Grid &sites, const std::vector<size_t> &origin, const WrapBand &band,
+                 const GridQuantizer &quant, bool topology, ThreadPool &pool, const Progress &progress,
+                 std::vector<CellStore::Unordered> &found, std::vector<Adjacency::Unordered> &links) {
+    using Coord = typename Point::coordinate_type;
+
+    // the tile sites first, then their ghosts
+    std::vector<Point> local;
+    std::vector<size_t> global;
+    local.reserve(sites.size());
+    global.reserve(sites.size());
+    for (size_t k = 0; k < sites.size(); ++k) {
+        local.emplace_back(Coord(sites[k].x() - band.centre), Coord(sites[k].y() - band.centre));
+        global.push_back(origin[k]);
+    }
+
+    const int64_t kx = band.wrap_x ? (band.halo_x + band.period_x - 1) / band.period_x : 0;
+    const int64_t ky = band.wrap_y ? (band.halo_y + band.period_y - 1) / band.period_y : 0;
+    for (size_t k = 0; k < sites.size(); ++k) {
+        for (int64_t oy = -ky; oy <= ky; ++oy) {
+            const int64_t y = sites[k].y() + oy * band.period_y;
+            if (band.wrap_y && (y < -band.halo_y || y >= band.period_y + band.halo_y))
+                continue;
+            for (int64_t ox = -kx; ox <= kx; ++ox) {
+                const int64_t x = sites[k].x() + ox * band.period_x;
+                if ((ox == 0 && oy == 0) || (band.wrap_x && (x < -band.halo_x || x >= band.period_x + band.halo_x)))
+                    continue;
+                local.emplace_back(Coord(x - band.centre), Coord(y - band.centre));
+                global.push_back(origin[k]);
+            }
+        }
+    }
+
+    report(progress, 0.0);
+    boost::polygon::voronoi_diagram<double> vd;
+    {
+        VT_SCOPE("voronoi.sweep");
+        constructDiagram(local, vd);
+    }
+
+    const double w = quant.toReal(double(band.period_x));
+    const double h = quant.toReal(double(band.period_y));
+    const ShiftedQuantizer local_quant{quant, double(band.centre)};
+    // not clipped along the wrapped axes
+    const ClipRect rect{band.wrap_x ? -w : 0.0, band.wrap_y ? -h : 0.0,
+                        band.wrap_x ? 2.0 * w : w, band.wrap_y ? 2.0 * h : h};
+    const SiteWindow window{quant.toReal(-double(band.halo_x)), quant.toReal(-double(band.halo_y)),
+                            quant.toReal(double(band.period_x + band.halo_x)),
+                            quant.toReal(double(band.period_y + band.halo_y)),
+                            band.wrap_x && !band.closed, band.wrap_y && !band.closed,
+                            band.wrap_x && !band.closed, band.wrap_y && !band.closed};
+
+    const size_t n = vd.num_cells();
+    const size_t count = std::max<size_t>(std::min(BLOCKS_PER_THREAD * pool.concurrency(), n / CELL_BLOCK), 1);
+    found.assign(count, CellStore::Unordered());
+    links.assign(count, Adjacency::Unordered());
+    std::atomic<bool> exact(true);
+    std::atomic<size_t> built(0);
+
+    pool.parallelFor(0, count, 1, [&](size_t k) {
+        CellBuilder builder(rect, 2.0 * std::max(w, h), topology);
+        const size_t first = k * n / count;
+        const size_t last = (k + 1) * n / count;
+        for (size_t i = first; i < last && exact.load(std::memory_order_relaxed); ++i) {
+            const auto &c = vd.cells()[i];
+            const size_t l = c.source_index();
+            if (l >= sites.size())
+                continue;
+
+            builder.build(c, local, local_quant, [&](size_t j) { return global[j]; });
+            if (!isExactCell(builder.ring, quant.toReal(sites[l].x()), quant.toReal(sites[l].y()), window)) {
+                exact = false;
+                return;
+            }
+            builder.add(global[l], found[k], links[k]);
+
+            if ((i - first + 1) % PROGRESS_STEP == 0)
+                report(progress, double(built += PROGRESS_STEP) / n);
+        }
+    });
+    return exact;
+}
+
+void sampleGrid(PoissonGenerator::sContext &context, int w, int h, int num, uint32_t seed, Wrap wrap,
+                const Progress &progress, Grid &g) {
+    PoissonGenerator::sSettings settings;
+    settings.WrapX = (wrap & WRAP_X) != 0;
+    settings.WrapY = (wrap & WRAP_Y) != 0;
+
+    bool cancelled = false;
+    if (progress) {
+        settings.Progress = [&](float done) {
+            cancelled = !progress(done);
+            return !cancelled;
+        };
+    }
+
+    PoissonGenerator::DefaultPRNG PRNG(seed);
+    const auto &points = PoissonGenerator::GeneratePoissonPoints(num, PRNG, settings,
+                                                                 PoissonGenerator::sRectangleDomain(), context);
+    if (cancelled)
+        throw Cancelled();
+
+    jitterSites(points, w, h, seed, g, wrap);
+}
+
+} // namespace
+
+Grid generateGrid(int w, int h, int num, uint32_t seed, const Progress &progress) {
+    return generateWrappedGrid(w, h, num, seed, WRAP_NONE, progress);
+}
+
+Grid generateWrappedGrid(int w, int h, int num, uint32_t seed, Wrap wrap, const Progress &progress) {
+    PoissonGenerator::sContext context;
+    Grid g;
+    sampleGrid(context, w, h, num, seed, wrap, progress, g);
+    return g;
+}
+
+Grid generateGrid(int w, int h, const PoissonGenerator::sDensityMap &density, uint32_t seed,
+                  const Progress &progress) {
+    PoissonGenerator::sSettings settings;
+
+    bool cancelled = false;
+    if (progress) {
+        settings.Progress = [&](float done) {
+            cancelled = !progress(done);
+            return !cancelled;
+        };
+    }
+
+    // the map alone decides how many sites fit: ExpectedPoints() is above
+    // what a sampling holds, twice it never stops early and still gives the
+    // progress a scale
+    PoissonGenerator::DefaultPRNG PRNG(seed);
+    PoissonGenerator::sVariableContext context;
+    const auto &points = PoissonGenerator::GenerateVariablePoissonPoints(
+        density.ExpectedPoints() * 2, PRNG, density, settings, PoissonGenerator::sRectangleDomain(), context);
+    if (cancelled)
+        throw Cancelled();
+
+    Grid g;
+    jitterSites(points, w, h, seed, g);
+    return g;
+}
+
+void jitterSites(const std::vector<PoissonGenerator::sPoint> &points, int w, int h, uint32_t seed, Grid &g,
+                 Wrap wrap) {
+    VT_SCOPE("grid.jitter");
+    PoissonGenerator::PcgPRNG gen(seed, JITTER_STREAM);
+    const GridQuantizer quant(w, h);
+
+    // one exact allocation, none at all when g is reused
+    g.resize(points.size());
+    if (wrap == WRAP_NONE) {
+        for (size_t i = 0; i < points.size(); ++i) {
+            const double dx = 1.5 * (gen.RandomFloat() - 0.5);
+            const double dy = 1.5 * (gen.RandomFloat() - 0.5);
+            const double x = std::min(std::max(double(points[i].x) * w + dx, 0.0), double(w));
+            const double y = std::min(std::max(double(points[i].y) * h + dy, 0.0), double(h));
+            g[i] = Site(quant.toInt(x), quant.toInt(y));
+        }
+        return;
+    }
+
+    // along a wrapped axis w is 0 again: coordinates are taken into [0,w)
+    // once quantized, which computeVoronoiWrapped() relies on
+    auto place = [&](double v, int size, bool wrapped) {
+        if (!wrapped)
+            return quant.toInt(std::min(std::max(v, 0.0), double(size)));
+        const GridQuantizer::IntType period = quant.toInt(size);
+        GridQuantizer::IntType q = quant.toInt(v < 0.0 ? v + size : (v >= size ? v - size : v));
+        return q >= period ? q - period : q;
+    };
+    for (size_t i = 0; i < points.size(); ++i) {
+        const double dx = 1.5 * (gen.RandomFloat() - 0.5);
+        const double dy = 1.5 * (gen.RandomFloat() - 0.5);
+        g[i] = Site(place(double(points[i].x) * w + dx, w, (wrap & WRAP_X) != 0),
+                    place(double(points[i].y) * h + dy, h, (wrap & WRAP_Y) != 0));
+    }
+}
+
+std::vector<CellVertex> siteCoordinates(const Grid &g, int w, int h) {
+    const GridQuantizer quant(w, h);
+    std::vector<CellVertex> sites;
+    sites.reserve(g.size());
+    for (const Site &s : g)
+        sites.emplace_back(quant.toReal(s.x()), quant.toReal(s.y()));
+    return sites;
+}
+
+// Voronoi cells are convex and the tile is a rectangle, so a plain
+// Sutherland-Hodgman pass (clipConvex) replaces QPolygonF::intersected().
+// Coincident sites are merged before the construction, the one with the
+// lowest index gets the cell and the others an empty one.
+CellStore computeVoronoiSerial(const Grid &g, int w, int h, Adjacency *adjacency,
+                               std::vector<uint32_t> *edges, const Progress &progress) {
+    VT_SCOPE("voronoi.serial");
+    return sweepVoronoi(g, w, h, nullptr, adjacency, edges, progress);
+}
+
+CellStore computeVoronoiBlocked(const Grid &g, int w, int h, ThreadPool &pool, Adjacency *adjacency,
+                                std::vector<uint32_t> *edges, const Progress &progress) {
+    VT_SCOPE("voronoi.blocked");
+    return sweepVoronoi(g, w, h, &pool, adjacency, edges, progress);
+}
+
+// Partitioned construction: the tile is cut into vertical strips, and each
+// strip builds the diagram of its sites plus those of a halo band on both
+// sides, keeping the cells of its own sites only.
+// A kept cell is exact when no site left outside of the band can be closer
+// to one of its clipped vertices than its own site (isExactCell). Cells
+// failing the check are rebuilt with a halo twice as wide, until the band
+// covers the whole tile if need be.
+CellStore computeVoronoiPartitioned(const Grid &g, int w, int h, ThreadPool &pool,
+                                    Adjacency *adjacency, std::vector<uint32_t> *edges,
+                                    const Progress &progress) {
+    VT_SCOPE("voronoi.partitioned");
+    const ClipRect rect{0.0, 0.0, double(w), double(h)};
+    const GridQuantizer quant(w, h);
+    const double width = quant.scale() * w;
+    const size_t strips = 2 * pool.concurrency();
+    const double strip_w = width / strips;
+
+    // sites of each strip, in increasing index order
+    std::vector<std::vector<size_t>> members(strips);
+    std::vector<size_t> owner(g.size());
+    for (size_t i = 0; i < g.size(); ++i) {
+        owner[i] = std::min(size_t(std::max(g[i].x(), 0) / strip_w), strips - 1);
+        members[owner[i]].push_back(i);
+    }
+
+    std::vector<CellStore::Unordered> found(strips);
+    std::vector<Adjacency::Unordered> links(strips);
+    std::vector<char> todo(g.size(), 1);
+    std::vector<std::vector<size_t>> unsafe(strips);
+    std::vector<char> busy(strips, 1);
+
+    // start with a band three times the mean distance between sites wide
+    double halo = 3.0 * std::sqrt(double(w) * h / std::max<size_t>(g.size(), 1)) * quant.scale();
+
+    // cells kept so far, for the progress
+    std::atomic<size_t> kept(0);
+
+    for (;;) {
+        pool.parallelFor(0, strips, 1, [&](size_t s) {
+            unsafe[s].clear();
+            if (!busy[s])
+                return;
+
+            VT_SCOPE("voronoi.strip");
+
+            const double x0 = s * strip_w - halo;
+            const double x1 = (s + 1) * strip_w + halo;
+            const SiteWindow window{quant.toReal(x0), 0.0, quant.toReal(x1), double(h),
+                                    x0 > 0.0, false, x1 < width, false};
+
+            const size_t first = size_t(std::max(x0, 0.0) / strip_w);
+            const size_t last = std::min(size_t(std::max(x1, 0.0) / strip_w), strips - 1);
+
+            std::vector<size_t> band;
+            for (size_t t = first; t <= last; ++t) {
+                for (size_t i : members[t]) {
+                    if (g[i].x() >= x0 && g[i].x() < x1)
+                        band.push_back(i);
+                }
+            }
+            std::sort(band.begin(), band.end());
+
+            // coincident sites: the lowest index gets the cell, whatever the strip
+            Grid all, local;
+            std::vector<size_t> origin;
+            all.reserve(band.size());
+            for (size_t i : band)
+                all.push_back(g[i]);
+            uniqueSites(all, local, origin);
+
+            std::vector<size_t> global(origin.size());
+            for (size_t k = 0; k < origin.size(); ++k)
+                global[k] = band[origin[k]];
+
+            boost::polygon::voronoi_diagram<double> vd;
+            boost::polygon::construct_voronoi(local.begin(), local.end(), &vd);
+
+            CellBuilder builder(rect, std::max(w, h), adjacency || edges);
+            const size_t before = found[s].size();
+            for (auto &c : vd.cells()) {
+                const size_t i = global[c.source_index()];
+                if (owner[i] != s || !todo[i])
+                    continue;
+
+                builder.build(c, local, quant, [&](size_t l) { return global[l]; });
+
+                const bool safe = isExactCell(builder.ring, quant.toReal(g[i].x()), quant.toReal(g[i].y()), window);
+                if (safe)
+                    builder.add(i, found[s], links[s]);
+                else
+                    unsafe[s].push_back(i);
+            }
+
+            const size_t added = found[s].size() - before;
+            report(progress, double(kept += added) / std::max<size_t>(g.size(), 1));
+        });
+
+        std::fill(todo.begin(), todo.end(), 0);
+        bool done = true;
+        for (size_t s = 0; s < strips; ++s) {
+            busy[s] = !unsafe[s].empty();
+            done = done && !busy[s];
+            for (size_t i : unsafe[s])
+                todo[i] = 1;
+        }
+
+        if (done)
+            break;
+
+        halo *= 2.0;
+    }
+    report(progress, 1.0);
+
+    CellStore cells;
+    assemble(g.size(), found, links, &pool, cells, adjacency, edges);
+    return cells;
+}
+
+// Wrapped construction: the sites near a wrapped border also enter the
+// diagram shifted by whole periods, as ghosts in a halo band past the
+// opposite border, and only the cells of the tile sites are kept. Like the
+// strips of the partitioned construction, the band starts three times the
+// mean distance between sites wide and doubles while a kept cell fails
+// isExactCell(). Only a tile of a handful of sites needs a band wider than
+// the int32 quantizer range leaves around the tile, it goes to 64-bit sites.
+CellStore computeVoronoiWrapped(const Grid &g, int w, int h, Wrap wrap, ThreadPool &pool,
+                                Adjacency *adjacency, std::vector<uint32_t> *edges, const Progress &progress) {
+    if (wrap == WRAP_NONE)
+        return computeVoronoi(g, w, h, pool, adjacency, edges, progress);
+
+    VT_SCOPE("voronoi.wrapped");
+    const GridQuantizer quant(w, h);
+    WrapBand band;
+    band.wrap_x = (wrap & WRAP_X) != 0;
+    band.wrap_y = (wrap & WRAP_Y) != 0;
+    band.period_x = quant.toInt(w);
+    band.period_y = quant.toInt(h);
+    band.centre = std::max(band.period_x, band.period_y) / 2;
+
+    // a site on a wrapped border is the same as the one on the opposite side
+    Grid wrapped(g);
+    for (Site &s : wrapped) {
+        if (band.wrap_x)
+            s.x(Site::coordinate_type(((s.x() % band.period_x) + band.period_x) % band.period_x));
+        if (band.wrap_y)
+            s.y(Site::coordinate_type(((s.y() % band.period_y) + band.period_y) % band.period_y));
+    }
+    Grid sites;
+    std::vector<size_t> origin;
+    uniqueSites(wrapped, sites, origin);
+
+    const bool topology = adjacency || edges;
+    std::vector<CellStore::Unordered> found;
+    std::vector<Adjacency::Unordered> links;
+
+    double halo = 3.0 * std::sqrt(double(w) * h / std::max<size_t>(g.size(), 1)) * quant.scale();
+    for (;;) {
+        band.halo_x = band.wrap_x ? int64_t(halo) : 0;
+        band.halo_y = band.wrap_y ? int64_t(halo) : 0;
+        // cells are narrower than a period along the wrapped axes and clipped
+        // along the others, their vertex circles are well inside of such a band
+        band.closed = halo > 8.0 * double(std::max(band.period_x, band.period_y));
+
+        const bool exact = band.reach() <= std::numeric_limits<int32_t>::max()
+            ? wrappedPass<Site>(sites, origin, band, quant, topology, pool, progress, found, links)
+            : wrappedPass<Site64>(sites, origin, band, quant, topology, pool, progress, found, links);
+        if (exact)
+            break;
+        halo *= 2.0;
+    }
+    report(progress, 1.0);
+
+    CellStore cells;
+    assemble(g.size(), found, links, &pool, cells, adjacency, edges);
+    return cells;
+}
+
+ThreadPool &defaultPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+CellStore computeVoronoi(const Grid &g, int w, int h, ThreadPool &pool, Adjacency *adjacency,
+                         std::vector<uint32_t> *edges, const Progress &progress) {
+    if (pool.concurrency() > 1 && g.size() >= PARTITION_THRESHOLD)
+        return computeVoronoiPartitioned(g, w, h, pool, adjacency, edges, progress);
+    return computeVoronoiBlocked(g, w, h, pool, adjacency, edges, progress);
+}
+
+CellStore computeVoronoi(const Grid &g, int w, int h) {
+    return computeVoronoi(g, w, h, defaultPool());
+}
+
+struct TilingContext::Buffers {
+    PoissonGenerator::sContext poisson;
+    Grid sites;
+
+    Grid unique;
+    std::vector<size_t> origin;
+    boost::polygon::voronoi_builder<int> sweep;
+    boost::polygon::voronoi_diagram<double> vd;
+    CellBlocks blocks;
+    CellStore cells;
+};
+
+TilingContext::TilingContext(ThreadPool &pool)
+    : m_pool(pool)
+    , m_buffers(new Buffers)
+{
+}
+
+TilingContext::~TilingContext() = default;
+
+void TilingContext::reserve(size_t sites) {
+    Buffers &b = *m_buffers;
+    b.poisson.Reserve(sites);
+    b.sites.reserve(sites);
+    b.unique.reserve(sites);
+    b.origin.reserve(sites);
+}
+
+void TilingContext::reset() {
+    Buffers &b = *m_buffers;
+    b.poisson.Reset();
+    b.sites.clear();
+    b.vd.clear();
+    b.cells.clear();
+}
+
+const Grid &TilingContext::generateGrid(int w, int h, int num, uint32_t seed, const Progress &progress) {
+    sampleGrid(m_buffers->poisson, w, h, num, seed, WRAP_NONE, progress, m_buffers->sites);
+    return m_buffers->sites;
+}
+
+// computeVoronoiBlocked() on the kept buffers, the sites going through the
+// sweep in its own order
+const CellStore &TilingContext::computeVoronoi(const Grid &g, int w, int h, const Progress &progress) {
+    VT_SCOPE("voronoi.context");
+    Buffers &b = *m_buffers;
+    if (m_pool.concurrency() > 1 && g.size() >= PARTITION_THRESHOLD) {
+        b.cells = computeVoronoiPartitioned(g, w, h, m_pool, nullptr, nullptr, progress);
+        return b.cells;
+    }
+
+    // the builder and the diagram are cleared rather than rebuilt, which
+    // keeps the capacity of their site and output vectors
+    sweepUniqueSites(g, b.unique, b.origin);
+    report(progress, 0.0);
+    {
+        VT_SCOPE("voronoi.sweep");
+        b.sweep.clear();
+        for (const Site &s : b.unique)
+            b.sweep.insert_point(s.x(), s.y());
+        b.vd.clear();
+        b.sweep.construct(&b.vd);
+    }
+
+    b.blocks.build(b.vd, b.unique, b.origin, w, h, false, &m_pool, progress);
+    report(progress, 1.0);
+
+    assemble(g.size(), b.blocks.found(), b.blocks.links(), &m_pool, b.cells, nullptr, nullptr);
+    return b.cells;
+}
+
+const Grid &TilingContext::sites() const {
+    return m_buffers->sites;
+}
+
+const CellStore &TilingContext::cells() const {
+    return m_buffers->cells;
+}
+
+} // namespace vt
@@ -0,0 +1,175 @@
+#ifndef TILING_H
+#define TILING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <boost/polygon/point_data.hpp>
+
+#include "adjacency.h"
+#include "cell-store.h"
+#include "progress.h"
+#include "quantizer.h"
+#include "thread-pool.h"
+
+namespace PoissonGenerator {
+struct sPoint;
+struct sDensityMap;
+}
+
+namespace vt {
+
+// Boost polygon sucks with floating points, sites are converted to integer
+// coordinates with the finest scale the tile extents allow, see quantizer.h.
+using GridQuantizer = Quantizer32;
+using Site = boost::polygon::point_data<int>;
+using Grid = std::vector<Site>;
+
+/**
+ * Axes along which a tile repeats, for maps that wrap around seamlessly:
+ * the sites are spaced across the border and the cells run over it.
+ */
+enum Wrap : unsigned {
+    WRAP_NONE = 0,
+    WRAP_X = 1,
+    WRAP_Y = 2,
+    WRAP_XY = WRAP_X | WRAP_Y
+};
+
+/**
+ * Jittered Poisson sites of a w x h tile about num sites large, quantized
+ * with GridQuantizer(w, h). The same seed always gives the same sites.
+ * Throws Cancelled if progress asks to stop.
+ */
+Grid generateGrid(int w, int h, int num, uint32_t seed, const Progress &progress = Progress());
+
+/**
+ * Same as generateGrid() on a tile repeating along the wrapped axes, the
+ * sampling being periodic along them: sites lie in [0,w) and [0,h) there,
+ * spaced from the sites across the border too. WRAP_NONE gives the sites of
+ * generateGrid().
+ */
+Grid generateWrappedGrid(int w, int h, int num, uint32_t seed, Wrap wrap, const Progress &progress = Progress());
+
+/**
+ * Jittered sites of a w x h tile spaced as the density map says, dense where
+ * it is high and sparse where it is low, see PoissonGenerator::sDensityMap.
+ * The distances of the map are relative to the unit square.
+ */
+Grid generateGrid(int w, int h, const PoissonGenerator::sDensityMap &density, uint32_t seed,
+                  const Progress &progress = Progress());
+
+/// second half of generateGrid(): spreads samples of the unit square over
+/// the tile, jitters them with a stream of seed independent of the sampler's
+/// and quantizes them, straight into g resized to their count. Sites jittered
+/// across a wrapped border come back on the other side.
+void jitterSites(const std::vector<PoissonGenerator::sPoint> &points, int w, int h, uint32_t seed, Grid &g,
+                 Wrap wrap = WRAP_NONE);
+
+/// tile coordinates of the sites of g
+std::vector<CellVertex> siteCoordinates(const Grid &g, int w, int h);
+
+/**
+ * Clipped Voronoi cells of g over the w x h tile, cell i is the one of g[i].
+ *
+ * The topology comes out of the same pass over the diagram when asked for:
+ *  - adjacency: the neighbours of each cell, those sharing an edge of non
+ *    zero length with it inside of the tile, in ring order;
+ *  - edges: a half-edge index parallel to CellStore::vertices(), holding
+ *    for each vertex the cell across the edge going to the next vertex of
+ *    the ring, or NO_CELL along the tile border.
+ */
+CellStore computeVoronoiSerial(const Grid &g, int w, int h, Adjacency *adjacency = nullptr,
+                               std::vector<uint32_t> *edges = nullptr, const Progress &progress = Progress());
+
+/**
+ * Same cells as computeVoronoiSerial(), from the same single sweep over the
+ * tile: its cells are then walked and clipped in blocks on the pool, and
+ * copied into the store in a second pass once its layout is known.
+ */
+CellStore computeVoronoiBlocked(const Grid &g, int w, int h, ThreadPool &pool,
+                                Adjacency *adjacency = nullptr, std::vector<uint32_t> *edges = nullptr,
+                                const Progress &progress = Progress());
+
+/// same cells as computeVoronoiSerial(), built in strips on the pool
+CellStore computeVoronoiPartitioned(const Grid &g, int w, int h, ThreadPool &pool,
+                                    Adjacency *adjacency = nullptr, std::vector<uint32_t> *edges = nullptr,
+                                    const Progress &progress = Progress());
+
+/// below this many sites the partitioning overhead is not worth it
+const size_t PARTITION_THRESHOLD = 50000;
+
+/**
+ * Partitions large tiles when the pool has more than one thread, smaller
+ * ones go through computeVoronoiBlocked(). progress follows the cells built,
+ * the construction of the diagram itself cannot be interrupted: the single
+ * sweep paths only report before and after it.
+ */
+CellStore computeVoronoi(const Grid &g, int w, int h, ThreadPool &pool,
+                         Adjacency *adjacency = nullptr, std::vector<uint32_t> *edges = nullptr,
+                         const Progress &progress = Progress());
+CellStore computeVoronoi(const Grid &g, int w, int h);
+
+/**
+ * Voronoi cells of the sites of a w x h tile repeating along the wrapped
+ * axes, as in the tiling of the plane by its copies. Only the sites within
+ * a thin band along the wrapped borders are copied across them, as ghosts.
+ *
+ * Cells are clipped to the tile along the other axes only: along a wrapped
+ * one the cells of the border sites run past the tile, by about the size of
+ * a cell, and are meant to be drawn modulo the tile size. Their areas
+ * still add up to w x h. Neighbours and edges across a wrapped border are
+ * the cells of the sites on the other side.
+ */
+CellStore computeVoronoiWrapped(const Grid &g, int w, int h, Wrap wrap, ThreadPool &pool,
+                                Adjacency *adjacency = nullptr, std::vector<uint32_t> *edges = nullptr,
+                                const Progress &progress = Progress());
+
+/// process wide pool using every core, created on first use
+ThreadPool &defaultPool();
+
+/**
+ * Buffers of generateGrid() and computeVoronoi() kept from one run to the
+ * next, for callers generating many tiles in a row.
+ *
+ * The sampler state (output, active list, acceleration grid), the sites and
+ * the construction state (merged sites, Voronoi builder and diagram,
+ * unordered cells, store) all live in the context: once a run has sized
+ * them, runs of the same size or smaller only allocate in the beach line and
+ * event queue of Boost's sweep. reserve() sizes them upfront, reset()
+ * forgets the results without freeing anything. Sites are fed to the sweep
+ * already in sweep order, see sweepUniqueSites().
+ *
+ * The results are references into the context, valid until the next run.
+ * Large tiles on a pool of more than one thread go through
+ * computeVoronoiPartitioned(), which allocates its own buffers.
+ */
+class TilingContext {
+public:
+    explicit TilingContext(ThreadPool &pool = defaultPool());
+    ~TilingContext();
+
+    /// sizes the buffers for tiles of about sites sites
+    void reserve(size_t sites);
+    void reset();
+
+    /// same sites as vt::generateGrid()
+    const Grid &generateGrid(int w, int h, int num, uint32_t seed, const Progress &progress = Progress());
+    /// same cells as vt::computeVoronoi(), without the topology
+    const CellStore &computeVoronoi(const Grid &g, int w, int h, const Progress &progress = Progress());
+
+    const Grid &sites() const;
+    const CellStore &cells() const;
+
+private:
+    struct Buffers;
+
+    ThreadPool &m_pool;
+    std::unique_ptr<Buffers> m_buffers;
+};
+
+} // namespace vt
+
+#endif // TILING_H
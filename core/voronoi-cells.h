@@ -0,0 +1,139 @@
+#ifndef VORONOI_CELLS_H
+#define VORONOI_CELLS_H
+
+#include <algorithm>
+#include <cmath>
+
+#include "convex-clip.h"
+#include "instrument.h"
+
+namespace vt {
+
+/**
+ * Builds the ring of a Boost.Polygon Voronoi cell, in tile coordinates.
+ *
+ * sites are the integer sites the diagram was built from and quant the
+ * quantizer that produced them. Infinite edges are extended far enough to
+ * cross a tile of the given extent, so the ring is ready for clipping.
+ *
+ * Ring is any container of points offering clear(), push_back() and whose
+ * value_type has a (x, y) constructor, the result is an open ring.
+ *
+ * labels receives the source index of the cell across the edge starting at
+ * each vertex, in the clipConvex() labelling convention, and outside for the
+ * edge closing the ring far away between two infinite edges.
+ *
+ * A diagram of a single site has no edges, its cell is then a square far
+ * around the site, and the end cells of collinear sites, which only have one
+ * edge, the half-plane past it: both clip to their part of the tile with no
+ * neighbour across the tile border.
+ */
+template <typename Cell, typename Sites, typename Quant, typename Ring, typename Labels>
+void cellRing(const Cell &c, const Sites &sites, const Quant &quant, double extent, Ring &ring,
+              Labels &labels, typename Labels::value_type outside) {
+    using Vertex = typename Ring::value_type;
+    auto vertex = [&](double x, double y) { return Vertex(quant.toReal(x), quant.toReal(y)); };
+
+    ring.clear();
+    labels.clear();
+    auto e = c.incident_edge();
+    if (!e) {
+        const auto &p = sites[c.source_index()];
+        const double x = quant.toReal(p.x()), y = quant.toReal(p.y()), r = 2.0 * extent;
+        ring.push_back(Vertex(x - r, y - r));
+        ring.push_back(Vertex(x + r, y - r));
+        ring.push_back(Vertex(x + r, y + r));
+        ring.push_back(Vertex(x - r, y + r));
+        for (int k = 0; k < 4; ++k)
+            labels.push_back(outside);
+        return;
+    }
+    if (e->next() == e && !e->vertex0() && !e->vertex1()) {
+        // the cell turns the way of the edge, its site on the left of it
+        const auto &p1 = sites[e->cell()->source_index()];
+        const auto &p2 = sites[e->twin()->cell()->source_index()];
+        const double ox = 0.5 * (double(p1.x()) + p2.x());
+        const double oy = 0.5 * (double(p1.y()) + p2.y());
+        const double dx = double(p1.y()) - p2.y();
+        const double dy = double(p2.x()) - p1.x();
+        const double coef = 2.0 * quant.scale() * extent / std::max(std::fabs(dx), std::fabs(dy));
+        ring.push_back(vertex(ox - dx * coef, oy - dy * coef));
+        ring.push_back(vertex(ox + dx * coef, oy + dy * coef));
+        ring.push_back(vertex(ox + (dx - dy) * coef, oy + (dy + dx) * coef));
+        ring.push_back(vertex(ox - (dx + dy) * coef, oy + (dx - dy) * coef));
+        labels.push_back(typename Labels::value_type(e->twin()->cell()->source_index()));
+        for (int k = 0; k < 3; ++k)
+            labels.push_back(outside);
+        return;
+    }
+    do {
+        if (e->is_primary()) {
+            const auto twin = typename Labels::value_type(e->twin()->cell()->source_index());
+            if (e->is_finite()) {
+                ring.push_back(vertex(e->vertex0()->x(), e->vertex0()->y()));
+                labels.push_back(twin);
+            }
+            else {
+                VT_COUNT(instrument::VORONOI_INFINITE_EDGES, 1);
+                const auto &p1 = sites[e->cell()->source_index()];
+                const auto &p2 = sites[e->twin()->cell()->source_index()];
+                double ox = 0.5 * (double(p1.x()) + p2.x());
+                double oy = 0.5 * (double(p1.y()) + p2.y());
+                double dx = double(p1.y()) - p2.y();
+                double dy = double(p2.x()) - p1.x();
+                double coef = quant.scale() * extent / std::max(std::fabs(dx), std::fabs(dy));
+
+                if (e->vertex0())
+                    ring.push_back(vertex(e->vertex0()->x(), e->vertex0()->y()));
+                else
+                    ring.push_back(vertex(ox - dx * coef, oy - dy * coef));
+                labels.push_back(twin);
+
+                // a finite end is the start of the next edge, added with it
+                if (!e->vertex1()) {
+                    ring.push_back(vertex(ox + dx * coef, oy + dy * coef));
+                    labels.push_back(outside);
+                }
+            }
+        }
+        e = e->next();
+    } while (e != c.incident_edge());
+}
+
+template <typename Cell, typename Sites, typename Quant, typename Ring>
+void cellRing(const Cell &c, const Sites &sites, const Quant &quant, double extent, Ring &ring) {
+    detail::NoLabels labels;
+    cellRing(c, sites, quant, extent, ring, labels, 0);
+}
+
+/**
+ * Window of the sites a partial diagram was built from, i.e. every site of
+ * the whole set lying in [x0,x1)x[y0,y1). Sides flagged open have sites
+ * beyond them, the others are the border of the whole domain.
+ */
+struct SiteWindow {
+    double x0, y0, x1, y1;
+    bool openLeft, openTop, openRight, openBottom;
+};
+
+/**
+ * Whether a cell computed from the sites of a window alone is a cell of the
+ * whole diagram too. It is when no site left outside of the window can be
+ * closer to one of the (clipped) vertices than the cell site (sx, sy): the
+ * circle centred on each vertex and passing by the site must stay inside of
+ * the window on every open side.
+ */
+template <typename Ring>
+bool isExactCell(const Ring &ring, double sx, double sy, const SiteWindow &w) {
+    for (const auto &v : ring) {
+        const double r = std::hypot(v.x() - sx, v.y() - sy);
+        if ((w.openLeft && v.x() - r <= w.x0) || (w.openRight && v.x() + r >= w.x1) ||
+            (w.openTop && v.y() - r <= w.y0) || (w.openBottom && v.y() + r >= w.y1))
+            return false;
+    }
+    return true;
+}
+
+} // namespace vt
+
+#endif // VORONOI_CELLS_H
@@ -0,0 +1,212 @@
+#include <QElapsedTimer>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QPushButton>
+#include <QProgressBar>
+#include <QGraphicsView>
+#include <QGraphicsScene>
+#include <QFileDialog>
+#include <QImage>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "dialog.h"
+#include "cell-raster.h"
+#include "tiling-item.h"
+#ifdef VT_OPENGL
+#include "gl-tiling-view.h"
+#include "jump-flood.h"
+#endif
+
+namespace {
+
+// pixels along the longer side of the exported rasters
+const int RASTER_SIZE = 8192;
+
+// largest tile width and height, as the command line takes them
+const int MAX_EXTENT = 1 << 20;
+
+} // namespace
+
+Dialog::Dialog(QWidget *parent)
+    : QDialog(parent)
+{
+    // memory goes with the site count, not the tile extents: tiles may be as
+    // large as on the command line, larger worlds go through its --chunk mode
+    m_w_spin = new QSpinBox(this);
+    m_w_spin->setRange(5, MAX_EXTENT);
+    m_w_spin->setValue(44);
+
+    m_h_spin = new QSpinBox(this);
+    m_h_spin->setRange(5, MAX_EXTENT);
+    m_h_spin->setValue(44);
+
+    m_num_spin = new QSpinBox(this);
+    m_num_spin->setRange(10, 1000000);
+    m_num_spin->setValue(1000);
+
+    m_relax_spin = new QSpinBox(this);
+    m_relax_spin->setRange(0, 100);
+    m_relax_spin->setValue(0);
+
+    // the same seed always gives the same tiling
+    m_seed_spin = new QSpinBox(this);
+    m_seed_spin->setRange(0, INT_MAX);
+    m_seed_spin->setValue(0);
+
+    auto update = new QPushButton(tr("Update"), this);
+    connect(update, SIGNAL(clicked()), SLOT(updateVoronoi()));
+
+    auto raster = new QPushButton(tr("Export raster..."), this);
+    connect(raster, SIGNAL(clicked()), SLOT(exportRaster()));
+
+    // changing the parameters mid-run restarts the run with them
+    for (QSpinBox *spin : {m_w_spin, m_h_spin, m_num_spin, m_relax_spin, m_seed_spin})
+        connect(spin, SIGNAL(valueChanged(int)), SLOT(restartIfRunning()));
+
+    m_progress = new QProgressBar(this);
+    m_progress->setRange(0, 100);
+
+    m_worker = new TilingWorker(this);
+    connect(m_worker, &TilingWorker::progress, this, &Dialog::showProgress);
+    connect(m_worker, &TilingWorker::finished, this, &Dialog::showTiling);
+
+    auto hbox = new QHBoxLayout;
+    hbox->addWidget(update);
+    hbox->addSpacing(10);
+    hbox->addWidget(new QLabel(tr("Width")));
+    hbox->addWidget(m_w_spin);
+    hbox->addSpacing(10);
+    hbox->addWidget(new QLabel(tr("Height")));
+    hbox->addWidget(m_h_spin);
+    hbox->addSpacing(10);
+    hbox->addWidget(new QLabel(tr("Number of points")));
+    hbox->addWidget(m_num_spin);
+    hbox->addSpacing(10);
+    hbox->addWidget(new QLabel(tr("Lloyd iterations")));
+    hbox->addWidget(m_relax_spin);
+    hbox->addSpacing(10);
+    hbox->addWidget(new QLabel(tr("Seed")));
+    hbox->addWidget(m_seed_spin);
+    hbox->addStretch(1);
+    hbox->addWidget(raster);
+    hbox->addWidget(m_progress);
+
+#ifdef VT_OPENGL
+    m_view = new GLTilingView(this);
+#else
+    // a single item, the scene index would only get in the way
+    auto scene = new QGraphicsScene(this);
+    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+    m_item = new TilingItem;
+    scene->addItem(m_item);
+
+    m_view = new QGraphicsView(this);
+    m_view->setScene(scene);
+#endif
+
+    auto vbox = new QVBoxLayout(this);
+    vbox->addLayout(hbox);
+    vbox->addWidget(m_view, 1);
+    resize(1280, 800);
+}
+
+Dialog::~Dialog() {}
+
+
+void Dialog::updateVoronoi() {
+    TilingRequest request;
+    request.w = m_w_spin->value();
+    request.h = m_h_spin->value();
+    request.count = m_num_spin->value();
+    request.iterations = m_relax_spin->value();
+    request.seed = uint32_t(m_seed_spin->value());
+
+    m_progress->setValue(0);
+    m_worker->start(request);
+}
+
+void Dialog::restartIfRunning() {
+    if (m_worker->isRunning())
+        updateVoronoi();
+}
+
+void Dialog::showProgress(int phase, double done) {
+    static const char *const names[] = {"Sampling", "Relaxing", "Cells"};
+    m_progress->setFormat(tr("%1 %p%").arg(tr(names[phase])));
+    m_progress->setValue(int(100.0 * done));
+}
+
+void Dialog::showTiling(std::shared_ptr<TilingResult> result) {
+    const int w = result->request.w;
+    const int h = result->request.h;
+    const vt::TileCacheStats cache = m_worker->cacheStats();
+    qDebug("generation took %lld ms%s, cache: %llu hits, %llu misses", result->elapsed,
+           result->cached ? " (cached)" : "", static_cast<unsigned long long>(cache.memoryHits + cache.diskHits),
+           static_cast<unsigned long long>(cache.misses));
+
+    // compare areas
+    double total_area = 0.0;
+    for (size_t i = 0; i < result->cells.size(); ++i)
+        total_area += vt::area(result->cells[i]);
+
+    qDebug("Tile area: %.0f, sum of polygons area: %lf", double(w) * h, total_area);
+
+    QElapsedTimer t;
+    t.start();
+#ifdef VT_OPENGL
+    m_view->setTiling(w, h, result->cells);
+#else
+    // the cells stay in the result too, for the raster export
+    m_item->setTiling(w, h, vt::siteCoordinates(result->sites, w, h), result->cells);
+    m_view->scene()->setSceneRect(m_item->boundingRect());
+    m_view->fitInView(0, 0, w, h, Qt::KeepAspectRatio);
+#endif
+    qDebug("view update took %lld ms", t.elapsed());
+    m_result = result;
+
+    m_progress->setFormat(tr("Done"));
+    m_progress->setValue(100);
+}
+
+void Dialog::exportRaster() {
+    if (!m_result)
+        return;
+
+    const QString path = QFileDialog::getSaveFileName(this, tr("Export cell raster"), QString(),
+                                                      tr("PNG images (*.png)"));
+    if (path.isEmpty())
+        return;
+
+    const int w = m_result->request.w;
+    const int h = m_result->request.h;
+    const double scale = double(RASTER_SIZE) / std::max(w, h);
+    const int width = std::max(int(w * scale + 0.5), 1);
+    const int height = std::max(int(h * scale + 0.5), 1);
+
+    // jump flooding when the GPU has compute shaders, scanlines over the cells otherwise
+    QElapsedTimer t;
+    t.start();
+    vt::CellRaster raster;
+    bool gpu = false;
+#ifdef VT_OPENGL
+    if (!m_flood)
+        m_flood.reset(new JumpFlood);
+    gpu = m_flood->rasterize(vt::siteCoordinates(m_result->sites, w, h), w, h, width, height, raster);
+#endif
+    if (!gpu)
+        vt::rasterizeCells(m_result->cells, w, h, width, height, raster);
+    qDebug("%dx%d raster took %lld ms (%s)", width, height, t.elapsed(), gpu ? "jump flooding" : "scanlines");
+
+    // pixel values are the cell indices, 0xffffffff where there is none
+    QImage image(width, height, QImage::Format_ARGB32);
+    for (int y = 0; y < height; ++y)
+        std::memcpy(image.scanLine(y), &raster.ids[size_t(y) * size_t(width)], size_t(width) * sizeof(uint32_t));
+    if (!image.save(path, "PNG"))
+        qWarning("cannot write %s", qPrintable(path));
+}
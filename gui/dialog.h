@@ -0,0 +1,52 @@
+#ifndef DIALOG_H
+#define DIALOG_H
+
+#include <QDialog>
+
+#include <memory>
+
+#include "tiling-worker.h"
+
+QT_BEGIN_NAMESPACE
+class QSpinBox;
+class QProgressBar;
+class QGraphicsView;
+QT_END_NAMESPACE
+
+class TilingItem;
+class GLTilingView;
+class JumpFlood;
+
+class Dialog : public QDialog {
+    Q_OBJECT
+
+public:
+    Dialog(QWidget *parent = 0);
+    ~Dialog();
+
+public slots:
+    /// starts a generation in the background, cancelling the current one
+    void updateVoronoi();
+
+private slots:
+    void restartIfRunning();
+    void showProgress(int phase, double done);
+    void showTiling(std::shared_ptr<TilingResult> result);
+    /// saves the cell index raster of the tiling shown as a PNG image
+    void exportRaster();
+
+private:
+    QSpinBox *m_w_spin, *m_h_spin, *m_num_spin, *m_relax_spin, *m_seed_spin;
+    QProgressBar *m_progress;
+    TilingWorker *m_worker;
+    std::shared_ptr<const TilingResult> m_result;   // shown
+#ifdef VT_OPENGL
+    GLTilingView *m_view;
+    std::unique_ptr<JumpFlood> m_flood;   // created on first use
+#else
+    QGraphicsView *m_view;
+    TilingItem *m_item;
+#endif
+};
+
+#endif // DIALOG_H
@@ -0,0 +1,160 @@
+#include "gl-tiling-view.h"
+
+#include <QMatrix4x4>
+#include <QMouseEvent>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <cmath>
+
+#include "tiling-item.h"
+
+namespace {
+
+const char *vertexShader =
+    "attribute vec2 position;\n"
+    "attribute vec4 color;\n"
+    "uniform mat4 matrix;\n"
+    "varying vec4 v_color;\n"
+    "void main() {\n"
+    "    gl_Position = matrix * vec4(position, 0.0, 1.0);\n"
+    "    v_color = color;\n"
+    "}\n";
+
+const char *fragmentShader =
+    "varying vec4 v_color;\n"
+    "void main() {\n"
+    "    gl_FragColor = v_color;\n"
+    "}\n";
+
+// floats per vertex: position and colour
+const int STRIDE = 6;
+
+} // namespace
+
+GLTilingView::GLTilingView(QWidget *parent)
+    : QOpenGLWidget(parent)
+    , m_buffer(QOpenGLBuffer::VertexBuffer)
+    , m_upload(false)
+    , m_count(0)
+    , m_w(1.0)
+    , m_h(1.0)
+    , m_zoom(1.0)
+{
+}
+
+GLTilingView::~GLTilingView() {
+    makeCurrent();
+    m_buffer.destroy();
+    doneCurrent();
+}
+
+void GLTilingView::setTiling(double w, double h, const vt::CellStore &cells) {
+    m_w = w;
+    m_h = h;
+    m_zoom = 1.0;
+    m_center = QPointF(0.5 * w, 0.5 * h);
+
+    m_vertices.clear();
+    for (size_t i = 0; i < cells.size(); ++i) {
+        const vt::CellView cell = cells[i];
+        const QColor col = cellColor(i);
+        const float rgba[4] = {float(col.redF()), float(col.greenF()), float(col.blueF()), 0.5f};
+
+        // cells are convex, a fan around the first vertex covers them
+        for (size_t k = 1; k + 1 < cell.size(); ++k) {
+            const vt::CellVertex *tri[3] = {&cell[0], &cell[k], &cell[k + 1]};
+            for (const vt::CellVertex *v : tri) {
+                m_vertices.push_back(float(v->x()));
+                m_vertices.push_back(float(v->y()));
+                m_vertices.insert(m_vertices.end(), rgba, rgba + 4);
+            }
+        }
+    }
+
+    m_upload = true;
+    update();
+}
+
+void GLTilingView::initializeGL() {
+    initializeOpenGLFunctions();
+
+    m_program.removeAllShaders();
+    m_program.addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader);
+    m_program.addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShader);
+    m_program.bindAttributeLocation("position", 0);
+    m_program.bindAttributeLocation("color", 1);
+    if (!m_program.link())
+        qWarning("GLTilingView: %s", qPrintable(m_program.log()));
+
+    // the context may be recreated, e.g. when the widget is reparented
+    m_buffer.create();
+    m_buffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_upload = true;
+}
+
+void GLTilingView::paintGL() {
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    m_buffer.bind();
+    if (m_upload) {
+        m_buffer.allocate(m_vertices.data(), int(m_vertices.size() * sizeof(float)));
+        m_count = int(m_vertices.size() / STRIDE);
+        m_upload = false;
+    }
+
+    const double s = scale();
+    const double hw = 0.5 * width() * s, hh = 0.5 * height() * s;
+    QMatrix4x4 matrix;
+    matrix.ortho(float(m_center.x() - hw), float(m_center.x() + hw),
+                 float(m_center.y() + hh), float(m_center.y() - hh), -1.0f, 1.0f);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_program.bind();
+    m_program.setUniformValue("matrix", matrix);
+    m_program.enableAttributeArray(0);
+    m_program.enableAttributeArray(1);
+    m_program.setAttributeBuffer(0, GL_FLOAT, 0, 2, STRIDE * sizeof(float));
+    m_program.setAttributeBuffer(1, GL_FLOAT, 2 * sizeof(float), 4, STRIDE * sizeof(float));
+
+    glDrawArrays(GL_TRIANGLES, 0, m_count);
+
+    m_program.disableAttributeArray(0);
+    m_program.disableAttributeArray(1);
+    m_program.release();
+    m_buffer.release();
+}
+
+double GLTilingView::scale() const {
+    // the whole tile fits at zoom 1
+    const double fit = std::max(m_w / std::max(width(), 1), m_h / std::max(height(), 1));
+    return fit / m_zoom;
+}
+
+QPointF GLTilingView::toTile(const QPoint &p) const {
+    const double s = scale();
+    return QPointF(m_center.x() + (p.x() - 0.5 * width()) * s,
+                   m_center.y() + (p.y() - 0.5 * height()) * s);
+}
+
+void GLTilingView::wheelEvent(QWheelEvent *event) {
+    // keep the point under the cursor in place
+    const QPointF before = toTile(event->pos());
+    m_zoom *= std::pow(1.0015, event->angleDelta().y());
+    m_zoom = std::min(std::max(m_zoom, 0.1), 1e5);
+    m_center = m_center + before - toTile(event->pos());
+    update();
+}
+
+void GLTilingView::mousePressEvent(QMouseEvent *event) {
+    m_last = event->pos();
+}
+
+void GLTilingView::mouseMoveEvent(QMouseEvent *event) {
+    m_center = m_center + toTile(m_last) - toTile(event->pos());
+    m_last = event->pos();
+    update();
+}
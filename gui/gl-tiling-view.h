@@ -0,0 +1,54 @@
+#ifndef GL_TILING_VIEW_H
+#define GL_TILING_VIEW_H
+
+#include <QOpenGLWidget>
+#include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLShaderProgram>
+#include <QPoint>
+#include <QPointF>
+
+#include <vector>
+
+#include "cell-store.h"
+
+/**
+ * OpenGL tiling view: the cells are fanned into triangles and uploaded once
+ * into a vertex buffer, each frame then being a single draw call whatever
+ * the zoom. The wheel zooms around the cursor and dragging pans.
+ */
+class GLTilingView : public QOpenGLWidget, protected QOpenGLFunctions {
+    Q_OBJECT
+
+public:
+    explicit GLTilingView(QWidget *parent = nullptr);
+    ~GLTilingView();
+
+    /// triangulates the cells, uploaded on the next frame, and shows the whole tile
+    void setTiling(double w, double h, const vt::CellStore &cells);
+
+protected:
+    void initializeGL() override;
+    void paintGL() override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+    // tile units per pixel
+    double scale() const;
+    QPointF toTile(const QPoint &p) const;
+
+    QOpenGLShaderProgram m_program;
+    QOpenGLBuffer m_buffer;
+    std::vector<float> m_vertices;   // x, y, r, g, b, a, kept for context losses
+    bool m_upload;
+    int m_count;
+
+    double m_w, m_h;
+    double m_zoom;
+    QPointF m_center;
+    QPoint m_last;
+};
+
+#endif // GL_TILING_VIEW_H
@@ -0,0 +1,30 @@
+include(../common.pri)
+include(../core/core.pri)
+
+QT       += core gui concurrent
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = voronoi_tiling
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+        main.cpp \
+        dialog.cpp \
+        tiling-item.cpp \
+        tiling-worker.cpp
+
+HEADERS += \
+        dialog.h \
+        tiling-item.h \
+        tiling-worker.h
+
+# qmake CONFIG+=vt_opengl: draws the cells from a vertex buffer instead, and
+# rasterizes them by jump flooding on OpenGL 4.3
+vt_opengl {
+    DEFINES += VT_OPENGL
+    SOURCES += gl-tiling-view.cpp jump-flood.cpp
+    HEADERS += gl-tiling-view.h jump-flood.h
+}
@@ -0,0 +1,239 @@
+#include "jump-flood.h"
+
+#include <QOpenGLFunctions_4_3_Core>
+#include <QSurfaceFormat>
+
+#include <algorithm>
+
+#include "adjacency.h"
+
+namespace {
+
+const char *clearShader =
+    "#version 430\n"
+    "layout(local_size_x = 8, local_size_y = 8) in;\n"
+    "layout(r32ui, binding = 0) writeonly uniform uimage2D target;\n"
+    "void main() {\n"
+    "    ivec2 p = ivec2(gl_GlobalInvocationID.xy);\n"
+    "    if (all(lessThan(p, imageSize(target))))\n"
+    "        imageStore(target, p, uvec4(0xFFFFFFFFu));\n"
+    "}\n";
+
+// sites sharing a pixel keep the lowest index
+const char *seedShader =
+    "#version 430\n"
+    "layout(local_size_x = 64) in;\n"
+    "layout(std430, binding = 0) readonly buffer Sites { vec2 sites[]; };\n"
+    "layout(r32ui, binding = 0) uniform uimage2D target;\n"
+    "uniform uint count;\n"
+    "void main() {\n"
+    "    uint i = gl_GlobalInvocationID.x;\n"
+    "    if (i >= count)\n"
+    "        return;\n"
+    "    ivec2 p = clamp(ivec2(floor(sites[i])), ivec2(0), imageSize(target) - 1);\n"
+    "    imageAtomicMin(target, p, i);\n"
+    "}\n";
+
+const char *floodShader =
+    "#version 430\n"
+    "layout(local_size_x = 8, local_size_y = 8) in;\n"
+    "layout(std430, binding = 0) readonly buffer Sites { vec2 sites[]; };\n"
+    "layout(r32ui, binding = 0) readonly uniform uimage2D source;\n"
+    "layout(r32ui, binding = 1) writeonly uniform uimage2D target;\n"
+    "uniform int step;\n"
+    "uniform ivec2 wrap;\n"
+    "void main() {\n"
+    "    ivec2 size = imageSize(source);\n"
+    "    ivec2 p = ivec2(gl_GlobalInvocationID.xy);\n"
+    "    if (any(greaterThanEqual(p, size)))\n"
+    "        return;\n"
+    "    vec2 centre = vec2(p) + 0.5;\n"
+    "    uint best = 0xFFFFFFFFu;\n"
+    "    float best_d = 0.0;\n"
+    "    for (int dy = -1; dy <= 1; ++dy) {\n"
+    "        for (int dx = -1; dx <= 1; ++dx) {\n"
+    "            ivec2 q = p + step * ivec2(dx, dy);\n"
+    "            if (wrap.x != 0)\n"
+    "                q.x = (q.x % size.x + size.x) % size.x;\n"
+    "            if (wrap.y != 0)\n"
+    "                q.y = (q.y % size.y + size.y) % size.y;\n"
+    "            if (any(lessThan(q, ivec2(0))) || any(greaterThanEqual(q, size)))\n"
+    "                continue;\n"
+    "            uint id = imageLoad(source, q).x;\n"
+    "            if (id == 0xFFFFFFFFu)\n"
+    "                continue;\n"
+    "            vec2 d = abs(sites[id] - centre);\n"
+    "            if (wrap.x != 0)\n"
+    "                d.x = min(d.x, float(size.x) - d.x);\n"
+    "            if (wrap.y != 0)\n"
+    "                d.y = min(d.y, float(size.y) - d.y);\n"
+    "            float dd = dot(d, d);\n"
+    "            if (best == 0xFFFFFFFFu || dd < best_d || (dd == best_d && id < best)) {\n"
+    "                best = id;\n"
+    "                best_d = dd;\n"
+    "            }\n"
+    "        }\n"
+    "    }\n"
+    "    imageStore(target, p, uvec4(best));\n"
+    "}\n";
+
+// work group sizes of the shaders
+const int GROUP_SIZE = 8;
+const int SEED_GROUP_SIZE = 64;
+
+bool build(const char *name, QOpenGLShaderProgram &program, const char *source) {
+    if (program.addShaderFromSourceCode(QOpenGLShader::Compute, source) && program.link())
+        return true;
+    qWarning("JumpFlood: %s shader: %s", name, qPrintable(program.log()));
+    return false;
+}
+
+} // namespace
+
+JumpFlood::JumpFlood()
+    : m_gl(nullptr)
+    , m_clear(new QOpenGLShaderProgram)
+    , m_seed(new QOpenGLShaderProgram)
+    , m_flood(new QOpenGLShaderProgram)
+    , m_textures{0, 0}
+    , m_sites(0)
+    , m_width(0)
+    , m_height(0)
+{
+    QSurfaceFormat format;
+    format.setVersion(4, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+
+    m_surface.setFormat(format);
+    m_surface.create();
+    m_context.setFormat(format);
+    if (!m_context.create() || !m_context.makeCurrent(&m_surface)) {
+        qWarning("JumpFlood: no OpenGL context");
+        m_clear.reset();
+        m_seed.reset();
+        m_flood.reset();
+        return;
+    }
+
+    // null when the context is older than 4.3
+    QOpenGLFunctions_4_3_Core *gl = m_context.versionFunctions<QOpenGLFunctions_4_3_Core>();
+    if (gl && gl->initializeOpenGLFunctions() && build("clear", *m_clear, clearShader)
+        && build("seed", *m_seed, seedShader) && build("flood", *m_flood, floodShader)) {
+        m_gl = gl;
+        m_gl->glGenBuffers(1, &m_sites);
+    } else {
+        qWarning("JumpFlood: no compute shaders, OpenGL 4.3 is needed");
+        m_clear.reset();
+        m_seed.reset();
+        m_flood.reset();
+    }
+    m_context.doneCurrent();
+}
+
+JumpFlood::~JumpFlood() {
+    if (!m_gl)
+        return;
+
+    // the programs and buffers go with the context current
+    m_context.makeCurrent(&m_surface);
+    m_gl->glDeleteTextures(2, m_textures);
+    m_gl->glDeleteBuffers(1, &m_sites);
+    m_clear.reset();
+    m_seed.reset();
+    m_flood.reset();
+    m_context.doneCurrent();
+}
+
+void JumpFlood::resize(int width, int height) {
+    if (width == m_width && height == m_height)
+        return;
+
+    // immutable storage, a new size takes new textures
+    m_gl->glDeleteTextures(2, m_textures);
+    m_gl->glGenTextures(2, m_textures);
+    for (GLuint texture : m_textures) {
+        m_gl->glBindTexture(GL_TEXTURE_2D, texture);
+        m_gl->glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, width, height);
+    }
+    m_gl->glBindTexture(GL_TEXTURE_2D, 0);
+    m_width = width;
+    m_height = height;
+}
+
+bool JumpFlood::rasterize(const std::vector<vt::CellVertex> &sites, double w, double h, int width, int height,
+                          vt::CellRaster &raster, vt::Wrap wrap) {
+    if (!m_gl || width <= 0 || height <= 0 || sites.size() >= vt::NO_CELL)
+        return false;
+    if (!m_context.makeCurrent(&m_surface))
+        return false;
+
+    GLint max_size = 0;
+    m_gl->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    if (width > max_size || height > max_size) {
+        m_context.doneCurrent();
+        return false;
+    }
+    resize(width, height);
+
+    // sites in pixels, single precision is exact enough at any texture size
+    std::vector<GLfloat> coordinates;
+    coordinates.reserve(2 * sites.size());
+    for (const vt::CellVertex &s : sites) {
+        coordinates.push_back(GLfloat(s.x() * width / w));
+        coordinates.push_back(GLfloat(s.y() * height / h));
+    }
+    m_gl->glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_sites);
+    m_gl->glBufferData(GL_SHADER_STORAGE_BUFFER, GLsizeiptr(coordinates.size() * sizeof(GLfloat)),
+                       coordinates.data(), GL_STREAM_DRAW);
+    m_gl->glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_sites);
+
+    const GLuint groups_x = GLuint((width + GROUP_SIZE - 1) / GROUP_SIZE);
+    const GLuint groups_y = GLuint((height + GROUP_SIZE - 1) / GROUP_SIZE);
+
+    m_gl->glBindImageTexture(0, m_textures[0], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32UI);
+    m_clear->bind();
+    m_gl->glDispatchCompute(groups_x, groups_y, 1);
+    m_gl->glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    if (!sites.empty()) {
+        m_gl->glBindImageTexture(0, m_textures[0], 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+        m_seed->bind();
+        m_gl->glUniform1ui(m_seed->uniformLocation("count"), GLuint(sites.size()));
+        m_gl->glDispatchCompute(GLuint((sites.size() + SEED_GROUP_SIZE - 1) / SEED_GROUP_SIZE), 1, 1);
+        m_gl->glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    // steps from half the size down to 1, then one more pass at 1
+    std::vector<int> steps;
+    int step = 1;
+    while (2 * step < std::max(width, height))
+        step *= 2;
+    for (; step >= 1; step /= 2)
+        steps.push_back(step);
+    steps.push_back(1);
+
+    m_flood->bind();
+    m_gl->glUniform2i(m_flood->uniformLocation("wrap"), (wrap & vt::WRAP_X) != 0, (wrap & vt::WRAP_Y) != 0);
+    int current = 0;
+    for (int s : steps) {
+        m_gl->glBindImageTexture(0, m_textures[current], 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32UI);
+        m_gl->glBindImageTexture(1, m_textures[1 - current], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32UI);
+        m_gl->glUniform1i(m_flood->uniformLocation("step"), s);
+        m_gl->glDispatchCompute(groups_x, groups_y, 1);
+        m_gl->glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        current = 1 - current;
+    }
+    m_flood->release();
+
+    m_gl->glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+    raster.width = width;
+    raster.height = height;
+    raster.ids.resize(size_t(width) * size_t(height));
+    m_gl->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    m_gl->glBindTexture(GL_TEXTURE_2D, m_textures[current]);
+    m_gl->glGetTexImage(GL_TEXTURE_2D, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, raster.ids.data());
+    m_gl->glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_context.doneCurrent();
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef JUMP_FLOOD_H
+#define JUMP_FLOOD_H
+
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+
+#include <memory>
+#include <vector>
+
+#include "cell-raster.h"
+#include "cell-store.h"
+#include "tiling.h"
+
+class QOpenGLFunctions_4_3_Core;
+
+/**
+ * Cell raster of a tile straight from its sites, by jump flooding on the
+ * GPU: the sites are seeded into an integer texture which log2(size) + 1
+ * compute passes then fill with the nearest site of every pixel, no
+ * diagram nor polygon being involved.
+ *
+ * Each pixel takes the nearest of the sites its 8 neighbours at the pass
+ * step away hold, the step halving from pass to pass and the last pass
+ * being repeated at 1. That is the nearest site of nearly every pixel: the
+ * few that are not lie along cell edges. Where the sites of a pixel tie,
+ * the lowest index wins, as for duplicate sites in the cell store.
+ *
+ * Needs OpenGL 4.3 for the compute shaders, the class has its own offscreen
+ * context, made current in rasterize() only. Lives on the GUI thread.
+ */
+class JumpFlood {
+public:
+    JumpFlood();
+    ~JumpFlood();
+
+    JumpFlood(const JumpFlood &) = delete;
+    JumpFlood &operator=(const JumpFlood &) = delete;
+
+    /// false without an OpenGL 4.3 context, rasterize() then always fails
+    bool isValid() const { return m_gl != nullptr; }
+
+    /**
+     * Nearest site index of each pixel of the w x h tile scaled to width x
+     * height pixels, raster being laid out as vt::rasterizeCells() does.
+     * Distances run across the wrapped borders. Returns false, raster left
+     * alone, if the GPU cannot do it.
+     */
+    bool rasterize(const std::vector<vt::CellVertex> &sites, double w, double h, int width, int height,
+                   vt::CellRaster &raster, vt::Wrap wrap = vt::WRAP_NONE);
+
+private:
+    void resize(int width, int height);
+
+    QOffscreenSurface m_surface;
+    QOpenGLContext m_context;
+    QOpenGLFunctions_4_3_Core *m_gl;
+
+    std::unique_ptr<QOpenGLShaderProgram> m_clear, m_seed, m_flood;
+    GLuint m_textures[2];   // ping-pong, R32UI
+    GLuint m_sites;         // shader storage, vec2 per site in pixels
+    int m_width, m_height;
+};
+
+#endif // JUMP_FLOOD_H
@@ -0,0 +1,180 @@
+#include "tiling-item.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const QColor colors[] = {
+    QColor(252, 233,  79), QColor(237, 212,   0), QColor(196, 160,   0),
+    QColor(138, 226,  52), QColor(115, 210,  22), QColor( 78, 154,   6),
+    QColor(252, 175,  62), QColor(245, 121,   0), QColor(206,  92,   0),
+    QColor(114, 159, 207), QColor( 52, 101, 164), QColor( 32,  74, 135),
+    QColor(173, 127, 168), QColor(117,  80, 123), QColor( 92,  53, 102),
+    QColor(233, 185, 110), QColor(193, 125,  17), QColor(143,  89,   2),
+    QColor(239,  41,  41), QColor(204,   0,   0), QColor(164,   0,   0),
+    QColor(238, 238, 236), QColor(211, 215, 207), QColor(186, 189, 182),
+    QColor(136, 138, 133), QColor( 85,  87,  83), QColor( 46,  52,  54),
+    QColor(  0,   0,   0)
+};
+
+// below this many pixels per cell, cells are drawn as dots
+const double MIN_CELL_PIXELS = 2.0;
+// above this many pixels per cell, site markers are drawn
+const double MIN_MARKER_PIXELS = 12.0;
+// radius of the site markers, in tile units
+const double MARKER_RADIUS = 0.1;
+
+// about this many cells per bucket
+const double CELLS_PER_BUCKET = 16.0;
+
+} // namespace
+
+QColor cellColor(size_t i) {
+    return colors[i % cellColorCount()];
+}
+
+size_t cellColorCount() {
+    return sizeof(colors) / sizeof(QColor);
+}
+
+TilingItem::TilingItem(QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+    , m_w(0.0)
+    , m_h(0.0)
+    , m_spacing(0.0)
+    , m_cols(0)
+    , m_rows(0)
+    , m_bucket(1.0)
+    , m_margin(0.0)
+    , m_visible(cellColorCount())
+{
+    // exposedRect is only filled in with the extended style option
+    setFlag(ItemUsesExtendedStyleOption);
+}
+
+void TilingItem::setTiling(double w, double h, std::vector<vt::CellVertex> sites, vt::CellStore cells) {
+    prepareGeometryChange();
+    m_w = w;
+    m_h = h;
+    m_sites.swap(sites);
+    m_cells = std::move(cells);
+    m_spacing = std::sqrt(w * h / std::max<size_t>(m_cells.size(), 1));
+    buildBuckets();
+    update();
+}
+
+QRectF TilingItem::boundingRect() const {
+    return QRectF(0.0, 0.0, m_w, m_h);
+}
+
+void TilingItem::buildBuckets() {
+    m_bucket = m_spacing * std::sqrt(CELLS_PER_BUCKET);
+    m_cols = std::max(1, int(std::ceil(m_w / m_bucket)));
+    m_rows = std::max(1, int(std::ceil(m_h / m_bucket)));
+    m_margin = 0.0;
+
+    // one counting pass and one filling pass over the cells
+    std::vector<uint32_t> home(m_cells.size());
+    m_bucket_offsets.assign(size_t(m_cols) * m_rows + 1, 0);
+    for (size_t i = 0; i < m_cells.size(); ++i) {
+        const vt::CellView cell = m_cells[i];
+        if (cell.empty())
+            continue;
+
+        double x0 = cell[0].x(), y0 = cell[0].y(), x1 = x0, y1 = y0;
+        for (const auto &v : cell) {
+            x0 = std::min(x0, v.x());
+            y0 = std::min(y0, v.y());
+            x1 = std::max(x1, v.x());
+            y1 = std::max(y1, v.y());
+        }
+        m_margin = std::max(m_margin, std::max(x1 - x0, y1 - y0));
+
+        const int bx = std::min(int(x0 / m_bucket), m_cols - 1);
+        const int by = std::min(int(y0 / m_bucket), m_rows - 1);
+        home[i] = uint32_t(by * m_cols + bx);
+        ++m_bucket_offsets[home[i] + 1];
+    }
+
+    for (size_t b = 0; b + 1 < m_bucket_offsets.size(); ++b)
+        m_bucket_offsets[b + 1] += m_bucket_offsets[b];
+
+    std::vector<uint32_t> fill(m_bucket_offsets.begin(), m_bucket_offsets.end() - 1);
+    m_bucket_cells.resize(m_bucket_offsets.back());
+    for (size_t i = 0; i < m_cells.size(); ++i) {
+        if (!m_cells[i].empty())
+            m_bucket_cells[fill[home[i]]++] = uint32_t(i);
+    }
+}
+
+void TilingItem::collectVisible(const QRectF &rect) {
+    for (auto &v : m_visible)
+        v.clear();
+    if (m_bucket_cells.empty())
+        return;
+
+    const int bx0 = std::max(0, int(std::floor((rect.left() - m_margin) / m_bucket)));
+    const int by0 = std::max(0, int(std::floor((rect.top() - m_margin) / m_bucket)));
+    const int bx1 = std::min(m_cols - 1, int(std::floor(rect.right() / m_bucket)));
+    const int by1 = std::min(m_rows - 1, int(std::floor(rect.bottom() / m_bucket)));
+
+    for (int by = by0; by <= by1; ++by) {
+        for (int bx = bx0; bx <= bx1; ++bx) {
+            const size_t b = size_t(by) * m_cols + bx;
+            for (uint32_t k = m_bucket_offsets[b]; k < m_bucket_offsets[b + 1]; ++k) {
+                const uint32_t i = m_bucket_cells[k];
+                m_visible[i % m_visible.size()].push_back(i);
+            }
+        }
+    }
+}
+
+void TilingItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *) {
+    const double lod = option->levelOfDetailFromTransform(painter->worldTransform());
+    const double cell_pixels = m_spacing * lod;
+
+    painter->setPen(QPen(Qt::black, 0.0));
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRect(boundingRect());
+
+    collectVisible(option->exposedRect);
+
+    if (cell_pixels < MIN_CELL_PIXELS) {
+        for (size_t c = 0; c < m_visible.size(); ++c) {
+            m_points.clear();
+            for (uint32_t i : m_visible[c])
+                m_points.push_back(QPointF(m_sites[i].x(), m_sites[i].y()));
+            painter->setPen(QPen(cellColor(c), 0.0));
+            painter->drawPoints(m_points.data(), int(m_points.size()));
+        }
+        return;
+    }
+
+    painter->setPen(Qt::NoPen);
+    for (size_t c = 0; c < m_visible.size(); ++c) {
+        QColor col = cellColor(c);
+        col.setAlphaF(0.5);
+        painter->setBrush(col);
+
+        for (uint32_t i : m_visible[c]) {
+            const vt::CellView cell = m_cells[i];
+            m_points.clear();
+            for (const auto &v : cell)
+                m_points.push_back(QPointF(v.x(), v.y()));
+            painter->drawPolygon(m_points.data(), int(m_points.size()));
+        }
+    }
+
+    if (cell_pixels < MIN_MARKER_PIXELS)
+        return;
+
+    for (size_t c = 0; c < m_visible.size(); ++c) {
+        painter->setBrush(cellColor(c));
+        for (uint32_t i : m_visible[c])
+            painter->drawEllipse(QPointF(m_sites[i].x(), m_sites[i].y()), MARKER_RADIUS, MARKER_RADIUS);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef TILING_ITEM_H
+#define TILING_ITEM_H
+
+#include <QGraphicsItem>
+#include <QColor>
+#include <QPointF>
+
+#include <cstdint>
+#include <vector>
+
+#include "cell-store.h"
+
+/// colour of cell i, shared by the renderers
+QColor cellColor(size_t i);
+/// number of distinct cell colours, cellColor() repeats after that
+size_t cellColorCount();
+
+/**
+ * Whole tiling painted by a single scene item, straight from the flat cell
+ * buffer, instead of one item per cell and per site.
+ *
+ * Cells are bucketed on a grid so that painting only walks those in the
+ * exposed rectangle, and drawn colour by colour to limit state changes.
+ * The level of detail follows the zoom: cells smaller than a couple of
+ * pixels are drawn as one dot each, site markers only show when cells are
+ * large enough for them to be told apart.
+ */
+class TilingItem : public QGraphicsItem {
+public:
+    TilingItem(QGraphicsItem *parent = nullptr);
+
+    /// sites in tile coordinates, cells[i] being the cell of sites[i]
+    void setTiling(double w, double h, std::vector<vt::CellVertex> sites, vt::CellStore cells);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+private:
+    void buildBuckets();
+    void collectVisible(const QRectF &rect);
+
+    double m_w, m_h;
+    double m_spacing;   // mean distance between sites
+    std::vector<vt::CellVertex> m_sites;
+    vt::CellStore m_cells;
+
+    // cells bucketed by the top-left corner of their bounding box, a cell
+    // reaching at most m_margin beyond it
+    int m_cols, m_rows;
+    double m_bucket, m_margin;
+    std::vector<uint32_t> m_bucket_offsets, m_bucket_cells;
+
+    // painting scratch, kept between frames
+    std::vector<std::vector<uint32_t>> m_visible;   // by colour
+    std::vector<QPointF> m_points;
+};
+
+#endif // TILING_ITEM_H
@@ -0,0 +1,124 @@
+#include "tiling-worker.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+#include "progress.h"
+#include "relaxation.h"
+#include "tile-format.h"
+
+TilingWorker::TilingWorker(QObject *parent)
+    : QObject(parent)
+    , m_run(0)
+{
+    // the disk part only if the cache directory is usable
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/tiles";
+    const bool disk = !dir.isEmpty() && QDir().mkpath(dir);
+    m_cache = std::make_shared<vt::TileCache>(vt::TileCache::DEFAULT_MEMORY_BUDGET,
+                                              disk ? dir.toStdString() : std::string());
+
+    // runProgress is emitted from the pipeline thread, hence queued
+    connect(this, &TilingWorker::runProgress, this, &TilingWorker::forwardProgress, Qt::QueuedConnection);
+    connect(&m_watcher, &QFutureWatcher<Result>::finished, this, &TilingWorker::forwardResult);
+}
+
+TilingWorker::~TilingWorker() {
+    cancel();
+    for (auto &f : m_runs)
+        f.waitForFinished();
+}
+
+bool TilingWorker::isRunning() const {
+    return m_cancelled && m_watcher.isRunning();
+}
+
+vt::TileCacheStats TilingWorker::cacheStats() const {
+    return m_cache->stats();
+}
+
+void TilingWorker::cancel() {
+    if (m_cancelled)
+        *m_cancelled = true;
+    m_cancelled.reset();
+    ++m_run;
+}
+
+void TilingWorker::start(const TilingRequest &request) {
+    cancel();
+
+    const int run = m_run;
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_cancelled = cancelled;
+
+    std::shared_ptr<vt::TileCache> cache = m_cache;
+    QFuture<Result> future = QtConcurrent::run([this, request, run, cancelled, cache]() -> Result {
+        auto phase = [&](Phase p) {
+            return vt::Progress([=](double done) {
+                emit runProgress(run, p, done);
+                return !*cancelled;
+            });
+        };
+
+        QElapsedTimer t;
+        t.start();
+
+        const vt::TileKey key = vt::tileKey(request.w, request.h, request.count, request.seed, request.iterations);
+        Result result = std::make_shared<TilingResult>();
+        result->request = request;
+        result->cached = false;
+
+        const vt::TileCache::Tile tile = cache->find(key);
+        if (tile && vt::decodeTile(*tile, result->sites, result->cells)) {
+            result->cached = true;
+            result->elapsed = t.elapsed();
+            return result;
+        }
+
+        try {
+            result->sites = vt::generateGrid(request.w, request.h, request.count, request.seed, phase(Sampling));
+
+            if (request.iterations > 0) {
+                vt::Relaxation relaxation(request.w, request.h);
+                relaxation.relax(result->sites, request.iterations, 1e-3, phase(Relaxing));
+                result->cells = relaxation.cells();
+            }
+            else {
+                result->cells = vt::computeVoronoi(result->sites, request.w, request.h, vt::defaultPool(),
+                                                   nullptr, nullptr, phase(Cells));
+            }
+
+            auto bytes = std::make_shared<std::string>();
+            if (vt::encodeTile(request.w, request.h, vt::siteCoordinates(result->sites, request.w, request.h),
+                               result->cells, nullptr, nullptr, *bytes))
+                cache->insert(key, bytes);
+
+            result->elapsed = t.elapsed();
+            return result;
+        }
+        catch (const vt::Cancelled &) {
+            return Result();
+        }
+    });
+
+    for (int i = m_runs.size() - 1; i >= 0; --i) {
+        if (m_runs[i].isFinished())
+            m_runs.removeAt(i);
+    }
+    m_runs.append(future);
+    m_watcher.setFuture(future);
+}
+
+void TilingWorker::forwardProgress(int run, int phase, double done) {
+    if (run == m_run)
+        emit progress(phase, done);
+}
+
+void TilingWorker::forwardResult() {
+    Result result = m_watcher.result();
+    if (result && m_cancelled && !*m_cancelled) {
+        m_cancelled.reset();
+        emit finished(result);
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef TILING_WORKER_H
+#define TILING_WORKER_H
+
+#include <QObject>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QList>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "cell-store.h"
+#include "tile-cache.h"
+#include "tiling.h"
+
+/// parameters of one generation
+struct TilingRequest {
+    int w, h;
+    int count;
+    int iterations;   ///< Lloyd iterations, 0 for none
+    uint32_t seed;
+};
+
+/// outcome of a generation
+struct TilingResult {
+    TilingRequest request;
+    vt::Grid sites;
+    vt::CellStore cells;
+    qint64 elapsed;   ///< milliseconds
+    bool cached;      ///< served from the tile cache
+};
+
+/**
+ * Runs the generation pipeline off the GUI thread.
+ *
+ * Phases report their progress through progress(), and the result comes
+ * whole through finished(), both on the thread of the worker. Starting a
+ * run cancels the current one: it stops at its next progress report and
+ * nothing it produced is emitted anymore.
+ *
+ * Results are kept in a tile cache, in memory and in the user cache
+ * directory, and requests seen before are served from it.
+ */
+class TilingWorker : public QObject {
+    Q_OBJECT
+
+public:
+    enum Phase { Sampling, Relaxing, Cells };
+
+    explicit TilingWorker(QObject *parent = nullptr);
+    /// cancels the current run and waits for every run still going
+    ~TilingWorker();
+
+    void start(const TilingRequest &request);
+    void cancel();
+    bool isRunning() const;
+
+    vt::TileCacheStats cacheStats() const;
+
+signals:
+    void progress(int phase, double done);
+    void finished(std::shared_ptr<TilingResult> result);
+
+    // from the pipeline thread, tagged with the run it belongs to
+    void runProgress(int run, int phase, double done);
+
+private slots:
+    void forwardProgress(int run, int phase, double done);
+    void forwardResult();
+
+private:
+    typedef std::shared_ptr<TilingResult> Result;
+
+    QFutureWatcher<Result> m_watcher;
+    QList<QFuture<Result>> m_runs;   // cancelled ones may still be winding down
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+    int m_run;
+    std::shared_ptr<vt::TileCache> m_cache;
+};
+
+#endif // TILING_WORKER_H
@@ -0,0 +1,298 @@
+#include "check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <dirent.h>
+#include <unistd.h>
+
+namespace vt {
+namespace test {
+
+namespace {
+
+double distance(const CellVertex &a, const CellVertex &b) {
+    return std::hypot(a.x() - b.x(), a.y() - b.y());
+}
+
+double perimeter(const CellView &cell) {
+    double total = 0.0;
+    for (size_t i = 0; i < cell.size(); ++i)
+        total += distance(cell[i], cell[(i + 1) % cell.size()]);
+    return total;
+}
+
+/// every vertex of a within tolerance of one of b
+bool coveredBy(const CellView &a, const CellView &b, double tolerance) {
+    for (const CellVertex &v : a) {
+        bool found = false;
+        for (const CellVertex &u : b)
+            found = found || distance(u, v) <= tolerance;
+        if (!found)
+            return false;
+    }
+    return true;
+}
+
+/// keeps the part of the convex ring closer to p than to q
+void cutByBisector(std::vector<CellVertex> &ring, const CellVertex &p, const CellVertex &q,
+                   std::vector<CellVertex> &scratch) {
+    const double nx = q.x() - p.x(), ny = q.y() - p.y();
+    const double mx = 0.5 * (p.x() + q.x()), my = 0.5 * (p.y() + q.y());
+    auto side = [&](const CellVertex &v) { return (v.x() - mx) * nx + (v.y() - my) * ny; };
+
+    bool cut = false;
+    for (const CellVertex &v : ring)
+        cut = cut || side(v) > 0.0;
+    if (!cut)
+        return;
+
+    scratch.clear();
+    for (size_t i = 0; i < ring.size(); ++i) {
+        const CellVertex &a = ring[i], &b = ring[(i + 1) % ring.size()];
+        const double sa = side(a), sb = side(b);
+        if (sa <= 0.0)
+            scratch.push_back(a);
+        if ((sa <= 0.0) != (sb <= 0.0)) {
+            const double t = sa / (sa - sb);
+            scratch.emplace_back(a.x() + t * (b.x() - a.x()), a.y() + t * (b.y() - a.y()));
+        }
+    }
+    ring.swap(scratch);
+}
+
+} // namespace
+
+std::string format(const char *fmt, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+    return buffer;
+}
+
+void Checker::expect(bool ok, const std::string &what) {
+    if (!ok)
+        ++m_failed;
+    if (!ok || !m_quiet)
+        std::printf("%s %s\n", ok ? "ok  " : "FAIL", what.c_str());
+}
+
+// the second tile is large enough to be partitioned and the last two hold
+// one and two sites, whose diagrams have no vertex
+const std::vector<Case> CASES = {
+    {1000, 1000, 20000, 1, WRAP_NONE},
+    {1600, 900, 100000, 7, WRAP_NONE},
+    {640, 480, 5000, 42, WRAP_XY},
+    {800, 800, 60000, 3, WRAP_X},
+    {10, 10, 1, 0, WRAP_NONE},
+    {10, 10, 2, 1, WRAP_NONE},
+};
+
+std::string caseName(const Case &c) {
+    return format("%dx%d n=%d seed=%u%s", c.w, c.h, c.num, unsigned(c.seed), wrapName(c.wrap));
+}
+
+const char *wrapName(Wrap wrap) {
+    static const char *names[] = {"", " wrap x", " wrap y", " wrap xy"};
+    return names[wrap];
+}
+
+TemporaryDirectory::TemporaryDirectory() {
+    const char *tmp = std::getenv("TMPDIR");
+    std::string pattern = std::string(tmp && *tmp ? tmp : "/tmp") + "/vt_tests.XXXXXX";
+    if (mkdtemp(&pattern[0]))
+        m_path = pattern;
+}
+
+TemporaryDirectory::~TemporaryDirectory() {
+    if (m_path.empty())
+        return;
+
+    if (DIR *dir = opendir(m_path.c_str())) {
+        while (const dirent *entry = readdir(dir)) {
+            const std::string name = entry->d_name;
+            if (name != "." && name != "..")
+                unlink(file(name).c_str());
+        }
+        closedir(dir);
+    }
+    rmdir(m_path.c_str());
+}
+
+bool readFile(const std::string &path, std::string &contents) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    std::ostringstream out;
+    out << in.rdbuf();
+    contents = out.str();
+    return !in.bad();
+}
+
+bool near(const CellVertex &a, const CellVertex &b, double tolerance) {
+    return std::abs(a.x() - b.x()) <= tolerance && std::abs(a.y() - b.y()) <= tolerance;
+}
+
+bool sameCells(const CellStore &a, const CellStore &b, double tolerance, const std::vector<uint32_t> *ea,
+               const std::vector<uint32_t> *eb) {
+    if (a.offsets() != b.offsets())
+        return false;
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        const CellView ca = a[i], cb = b[i];
+        const size_t n = ca.size();
+        if (!n)
+            continue;
+
+        size_t shift = 0;
+        while (shift < n && !near(ca[0], cb[shift], tolerance))
+            ++shift;
+        if (shift == n)
+            return false;
+
+        const uint32_t first = a.offsets()[i];
+        for (size_t j = 0; j < n; ++j) {
+            const size_t k = (j + shift) % n;
+            if (!near(ca[j], cb[k], tolerance) || (ea && (*ea)[first + j] != (*eb)[first + k]))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool sameAdjacency(const Adjacency &a, const Adjacency &b) {
+    return a.offsets() == b.offsets() && a.neighbours() == b.neighbours();
+}
+
+bool coversArea(const CellStore &cells, size_t count, double expected, double &total) {
+    total = 0.0;
+    bool full = cells.size() == count;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        const double a = area(cells[i]);
+        full = full && a > 0.0;
+        total += a;
+    }
+    return full && std::abs(total - expected) <= AREA_TOLERANCE * expected;
+}
+
+double closestPair(const std::vector<CellVertex> &points, double w, double h, double min_dist, Wrap wrap) {
+    const int nx = std::max(int(w / min_dist), 1);
+    const int ny = std::max(int(h / min_dist), 1);
+    std::vector<std::vector<size_t>> buckets(size_t(nx) * size_t(ny));
+    auto bucket = [](double v, double extent, int n) { return std::min(std::max(int(v / extent * n), 0), n - 1); };
+    for (size_t i = 0; i < points.size(); ++i)
+        buckets[size_t(bucket(points[i].y(), h, ny)) * nx + bucket(points[i].x(), w, nx)].push_back(i);
+
+    double best = HUGE_VAL;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const int bx = bucket(points[i].x(), w, nx), by = bucket(points[i].y(), h, ny);
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int x = bx + dx, y = by + dy;
+                if ((wrap & WRAP_X) && nx > 2)
+                    x = (x + nx) % nx;
+                if ((wrap & WRAP_Y) && ny > 2)
+                    y = (y + ny) % ny;
+                if (x < 0 || y < 0 || x >= nx || y >= ny)
+                    continue;
+
+                for (size_t j : buckets[size_t(y) * nx + x]) {
+                    if (j <= i)
+                        continue;
+                    double ex = std::abs(points[i].x() - points[j].x());
+                    double ey = std::abs(points[i].y() - points[j].y());
+                    if (wrap & WRAP_X)
+                        ex = std::min(ex, w - ex);
+                    if (wrap & WRAP_Y)
+                        ey = std::min(ey, h - ey);
+                    best = std::min(best, std::sqrt(ex * ex + ey * ey));
+                }
+            }
+        }
+    }
+    return best;
+}
+
+CellStore referenceCells(const std::vector<CellVertex> &sites, double w, double h, Wrap wrap) {
+    const int kx = (wrap & WRAP_X) ? 1 : 0;
+    const int ky = (wrap & WRAP_Y) ? 1 : 0;
+
+    // every site and its copies a period away along the wrapped axes
+    std::vector<CellVertex> others;
+    for (int oy = -ky; oy <= ky; ++oy)
+        for (int ox = -kx; ox <= kx; ++ox)
+            for (const CellVertex &s : sites)
+                others.emplace_back(s.x() + ox * w, s.y() + oy * h);
+
+    const double x0 = -kx * w, y0 = -ky * h;
+    const double ew = (2 * kx + 1) * w, eh = (2 * ky + 1) * h;
+    const double side = std::sqrt(ew * eh / std::max<size_t>(others.size(), 1));
+    const int nx = std::max(int(std::ceil(ew / side)), 1);
+    const int ny = std::max(int(std::ceil(eh / side)), 1);
+    auto bucketX = [&](double x) { return std::min(std::max(int((x - x0) / side), 0), nx - 1); };
+    auto bucketY = [&](double y) { return std::min(std::max(int((y - y0) / side), 0), ny - 1); };
+
+    std::vector<std::vector<size_t>> buckets(size_t(nx) * size_t(ny));
+    for (size_t i = 0; i < others.size(); ++i)
+        buckets[size_t(bucketY(others[i].y())) * nx + bucketX(others[i].x())].push_back(i);
+
+    CellStore cells;
+    std::vector<CellVertex> ring, scratch;
+    for (const CellVertex &p : sites) {
+        const double cx0 = kx ? p.x() - w : 0.0, cx1 = kx ? p.x() + w : w;
+        const double cy0 = ky ? p.y() - h : 0.0, cy1 = ky ? p.y() + h : h;
+        ring.assign({CellVertex(cx0, cy0), CellVertex(cx1, cy0), CellVertex(cx1, cy1), CellVertex(cx0, cy1)});
+
+        // the buckets r rings away and further hold sites at least (r - 1)
+        // buckets away, which cannot cut the cell once past twice its radius
+        const int bx = bucketX(p.x()), by = bucketY(p.y());
+        for (int r = 0; r <= std::max(nx, ny); ++r) {
+            double radius = 0.0;
+            for (const CellVertex &v : ring)
+                radius = std::max(radius, distance(p, v));
+            if ((r - 1) * side > 2.0 * radius)
+                break;
+
+            for (int y = by - r; y <= by + r; ++y) {
+                for (int x = bx - r; x <= bx + r; ++x) {
+                    if (std::max(std::abs(x - bx), std::abs(y - by)) != r || x < 0 || y < 0 || x >= nx || y >= ny)
+                        continue;
+                    for (size_t j : buckets[size_t(y) * nx + x]) {
+                        if (others[j].x() != p.x() || others[j].y() != p.y())
+                            cutByBisector(ring, p, others[j], scratch);
+                    }
+                }
+            }
+        }
+        cells.append(ring);
+    }
+    return cells;
+}
+
+bool matchCells(const CellStore &a, const CellStore &b, double tolerance) {
+    if (a.size() != b.size())
+        return false;
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        const CellView ca = a[i], cb = b[i];
+        if (ca.empty() || cb.empty()) {
+            if (ca.empty() != cb.empty())
+                return false;
+            continue;
+        }
+        if (!coveredBy(ca, cb, tolerance) || !coveredBy(cb, ca, tolerance) ||
+            std::abs(std::abs(area(ca)) - std::abs(area(cb))) > tolerance * perimeter(ca))
+            return false;
+    }
+    return true;
+}
+
+} // namespace test
+} // namespace vt
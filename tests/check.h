@@ -0,0 +1,155 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "adjacency.h"
+#include "cell-store.h"
+#include "thread-pool.h"
+#include "tiling.h"
+
+namespace vt {
+namespace test {
+
+/// the sampler compares squared distances in single precision
+const double DISTANCE_SLACK = 1e-5;
+/// vertex and area differences allowed between two constructions, relative
+/// to the tile size and area
+const double VERTEX_TOLERANCE = 1e-9;
+const double AREA_TOLERANCE = 1e-9;
+/// same against referenceCells(), whose vertices are computed in double
+/// from intersections of bisectors rather than by the robust predicates
+const double REFERENCE_TOLERANCE = 1e-7;
+
+std::string format(const char *fmt, ...);
+
+/// generated tile the samplers and constructions run on
+struct Case {
+    int w, h, num;
+    uint32_t seed;
+    Wrap wrap;
+};
+
+/// fixed seeds shared by the groups, see check.cpp
+extern const std::vector<Case> CASES;
+
+std::string caseName(const Case &c);
+/// wrapped axes as caseName() prints them after the tile size
+const char *wrapName(Wrap wrap);
+
+/// counts the failed expectations and prints them, with the passed ones too
+/// unless quiet
+class Checker {
+public:
+    explicit Checker(bool quiet) : m_quiet(quiet) {}
+
+    void expect(bool ok, const std::string &what);
+
+    bool quiet() const { return m_quiet; }
+    int failed() const { return m_failed; }
+
+private:
+    bool m_quiet;
+    int m_failed = 0;
+};
+
+bool near(const CellVertex &a, const CellVertex &b, double tolerance);
+
+/**
+ * Same rings in a and b within tolerance, cell by cell, whatever vertex
+ * they start at: the constructions may start a ring at other ends of the
+ * edges along the tile border. The half-edge indices, when given, follow
+ * their rings.
+ */
+bool sameCells(const CellStore &a, const CellStore &b, double tolerance, const std::vector<uint32_t> *ea = nullptr,
+               const std::vector<uint32_t> *eb = nullptr);
+
+bool sameAdjacency(const Adjacency &a, const Adjacency &b);
+
+/// cell areas adding up to expected within AREA_TOLERANCE, count cells and
+/// none of them empty, their sum in total
+bool coversArea(const CellStore &cells, size_t count, double expected, double &total);
+
+/**
+ * Smallest distance between two of the points of a w x h rectangle, across
+ * the wrapped borders too, found in buckets min_dist wide: closer pairs
+ * always lie in neighbouring buckets.
+ */
+double closestPair(const std::vector<CellVertex> &points, double w, double h, double min_dist, Wrap wrap);
+
+/**
+ * Voronoi cells of sites over the w x h tile, computed the straightforward
+ * way as a reference for the constructions: each cell starts as the tile
+ * and is cut by the bisector of its site and every site closer than twice
+ * the distance to its farthest vertex, taken bucket by bucket outwards.
+ * Along a wrapped axis the tile is widened by a period on either side, and
+ * the sites enter once more shifted by a period either way.
+ */
+CellStore referenceCells(const std::vector<CellVertex> &sites, double w, double h, Wrap wrap = WRAP_NONE);
+
+/**
+ * Every vertex of a cell of a within tolerance of a vertex of the same cell
+ * of b and the other way round, and areas within tolerance times the perimeter:
+ * referenceCells() may keep two vertices closer than tolerance to each other
+ * where the constructions have one.
+ */
+bool matchCells(const CellStore &a, const CellStore &b, double tolerance);
+
+/// fresh directory under TMPDIR or /tmp, removed with the files in it on
+/// destruction
+class TemporaryDirectory {
+public:
+    TemporaryDirectory();
+    ~TemporaryDirectory();
+
+    TemporaryDirectory(const TemporaryDirectory &) = delete;
+    TemporaryDirectory &operator=(const TemporaryDirectory &) = delete;
+
+    /// empty if the directory could not be created
+    const std::string &path() const { return m_path; }
+    std::string file(const std::string &name) const { return m_path + "/" + name; }
+
+private:
+    std::string m_path;
+};
+
+/// whole contents of a file, false if it cannot be read
+bool readFile(const std::string &path, std::string &contents);
+
+/**
+ * The test groups, each running its paths on the wide pool and the inline
+ * one, the parallel paths splitting their work by the pool size.
+ */
+void checkSampling(Checker &check, ThreadPool &wide, ThreadPool &inline_pool);
+void checkVoronoi(Checker &check, ThreadPool &wide, ThreadPool &inline_pool);
+void checkEditing(Checker &check, ThreadPool &wide, ThreadPool &inline_pool);
+void checkChunkedWorld(Checker &check, ThreadPool &wide, ThreadPool &inline_pool);
+void checkRelaxation(Checker &check, ThreadPool &wide, ThreadPool &inline_pool);
+void checkTileFormat(Checker &check, ThreadPool &wide, ThreadPool &inline_pool);
+void checkTileCache(Checker &check, ThreadPool &wide, ThreadPool &inline_pool);
+void checkRaster(Checker &check, ThreadPool &wide, ThreadPool &inline_pool);
+void checkRegions(Checker &check, ThreadPool &wide, ThreadPool &inline_pool);
+
+/// what checkThroughput() measures against and where it keeps its numbers
+struct PerfSettings {
+    const char *baseline = nullptr;       ///< throughputs to hold the run to, none by default
+    const char *saveBaseline = nullptr;   ///< where to write the throughputs measured
+    double maxSlowdown = 15.0;            ///< percent a throughput may fall below its baseline
+};
+
+/**
+ * Times every path on a larger tile with pool, best of a few runs, and
+ * fails the paths whose throughput in sites per second is more than
+ * maxSlowdown percent below the one of the baseline file. The file holds
+ * one "name sites_per_second" line per path, as saveBaseline writes it;
+ * baselines only compare on the host and build they were measured on.
+ */
+void checkThroughput(Checker &check, const PerfSettings &settings, ThreadPool &pool);
+
+} // namespace test
+} // namespace vt
+
+#endif // CHECK_H
@@ -0,0 +1,142 @@
+#include "check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "editable-tiling.h"
+
+namespace vt {
+namespace test {
+
+namespace {
+
+const Case EDITED = {600, 400, 2000, 5, WRAP_NONE};
+
+/**
+ * Cells, edges and neighbours of t as computeVoronoiSerial() builds them
+ * from scratch on its live sites, renumbered to the indices of t. Only the
+ * rings follow the order of the construction, neighbours are compared as
+ * sets.
+ */
+bool sameAsRebuild(const EditableTiling &t) {
+    const Grid &sites = t.sites();
+    Grid live;
+    std::vector<uint32_t> index;
+    for (size_t i = 0; i < sites.size(); ++i) {
+        if (!t.isRemoved(i)) {
+            live.push_back(sites[i]);
+            index.push_back(uint32_t(i));
+        }
+    }
+
+    Adjacency adjacency;
+    std::vector<uint32_t> edges;
+    const CellStore fresh = computeVoronoiSerial(live, t.width(), t.height(), &adjacency, &edges);
+
+    CellStore expected;
+    std::vector<uint32_t> expected_edges;
+    std::vector<std::vector<uint32_t>> expected_neighbours(sites.size());
+    for (size_t k = 0; k < live.size(); ++k) {
+        for (uint32_t n : adjacency[k])
+            expected_neighbours[index[k]].push_back(index[n]);
+    }
+    size_t k = 0;
+    for (size_t i = 0; i < sites.size(); ++i) {
+        if (t.isRemoved(i)) {
+            expected.appendEmpty();
+            continue;
+        }
+        expected.append(fresh[k]);
+        for (uint32_t e = fresh.offsets()[k]; e < fresh.offsets()[k + 1]; ++e)
+            expected_edges.push_back(edges[e] == NO_CELL ? NO_CELL : index[edges[e]]);
+        ++k;
+    }
+
+    if (t.adjacency().size() != sites.size() ||
+        !sameCells(expected, t.cells(), VERTEX_TOLERANCE * std::max(t.width(), t.height()), &expected_edges,
+                   &t.edges()))
+        return false;
+
+    for (size_t i = 0; i < sites.size(); ++i) {
+        std::vector<uint32_t> got(t.adjacency()[i].begin(), t.adjacency()[i].end());
+        std::sort(got.begin(), got.end());
+        std::sort(expected_neighbours[i].begin(), expected_neighbours[i].end());
+        if (got != expected_neighbours[i])
+            return false;
+    }
+    return true;
+}
+
+std::vector<size_t> liveSites(const EditableTiling &t) {
+    std::vector<size_t> live;
+    for (size_t i = 0; i < t.sites().size(); ++i) {
+        if (!t.isRemoved(i))
+            live.push_back(i);
+    }
+    return live;
+}
+
+} // namespace
+
+void checkEditing(Checker &check, ThreadPool &, ThreadPool &) {
+    const Case &c = EDITED;
+    const std::string name = caseName(c);
+    EditableTiling tiling(c.w, c.h, generateGrid(c.w, c.h, c.num, c.seed));
+    check.expect(sameAsRebuild(tiling), format("edit %s: initial cells as a rebuild", name.c_str()));
+
+    const GridQuantizer quant(c.w, c.h);
+    std::mt19937 rng(c.seed);
+    std::uniform_real_distribution<double> x(0.0, c.w), y(0.0, c.h), nudge(-4.0, 4.0);
+    auto pick = [&](const std::vector<size_t> &live) {
+        return live[std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng)];
+    };
+    auto position = [&](size_t i) {
+        return CellVertex(quant.toReal(tiling.sites()[i].x()), quant.toReal(tiling.sites()[i].y()));
+    };
+
+    // nudges, far moves, additions, removals, then all of them in one batch
+    for (int round = 0; round < 5; ++round) {
+        std::vector<SiteEdit> edits;
+        for (int e = 0; e < 30; ++e) {
+            const std::vector<size_t> live = liveSites(tiling);
+            const int kind = round < 4 ? round : e % 4;
+            const size_t i = pick(live);
+            if (kind == 0)
+                edits.push_back(SiteEdit::move(i, position(i).x() + nudge(rng), position(i).y() + nudge(rng)));
+            else if (kind == 1)
+                edits.push_back(SiteEdit::move(i, x(rng), y(rng)));
+            else if (kind == 2)
+                edits.push_back(SiteEdit::add(x(rng), y(rng)));
+            else
+                edits.push_back(SiteEdit::remove(i));
+        }
+        tiling.apply(edits);
+        check.expect(sameAsRebuild(tiling), format("edit %s: %zu edits of round %d as a rebuild", name.c_str(),
+                                                   edits.size(), round));
+    }
+
+    // a hole of adjacent removed sites gives its area to the ring around it
+    std::vector<SiteEdit> hole;
+    for (size_t i : liveSites(tiling)) {
+        const CellVertex p = position(i);
+        if (std::hypot(p.x() - 0.5 * c.w, p.y() - 0.5 * c.h) < 60.0)
+            hole.push_back(SiteEdit::remove(i));
+    }
+    tiling.apply(hole);
+    check.expect(sameAsRebuild(tiling), format("edit %s: %zu adjacent removals as a rebuild", name.c_str(),
+                                               hole.size()));
+
+    // down to the diagrams without a vertex
+    for (size_t left : {size_t(2), size_t(1)}) {
+        std::vector<size_t> live = liveSites(tiling);
+        std::vector<SiteEdit> edits;
+        for (size_t j = left; j < live.size(); ++j)
+            edits.push_back(SiteEdit::remove(live[j]));
+        tiling.apply(edits);
+        check.expect(sameAsRebuild(tiling), format("edit %s: down to %zu sites as a rebuild", name.c_str(), left));
+    }
+}
+
+} // namespace test
+} // namespace vt
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "check.h"
+
+namespace {
+
+void usage(const char *prog) {
+    std::fprintf(stderr,
+        "usage: %s [options]\n"
+        "\n"
+        "runs the optimized paths next to their references on fixed seeds, then\n"
+        "times them, exits with 1 on a mismatch or a slowdown\n"
+        "\n"
+        "options:\n"
+        "  -j, --jobs <n>        threads the paths are timed with, every core by default\n"
+        "  -q, --quiet           only report failures\n"
+        "      --baseline <file> also fails when a path runs slower than in the\n"
+        "                        throughputs of file\n"
+        "      --max-slowdown <percent>\n"
+        "                        slowdown allowed below the baseline, 15 by default\n"
+        "      --save-baseline <file>\n"
+        "                        writes the throughputs measured to file\n"
+        "\n"
+        "make check passes its options in TESTARGS\n",
+        prog);
+}
+
+bool parseInt(const char *s, long long min, long long max, long long &out) {
+    char *end = nullptr;
+    const long long v = std::strtoll(s, &end, 10);
+    if (!*s || *end || v < min || v > max)
+        return false;
+    out = v;
+    return true;
+}
+
+bool parseDouble(const char *s, double min, double max, double &out) {
+    char *end = nullptr;
+    const double v = std::strtod(s, &end);
+    if (!*s || *end || !(v >= min && v <= max))
+        return false;
+    out = v;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bool quiet = false;
+    unsigned threads = 0;
+    vt::test::PerfSettings perf;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        long long v;
+
+        if ((arg == "-j" || arg == "--jobs") && i + 1 < argc && parseInt(argv[i + 1], 1, 4096, v)) {
+            threads = unsigned(v);
+            ++i;
+        }
+        else if (arg == "-q" || arg == "--quiet") {
+            quiet = true;
+        }
+        else if (arg == "--baseline" && i + 1 < argc) {
+            perf.baseline = argv[++i];
+        }
+        else if (arg == "--save-baseline" && i + 1 < argc) {
+            perf.saveBaseline = argv[++i];
+        }
+        else if (arg == "--max-slowdown" && i + 1 < argc &&
+                 parseDouble(argv[i + 1], 0.0, 100.0, perf.maxSlowdown)) {
+            ++i;
+        }
+        else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    vt::test::Checker check(quiet);
+
+    // the parallel paths split their work by the pool size, a few threads
+    // make them partition even on a single core and the inline pool gives
+    // the other extreme
+    const unsigned workers = threads ? threads - 1 : std::max(std::thread::hardware_concurrency(), 1u) - 1;
+    vt::ThreadPool pool(workers);
+    vt::ThreadPool wide(std::max(pool.concurrency(), 4u) - 1);
+    vt::ThreadPool inline_pool(0);
+
+    vt::test::checkSampling(check, wide, inline_pool);
+    vt::test::checkVoronoi(check, wide, inline_pool);
+    vt::test::checkEditing(check, wide, inline_pool);
+    vt::test::checkChunkedWorld(check, wide, inline_pool);
+    vt::test::checkRelaxation(check, wide, inline_pool);
+    vt::test::checkTileFormat(check, wide, inline_pool);
+    vt::test::checkTileCache(check, wide, inline_pool);
+    vt::test::checkRaster(check, wide, inline_pool);
+    vt::test::checkRegions(check, wide, inline_pool);
+    vt::test::checkThroughput(check, perf, pool);
+
+    if (check.failed())
+        std::printf("%d checks failed\n", check.failed());
+    return check.failed() ? 1 : 0;
+}
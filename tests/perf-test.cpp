@@ -0,0 +1,134 @@
+#include "check.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "poisson-grid.h"
+
+namespace vt {
+namespace test {
+
+namespace {
+
+/// tile timed against the baseline
+const Case PERF_CASE = {2000, 2000, 400000, 1, WRAP_NONE};
+const int PERF_REPEATS = 5;
+
+/// best wall time of a few runs of fn, in seconds
+template <typename F>
+double bestTime(F fn) {
+    double best = HUGE_VAL;
+    for (int i = 0; i < PERF_REPEATS; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+/// sites per second of every path on PERF_CASE
+std::vector<std::pair<std::string, double>> measure(ThreadPool &pool) {
+    const Case &c = PERF_CASE;
+    std::vector<std::pair<std::string, double>> rates;
+    size_t sites = 0;
+    auto rate = [&](const char *name, double seconds) {
+        rates.emplace_back(name, double(sites) / seconds);
+    };
+
+    PoissonGenerator::sContext sampler;
+    auto sample = [&](unsigned threads, bool batched) {
+        PoissonGenerator::sSettings settings;
+        settings.Circle = false;
+        settings.Threads = threads;
+        settings.Pool = &pool;
+        settings.Batched = batched;
+        return bestTime([&] {
+            PoissonGenerator::DefaultPRNG prng(c.seed);
+            sites = PoissonGenerator::GeneratePoissonPoints(c.num, prng, settings,
+                                                            PoissonGenerator::sRectangleDomain(), sampler).size();
+        });
+    };
+    rate("sample.scalar", sample(1, false));
+    rate("sample.sequential", sample(1, true));
+    rate("sample.tiled", sample(0, true));
+
+    const Grid g = generateGrid(c.w, c.h, c.num, c.seed);
+    sites = g.size();
+    rate("voronoi.serial", bestTime([&] { computeVoronoiSerial(g, c.w, c.h); }));
+    rate("voronoi.blocked", bestTime([&] { computeVoronoiBlocked(g, c.w, c.h, pool); }));
+    rate("voronoi.partitioned", bestTime([&] { computeVoronoiPartitioned(g, c.w, c.h, pool); }));
+
+    const Grid wrapped = generateWrappedGrid(c.w, c.h, c.num, c.seed, WRAP_XY);
+    sites = wrapped.size();
+    rate("voronoi.wrapped", bestTime([&] { computeVoronoiWrapped(wrapped, c.w, c.h, WRAP_XY, pool); }));
+
+    TilingContext context(pool);
+    sites = g.size();
+    rate("pipeline.context", bestTime([&] {
+        context.computeVoronoi(context.generateGrid(c.w, c.h, c.num, c.seed), c.w, c.h);
+    }));
+
+    return rates;
+}
+
+bool readBaseline(const char *path, std::map<std::string, double> &baseline) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        double rate;
+        if (fields >> name && name[0] != '#' && fields >> rate)
+            baseline[name] = rate;
+    }
+    return true;
+}
+
+bool writeBaseline(const char *path, const std::vector<std::pair<std::string, double>> &rates) {
+    std::FILE *f = std::fopen(path, "w");
+    if (!f)
+        return false;
+
+    const Case &c = PERF_CASE;
+    std::fprintf(f, "# voronoi_tiling %s, sites per second on %dx%d n=%d\n", PoissonGenerator::Version, c.w, c.h,
+                 c.num);
+    for (const auto &r : rates)
+        std::fprintf(f, "%s %.6g\n", r.first.c_str(), r.second);
+    return std::fclose(f) == 0;
+}
+
+} // namespace
+
+void checkThroughput(Checker &check, const PerfSettings &settings, ThreadPool &pool) {
+    std::map<std::string, double> baseline;
+    if (settings.baseline && !readBaseline(settings.baseline, baseline))
+        check.expect(false, format("cannot read baseline %s", settings.baseline));
+
+    const auto rates = measure(pool);
+    const double floor = 1.0 - settings.maxSlowdown / 100.0;
+    for (const auto &r : rates) {
+        const auto base = baseline.find(r.first);
+        if (base == baseline.end()) {
+            if (!check.quiet())
+                std::printf("     %s: %.4g sites/s\n", r.first.c_str(), r.second);
+            continue;
+        }
+        check.expect(r.second >= floor * base->second,
+                     format("%s: %.4g sites/s, %+.1f%% from baseline", r.first.c_str(), r.second,
+                            100.0 * (r.second / base->second - 1.0)));
+    }
+
+    if (settings.saveBaseline && !writeBaseline(settings.saveBaseline, rates))
+        check.expect(false, format("cannot write baseline %s", settings.saveBaseline));
+}
+
+} // namespace test
+} // namespace vt
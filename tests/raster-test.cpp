@@ -0,0 +1,89 @@
+#include "check.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "cell-raster.h"
+
+namespace vt {
+namespace test {
+
+namespace {
+
+/// small enough for a brute force nearest site lookup at every pixel,
+/// rasterized at 1.5 pixels per tile unit
+const Case RASTERIZED[] = {
+    {240, 160, 1000, 21, WRAP_NONE},
+    {240, 160, 1000, 22, WRAP_XY},
+};
+
+/// distance along a wrapped axis of period p is the shorter way round
+double axisDistance(double a, double b, double p, bool wrapped) {
+    const double d = std::fabs(a - b);
+    return wrapped ? std::min(d, p - d) : d;
+}
+
+/**
+ * Pixels of raster holding another cell than the nearest site of their
+ * centre, ties within tolerance going either way, and pixels holding none.
+ */
+void countMisses(const CellRaster &raster, const std::vector<CellVertex> &sites, const Case &c, double tolerance,
+                 size_t &wrong, size_t &empty) {
+    const bool wrap_x = (c.wrap & WRAP_X) != 0, wrap_y = (c.wrap & WRAP_Y) != 0;
+    auto distance = [&](const CellVertex &p, double x, double y) {
+        return std::hypot(axisDistance(p.x(), x, c.w, wrap_x), axisDistance(p.y(), y, c.h, wrap_y));
+    };
+
+    wrong = empty = 0;
+    for (int py = 0; py < raster.height; ++py) {
+        const double y = (py + 0.5) * c.h / raster.height;
+        for (int px = 0; px < raster.width; ++px) {
+            const double x = (px + 0.5) * c.w / raster.width;
+            const uint32_t id = raster.at(px, py);
+            if (id == NO_CELL || id >= sites.size()) {
+                ++empty;
+                continue;
+            }
+
+            double nearest = HUGE_VAL;
+            for (const CellVertex &s : sites)
+                nearest = std::min(nearest, distance(s, x, y));
+            if (distance(sites[id], x, y) > nearest + tolerance)
+                ++wrong;
+        }
+    }
+}
+
+} // namespace
+
+void checkRaster(Checker &check, ThreadPool &wide, ThreadPool &inline_pool) {
+    for (const Case &c : RASTERIZED) {
+        const std::string name = caseName(c);
+        const Grid g = c.wrap == WRAP_NONE ? generateGrid(c.w, c.h, c.num, c.seed)
+                                           : generateWrappedGrid(c.w, c.h, c.num, c.seed, c.wrap);
+        const CellStore cells = c.wrap == WRAP_NONE ? computeVoronoi(g, c.w, c.h, wide)
+                                                    : computeVoronoiWrapped(g, c.w, c.h, c.wrap, wide);
+        const std::vector<CellVertex> sites = siteCoordinates(g, c.w, c.h);
+        const int width = c.w * 3 / 2, height = c.h * 3 / 2;
+
+        CellRaster raster;
+        const struct {
+            const char *name;
+            ThreadPool &pool;
+        } pools[] = {{"wide", wide}, {"inline", inline_pool}};
+        for (const auto &p : pools) {
+            rasterizeCells(cells, c.w, c.h, width, height, raster, p.pool, c.wrap);
+            size_t wrong = 0, empty = 0;
+            const bool sized = raster.width == width && raster.height == height &&
+                               raster.ids.size() == size_t(width) * height;
+            if (sized)
+                countMisses(raster, sites, c, REFERENCE_TOLERANCE * std::max(c.w, c.h), wrong, empty);
+            check.expect(sized && !wrong && !empty,
+                         format("raster %s: %dx%d pixels on the %s pool, %zu not in the nearest cell, %zu empty",
+                                name.c_str(), width, height, p.name, wrong, empty));
+        }
+    }
+}
+
+} // namespace test
+} // namespace vt
@@ -0,0 +1,109 @@
+#include "check.h"
+
+#include <cmath>
+
+#include "regions.h"
+
+namespace vt {
+namespace test {
+
+namespace {
+
+/// regions asked of CASES[0], a plain tile, and CASES[2], wrapped along x and y
+const struct {
+    size_t index;
+    int k;
+} CLUSTERED[] = {
+    {0, 40},
+    {2, 12},
+};
+
+/// cells of a region reached through neighbours in the same region, from
+/// its first cell: every cell of every region when they are connected
+size_t reachable(const Regions &regions, const Adjacency &adjacency) {
+    const std::vector<uint32_t> &labels = regions.labels;
+    std::vector<bool> seen(labels.size(), false), started(regions.size(), false);
+    std::vector<uint32_t> stack;
+    size_t count = 0;
+
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (labels[i] == NO_CELL || started[labels[i]])
+            continue;
+        started[labels[i]] = true;
+        seen[i] = true;
+        stack.assign(1, uint32_t(i));
+        while (!stack.empty()) {
+            const uint32_t cell = stack.back();
+            stack.pop_back();
+            ++count;
+            for (uint32_t n : adjacency[cell]) {
+                if (n < labels.size() && !seen[n] && labels[n] == labels[cell]) {
+                    seen[n] = true;
+                    stack.push_back(n);
+                }
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+void checkRegions(Checker &check, ThreadPool &wide, ThreadPool &inline_pool) {
+    for (const auto &r : CLUSTERED) {
+        const Case &c = CASES[r.index];
+        const std::string name = caseName(c);
+        const double tile = double(c.w) * c.h;
+        const Grid g = c.wrap == WRAP_NONE ? generateGrid(c.w, c.h, c.num, c.seed)
+                                           : generateWrappedGrid(c.w, c.h, c.num, c.seed, c.wrap);
+        const std::vector<CellVertex> sites = siteCoordinates(g, c.w, c.h);
+
+        Adjacency adjacency;
+        std::vector<uint32_t> edges;
+        const CellStore cells = c.wrap == WRAP_NONE
+            ? computeVoronoi(g, c.w, c.h, wide, &adjacency, &edges)
+            : computeVoronoiWrapped(g, c.w, c.h, c.wrap, wide, &adjacency, &edges);
+        const Regions regions = clusterCells(sites, cells, adjacency, edges, c.w, c.h, r.k, c.seed, wide, c.wrap);
+
+        size_t labelled = 0;
+        bool labels_valid = regions.labels.size() == cells.size() && !regions.empty();
+        for (size_t i = 0; labels_valid && i < cells.size(); ++i) {
+            labels_valid = cells[i].empty() ? regions.labels[i] == NO_CELL : regions.labels[i] < regions.size();
+            labelled += !cells[i].empty();
+        }
+        check.expect(labels_valid, format("regions %s: %zu regions over %zu cells", name.c_str(), regions.size(),
+                                          labelled));
+
+        const size_t connected = labels_valid ? reachable(regions, adjacency) : 0;
+        check.expect(labels_valid && connected == labelled,
+                     format("regions %s: %zu of %zu cells connected to their region", name.c_str(), connected,
+                            labelled));
+
+        // outer rings count positive and holes negative, together the tile
+        double total = 0.0;
+        std::vector<double> cell_areas(regions.size(), 0.0);
+        bool regions_match = labels_valid && regions.ringOffsets.back() == regions.outlines.size();
+        for (size_t i = 0; regions_match && i < cells.size(); ++i)
+            if (regions.labels[i] != NO_CELL)
+                cell_areas[regions.labels[i]] += area(cells[i]);
+        for (size_t k = 0; regions_match && k < regions.size(); ++k) {
+            double outlined = 0.0;
+            for (uint32_t ring = regions.ringOffsets[k]; ring < regions.ringOffsets[k + 1]; ++ring)
+                outlined += area(regions.outlines[ring]);
+            total += outlined;
+            regions_match = std::fabs(outlined - cell_areas[k]) <= AREA_TOLERANCE * tile;
+        }
+        check.expect(regions_match && std::fabs(total - tile) <= AREA_TOLERANCE * tile,
+                     format("regions %s: outlines of area %.12g of %.12g, each that of its cells", name.c_str(),
+                            total, tile));
+
+        const Regions inline_regions = clusterCells(sites, cells, adjacency, edges, c.w, c.h, r.k, c.seed,
+                                                    inline_pool, c.wrap);
+        check.expect(inline_regions.labels == regions.labels && inline_regions.ringOffsets == regions.ringOffsets &&
+                     sameCells(inline_regions.outlines, regions.outlines, 0.0),
+                     format("regions %s: same regions on any pool", name.c_str()));
+    }
+}
+
+} // namespace test
+} // namespace vt
@@ -0,0 +1,84 @@
+#include "check.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "relaxation.h"
+
+namespace vt {
+namespace test {
+
+namespace {
+
+const Case RELAXED = {500, 400, 3000, 3, WRAP_NONE};
+const int ITERATIONS = 5;
+/// largest shift in tile units stopping the relaxation, a few dozen
+/// iterations on RELAXED
+const double CONVERGED = 0.2;
+
+/// Lloyd step done the plain way: sites moved to the centroids of their
+/// freshly built cells
+Grid lloydStep(const Grid &g, int w, int h) {
+    const GridQuantizer quant(w, h);
+    const CellStore cells = computeVoronoiSerial(g, w, h);
+    Grid moved(g);
+    for (size_t i = 0; i < g.size(); ++i) {
+        const CellVertex c = centroid(cells[i]);
+        moved[i] = Site(quant.toInt(std::min(std::max(c.x(), 0.0), double(w))),
+                        quant.toInt(std::min(std::max(c.y(), 0.0), double(h))));
+    }
+    return moved;
+}
+
+/// standard deviation of the cell areas over their mean
+double areaSpread(const CellStore &cells) {
+    double sum = 0.0, squares = 0.0;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        const double a = area(cells[i]);
+        sum += a;
+        squares += a * a;
+    }
+    const double mean = sum / cells.size();
+    return std::sqrt(std::max(squares / cells.size() - mean * mean, 0.0)) / mean;
+}
+
+} // namespace
+
+void checkRelaxation(Checker &check, ThreadPool &wide, ThreadPool &inline_pool) {
+    const Case &c = RELAXED;
+    const std::string name = caseName(c);
+    const double tolerance = VERTEX_TOLERANCE * std::max(c.w, c.h);
+    const Grid initial = generateGrid(c.w, c.h, c.num, c.seed);
+
+    Relaxation relaxation(c.w, c.h, wide);
+    Grid step(initial);
+    relaxation.relax(step, 1);
+    check.expect(step == lloydStep(initial, c.w, c.h), format("relax %s: sites at the centroids of their cells",
+                                                              name.c_str()));
+
+    Grid sites(initial);
+    const int done = relaxation.relax(sites, ITERATIONS);
+    double total;
+    const bool covered = coversArea(relaxation.cells(), sites.size(), double(c.w) * c.h, total);
+    check.expect(done == ITERATIONS && covered &&
+                 sameCells(computeVoronoiSerial(sites, c.w, c.h), relaxation.cells(), tolerance),
+                 format("relax %s: %d iterations, cells of the relaxed sites", name.c_str(), done));
+
+    const double before = areaSpread(computeVoronoiSerial(initial, c.w, c.h));
+    const double after = areaSpread(relaxation.cells());
+    check.expect(after < before, format("relax %s: area spread from %.4g to %.4g", name.c_str(), before, after));
+
+    Relaxation inline_relaxation(c.w, c.h, inline_pool);
+    Grid inline_sites(initial);
+    inline_relaxation.relax(inline_sites, ITERATIONS);
+    check.expect(inline_sites == sites, format("relax %s: same sites on any pool", name.c_str()));
+
+    Grid converged(initial);
+    const int needed = relaxation.relax(converged, 1000, CONVERGED);
+    check.expect(needed < 1000 && relaxation.lastShift() <= CONVERGED,
+                 format("relax %s: shift %.4g after %d iterations, stopping at %g", name.c_str(),
+                        relaxation.lastShift(), needed, CONVERGED));
+}
+
+} // namespace test
+} // namespace vt
@@ -0,0 +1,88 @@
+#include "check.h"
+
+#include <algorithm>
+
+#include "poisson-grid.h"
+
+namespace vt {
+namespace test {
+
+namespace {
+
+using Points = std::vector<PoissonGenerator::sPoint>;
+
+/// relative difference allowed between the point counts of the two samplers,
+/// and one point either way: the sequential one stops at num, which only
+/// matters on tiny tiles, the tiled one fills the square
+const double COUNT_TOLERANCE = 0.02;
+
+PoissonGenerator::sSettings samplerSettings(const Case &c, unsigned threads, ThreadPool *pool, bool batched) {
+    PoissonGenerator::sSettings settings;
+    settings.Circle = false;
+    settings.Threads = threads;
+    settings.Pool = pool;
+    settings.WrapX = (c.wrap & WRAP_X) != 0;
+    settings.WrapY = (c.wrap & WRAP_Y) != 0;
+    settings.Batched = batched;
+    return settings;
+}
+
+Points samplePoints(const Case &c, unsigned threads, ThreadPool *pool, bool batched = true) {
+    PoissonGenerator::DefaultPRNG prng(c.seed);
+    return PoissonGenerator::GeneratePoissonPoints(c.num, prng, samplerSettings(c, threads, pool, batched));
+}
+
+bool samePoints(const Points &a, const Points &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y)
+            return false;
+    }
+    return true;
+}
+
+std::vector<CellVertex> vertices(const Points &points) {
+    std::vector<CellVertex> out;
+    out.reserve(points.size());
+    for (const auto &p : points)
+        out.emplace_back(p.x, p.y);
+    return out;
+}
+
+} // namespace
+
+void checkSampling(Checker &check, ThreadPool &wide, ThreadPool &inline_pool) {
+    for (const Case &c : CASES) {
+        const std::string name = caseName(c);
+        const Points reference = samplePoints(c, 1, nullptr, false);
+        const Points tiled = samplePoints(c, 0, &wide);
+
+        // the candidate batches against the scalar reference, the same
+        // points bit for bit, in both samplers
+        check.expect(samePoints(reference, samplePoints(c, 1, nullptr)) &&
+                     samePoints(tiled, samplePoints(c, 0, &wide, false)),
+                     format("sample %s: batched candidates as scalar ones", name.c_str()));
+
+        const size_t most = std::max(reference.size(), tiled.size());
+        const size_t diff = most - std::min(reference.size(), tiled.size());
+        check.expect(diff <= std::max(COUNT_TOLERANCE * most, 1.0),
+                     format("sample %s: %zu sequential, %zu tiled points", name.c_str(), reference.size(),
+                            tiled.size()));
+
+        const double min_dist = PoissonGenerator::MinDistFor(c.num, samplerSettings(c, 1, nullptr, true));
+        const double limit = min_dist * (1.0 - DISTANCE_SLACK);
+        const double closest_reference = closestPair(vertices(reference), 1.0, 1.0, min_dist, c.wrap);
+        const double closest_tiled = closestPair(vertices(tiled), 1.0, 1.0, min_dist, c.wrap);
+        check.expect(closest_reference >= limit && closest_tiled >= limit,
+                     format("sample %s: closest pairs %.6g and %.6g, min distance %.6g", name.c_str(),
+                            closest_reference, closest_tiled, min_dist));
+
+        check.expect(samePoints(reference, samplePoints(c, 1, nullptr, false)) &&
+                     samePoints(tiled, samplePoints(c, 0, &inline_pool)),
+                     format("sample %s: same points from the same seed on any pool", name.c_str()));
+    }
+}
+
+} // namespace test
+} // namespace vt
@@ -0,0 +1,26 @@
+include(../common.pri)
+include(../core/core.pri)
+
+TEMPLATE = app
+TARGET = vt_tests
+
+# make check runs the suite, with the options in TESTARGS
+CONFIG += console testcase
+CONFIG -= qt app_bundle
+
+SOURCES += \
+        check.cpp \
+        editing-test.cpp \
+        main.cpp \
+        perf-test.cpp \
+        raster-test.cpp \
+        regions-test.cpp \
+        relaxation-test.cpp \
+        sampling-test.cpp \
+        tile-cache-test.cpp \
+        tile-format-test.cpp \
+        voronoi-test.cpp \
+        world-test.cpp
+
+HEADERS += \
+        check.h
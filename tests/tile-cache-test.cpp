@@ -0,0 +1,154 @@
+#include "check.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+
+#include "tile-cache.h"
+#include "tile-format.h"
+
+namespace vt {
+namespace test {
+
+namespace {
+
+const Case CACHED = {200, 150, 300, 11, WRAP_NONE};
+
+/// key of the i-th tile of c, seeds counted from the one of c
+TileKey keyOf(const Case &c, uint32_t i) {
+    return tileKey(c.w, c.h, c.num, c.seed + i);
+}
+
+/// the bytes TileCache keeps for the i-th tile of c
+TileCache::Tile encoded(const Case &c, uint32_t i, ThreadPool &pool) {
+    const Grid g = generateGrid(c.w, c.h, c.num, c.seed + i);
+    auto bytes = std::make_shared<std::string>();
+    encodeTile(c.w, c.h, siteCoordinates(g, c.w, c.h), computeVoronoi(g, c.w, c.h, pool), nullptr, nullptr, *bytes);
+    return bytes;
+}
+
+/// where a cache in dir keeps the tile of key
+std::string cachePath(const TemporaryDirectory &dir, const TileKey &key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016" PRIx64 ".vttile", hashKey(key));
+    return dir.file(name);
+}
+
+bool writeBytes(const std::string &path, const std::string &bytes) {
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    const bool written = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    return std::fclose(f) == 0 && written;
+}
+
+bool sameTile(const TileCache::Tile &a, const TileCache::Tile &b) {
+    return a && b && *a == *b;
+}
+
+void checkMemory(Checker &check, const TileCache::Tile tiles[3]) {
+    const Case &c = CACHED;
+    const std::string name = caseName(c);
+
+    // room for any two of the tiles, not for the three
+    TileCache cache(tiles[0]->size() + tiles[1]->size() + tiles[2]->size() - 1);
+    cache.insert(keyOf(c, 0), tiles[0]);
+    cache.insert(keyOf(c, 1), tiles[1]);
+    const bool hit = sameTile(cache.find(keyOf(c, 0)), tiles[0]);
+    TileCacheStats s = cache.stats();
+    check.expect(hit && s.memoryHits == 1 && s.misses == 0 && s.insertions == 2 &&
+                 s.memoryBytes == tiles[0]->size() + tiles[1]->size(),
+                 format("cache %s: memory hit, %zu bytes held", name.c_str(), s.memoryBytes));
+
+    // the tile found last stays, the one left alone goes
+    cache.insert(keyOf(c, 2), tiles[2]);
+    const bool kept = sameTile(cache.find(keyOf(c, 0)), tiles[0]) && sameTile(cache.find(keyOf(c, 2)), tiles[2]);
+    const bool evicted = !cache.find(keyOf(c, 1));
+    s = cache.stats();
+    check.expect(kept && evicted && s.evictions == 1 && s.misses == 1 &&
+                 s.memoryBytes == tiles[0]->size() + tiles[2]->size(),
+                 format("cache %s: least recently used tile evicted, %d evictions", name.c_str(), int(s.evictions)));
+
+    const bool missing = !cache.find(keyOf(c, 3));
+    check.expect(missing && cache.stats().misses == 2, format("cache %s: unknown key missed", name.c_str()));
+}
+
+void checkDisk(Checker &check, const TileCache::Tile tiles[3]) {
+    const Case &c = CACHED;
+    const std::string name = caseName(c);
+    TemporaryDirectory dir;
+
+    // too large for the memory budget, only the disk keeps it
+    TileCache cache(tiles[0]->size() - 1, dir.path());
+    cache.insert(keyOf(c, 0), tiles[0]);
+    std::string written;
+    const bool on_disk = readFile(cachePath(dir, keyOf(c, 0)), written) && written == *tiles[0];
+    check.expect(on_disk && cache.stats().memoryBytes == 0,
+                 format("cache %s: tile over budget written to %s only", name.c_str(), dir.path().c_str()));
+
+    const bool hit = sameTile(cache.find(keyOf(c, 0)), tiles[0]);
+    TileCacheStats s = cache.stats();
+    check.expect(hit && s.diskHits == 1 && s.memoryHits == 0 && s.memoryBytes == 0,
+                 format("cache %s: tile over budget found on disk", name.c_str()));
+
+    // another process on the same directory
+    TileCache other(TileCache::DEFAULT_MEMORY_BUDGET, dir.path());
+    const TileCache::Tile shared = other.find(keyOf(c, 0));
+    const bool again = sameTile(other.find(keyOf(c, 0)), tiles[0]);
+    s = other.stats();
+    Grid sites;
+    CellStore cells;
+    const bool decoded = shared && decodeTile(*shared, sites, cells);
+    check.expect(sameTile(shared, tiles[0]) && again && s.diskHits == 1 && s.memoryHits == 1 && decoded &&
+                 sites == generateGrid(c.w, c.h, c.num, c.seed),
+                 format("cache %s: second cache served from disk, then from memory", name.c_str()));
+
+    // invalid files are misses, never tiles
+    const std::string truncated = tiles[1]->substr(0, tiles[1]->size() / 2);
+    std::string corrupted = *tiles[2];
+    corrupted[0] = 'X';
+    const bool planted = writeBytes(cachePath(dir, keyOf(c, 1)), truncated) &&
+                         writeBytes(cachePath(dir, keyOf(c, 2)), corrupted) &&
+                         writeBytes(cachePath(dir, keyOf(c, 3)), "not a tile");
+    const bool missed = !other.find(keyOf(c, 1)) && !other.find(keyOf(c, 2)) && !other.find(keyOf(c, 3));
+    s = other.stats();
+    check.expect(planted && missed && s.misses == 3 && s.diskHits == 1,
+                 format("cache %s: invalid tile files missed, %d misses", name.c_str(), int(s.misses)));
+}
+
+void checkKeys(Checker &check) {
+    const Case &c = CACHED;
+    const uint64_t base = hashKey(tileKey(c.w, c.h, c.num, c.seed));
+    check.expect(hashKey(tileKey(c.w, c.h, c.num, c.seed, 0, false, WRAP_NONE, 0)) == base,
+                 format("cache %s: key of the same tile hashed alike", caseName(c).c_str()));
+
+    const struct {
+        const char *what;
+        TileKey key;
+    } variants[] = {
+        {"size", tileKey(c.w + 1, c.h, c.num, c.seed)},
+        {"sites", tileKey(c.w, c.h, c.num + 1, c.seed)},
+        {"seed", tileKey(c.w, c.h, c.num, c.seed + 1)},
+        {"iterations", tileKey(c.w, c.h, c.num, c.seed, 1)},
+        {"adjacency", tileKey(c.w, c.h, c.num, c.seed, 0, true)},
+        {"wrap x", tileKey(c.w, c.h, c.num, c.seed, 0, false, WRAP_X)},
+        {"wrap y", tileKey(c.w, c.h, c.num, c.seed, 0, false, WRAP_Y)},
+        {"regions", tileKey(c.w, c.h, c.num, c.seed, 0, false, WRAP_NONE, 8)},
+    };
+    for (const auto &v : variants)
+        check.expect(hashKey(v.key) != base, format("cache %s: key changes with the %s", caseName(c).c_str(),
+                                                    v.what));
+}
+
+} // namespace
+
+void checkTileCache(Checker &check, ThreadPool &wide, ThreadPool &inline_pool) {
+    const TileCache::Tile tiles[3] = {encoded(CACHED, 0, wide), encoded(CACHED, 1, inline_pool),
+                                      encoded(CACHED, 2, wide)};
+    checkMemory(check, tiles);
+    checkDisk(check, tiles);
+    checkKeys(check);
+}
+
+} // namespace test
+} // namespace vt
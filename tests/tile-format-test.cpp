@@ -0,0 +1,217 @@
+#include "check.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+#include "regions.h"
+#include "tile-format.h"
+
+namespace vt {
+namespace test {
+
+namespace {
+
+const Case TILE = {300, 200, 800, 5, WRAP_NONE};
+const int REGIONS = 12;
+/// bytes version 2 appended to the header
+const size_t V1_HEADER_SIZE = offsetof(TileFileHeader, regionCount);
+const size_t V2_FIELDS = sizeof(TileFileHeader) - V1_HEADER_SIZE;
+
+/// tile bytes copied to 8 byte aligned storage, a word to spare past them
+class Aligned {
+public:
+    explicit Aligned(const std::string &bytes) : m_size(bytes.size()), m_words(bytes.size() / 8 + 2, 0) {
+        std::memcpy(m_words.data(), bytes.data(), bytes.size());
+    }
+
+    unsigned char *data() { return reinterpret_cast<unsigned char *>(m_words.data()); }
+    size_t size() const { return m_size; }
+    TileFileHeader &header() { return *reinterpret_cast<TileFileHeader *>(data()); }
+    uint32_t &word(uint64_t offset, uint64_t i) { return reinterpret_cast<uint32_t *>(data() + offset)[i]; }
+
+private:
+    size_t m_size;
+    std::vector<uint64_t> m_words;
+};
+
+bool sameView(CellView a, CellView b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (a[i].x() != b[i].x() || a[i].y() != b[i].y())
+            return false;
+    return true;
+}
+
+bool sameTile(const TileFile &file, const std::vector<CellVertex> &sites, const CellStore &cells,
+              const Adjacency *adjacency, const Regions *regions) {
+    if (file.width() != TILE.w || file.height() != TILE.h || file.siteCount() != sites.size() ||
+        file.cellCount() != cells.size() || file.hasAdjacency() != (adjacency != nullptr) ||
+        file.regionCount() != (regions ? regions->size() : 0))
+        return false;
+
+    for (size_t i = 0; i < cells.size(); ++i) {
+        if (file.sites()[i].x() != sites[i].x() || file.sites()[i].y() != sites[i].y() ||
+            !sameView(file.cell(i), cells[i]))
+            return false;
+        if (adjacency) {
+            const NeighbourView a = file.neighbours(i), b = (*adjacency)[i];
+            if (a.size() != b.size() || !std::equal(a.begin(), a.end(), b.begin()))
+                return false;
+        }
+        if (regions && file.regionOf(i) != regions->labels[i])
+            return false;
+    }
+
+    if (regions) {
+        if (file.outlineCount() != regions->outlines.size())
+            return false;
+        for (size_t r = 0; r < regions->size(); ++r)
+            if (file.ringsBegin(r) != regions->ringOffsets[r] || file.ringsEnd(r) != regions->ringOffsets[r + 1])
+                return false;
+        for (size_t ring = 0; ring < regions->outlines.size(); ++ring)
+            if (!sameView(file.outline(ring), regions->outlines[ring]))
+                return false;
+    }
+    return true;
+}
+
+/**
+ * The same tile as written by a version 1 writer: the header stops where
+ * the version 2 fields begin and every section moves down with it.
+ */
+std::string versionOne(const std::string &v2) {
+    TileFileHeader h;
+    std::memcpy(&h, v2.data(), sizeof(h));
+    h.version = 1;
+    h.headerSize = uint32_t(V1_HEADER_SIZE);
+    h.fileSize -= V2_FIELDS;
+    for (uint64_t *offset : {&h.sitesOffset, &h.cellOffsetsOffset, &h.verticesOffset, &h.adjacencyOffsetsOffset,
+                             &h.neighboursOffset})
+        if (*offset)
+            *offset -= V2_FIELDS;
+
+    std::string v1(reinterpret_cast<const char *>(&h), V1_HEADER_SIZE);
+    v1.append(v2, sizeof(TileFileHeader), std::string::npos);
+    return v1;
+}
+
+/// view() of the damaged bytes fails and says why
+void expectRejected(Checker &check, const std::string &bytes, const char *what, const char *problem,
+                    const std::function<void(Aligned &)> &damage, size_t size = 0, size_t shift = 0) {
+    Aligned buffer(bytes);
+    damage(buffer);
+
+    TileFile file;
+    std::string error;
+    const bool ok = file.view(buffer.data() + shift, size ? size : buffer.size(), &error);
+    check.expect(!ok && !file.isOpen() && error.find(problem) != std::string::npos,
+                 format("tile format %s: %s rejected, \"%s\"", caseName(TILE).c_str(), what, error.c_str()));
+}
+
+} // namespace
+
+void checkTileFormat(Checker &check, ThreadPool &wide, ThreadPool &inline_pool) {
+    const Case &c = TILE;
+    const std::string name = caseName(c);
+    const Grid g = generateGrid(c.w, c.h, c.num, c.seed);
+    const std::vector<CellVertex> sites = siteCoordinates(g, c.w, c.h);
+
+    Adjacency adjacency;
+    std::vector<uint32_t> edges;
+    const CellStore cells = computeVoronoi(g, c.w, c.h, wide, &adjacency, &edges);
+    const Regions regions = clusterCells(sites, cells, adjacency, edges, c.w, c.h, REGIONS, c.seed, inline_pool);
+
+    TemporaryDirectory dir;
+    const std::string path = dir.file("tile.vttile");
+    std::string bytes, written, error;
+    const bool encoded = encodeTile(c.w, c.h, sites, cells, &adjacency, &regions, bytes, 0, &error);
+    const bool wrote = writeTileFile(path, c.w, c.h, sites, cells, &adjacency, &regions, 0, &error);
+    check.expect(encoded && wrote && readFile(path, written) && written == bytes,
+                 format("tile format %s: %zu encoded bytes as written to %s %s", name.c_str(), bytes.size(),
+                        path.c_str(), error.c_str()));
+
+    TileFile file;
+    const bool opened = file.open(path, &error);
+    check.expect(opened && file.header().version == TILE_FILE_VERSION &&
+                 sameTile(file, sites, cells, &adjacency, &regions),
+                 format("tile format %s: opened file holds the cells, neighbours and %zu regions %s", name.c_str(),
+                        regions.size(), error.c_str()));
+    file.close();
+
+    Aligned aligned(bytes);
+    const bool viewed = file.view(aligned.data(), aligned.size(), &error);
+    check.expect(viewed && sameTile(file, sites, cells, &adjacency, &regions),
+                 format("tile format %s: viewed bytes hold the same tile %s", name.c_str(), error.c_str()));
+
+    std::string plain;
+    encodeTile(c.w, c.h, sites, cells, nullptr, nullptr, plain);
+    Aligned plain_aligned(plain);
+    const bool plain_viewed = file.view(plain_aligned.data(), plain_aligned.size(), &error);
+    check.expect(plain_viewed && sameTile(file, sites, cells, nullptr, nullptr),
+                 format("tile format %s: no adjacency nor regions when left out %s", name.c_str(), error.c_str()));
+
+    std::string with_adjacency;
+    encodeTile(c.w, c.h, sites, cells, &adjacency, nullptr, with_adjacency);
+    const std::string v1_bytes = versionOne(with_adjacency);
+    Aligned v1(v1_bytes);
+    const bool v1_viewed = file.view(v1.data(), v1.size(), &error);
+    check.expect(v1_viewed && file.header().version == 1 && file.regionCount() == 0 &&
+                 sameTile(file, sites, cells, &adjacency, nullptr),
+                 format("tile format %s: version 1 file read without regions %s", name.c_str(), error.c_str()));
+
+    // every check of view() on a damaged copy
+    expectRejected(check, bytes, "short header", "not a tile file", [](Aligned &) {}, V1_HEADER_SIZE - 8);
+    expectRejected(check, bytes, "misaligned bytes", "not a tile file", [](Aligned &) {}, 0, 4);
+    expectRejected(check, bytes, "bad magic", "not a tile file", [](Aligned &b) { b.header().magic[0] ^= 1; });
+    expectRejected(check, bytes, "swapped bytes", "another byte order",
+                   [](Aligned &b) { b.header().byteOrder = 0x04030201; });
+    expectRejected(check, bytes, "version 3", "unsupported version 3",
+                   [](Aligned &b) { b.header().version = TILE_FILE_VERSION + 1; });
+    expectRejected(check, bytes, "short version 2 header", "unsupported version 2",
+                   [](Aligned &b) { b.header().headerSize = uint32_t(V1_HEADER_SIZE); });
+    expectRejected(check, bytes, "truncated bytes", "truncated", [](Aligned &) {}, bytes.size() - 8);
+    expectRejected(check, bytes, "sites and cells differ", "out of bounds",
+                   [](Aligned &b) { b.header().siteCount -= 1; });
+    expectRejected(check, bytes, "vertices past the end", "out of bounds",
+                   [](Aligned &b) { b.header().verticesOffset = b.header().fileSize; });
+    expectRejected(check, bytes, "misaligned section", "out of bounds",
+                   [](Aligned &b) { b.header().sitesOffset += 4; });
+    expectRejected(check, bytes, "neighbours past the end", "out of bounds",
+                   [](Aligned &b) { b.header().adjacencyCount = b.header().fileSize; });
+    expectRejected(check, bytes, "outlines past the end", "out of bounds",
+                   [](Aligned &b) { b.header().outlineVertexCount = b.header().fileSize; });
+    expectRejected(check, bytes, "cell offsets", "inconsistent cell offsets", [](Aligned &b) {
+        const TileFileHeader &h = b.header();
+        b.word(h.cellOffsetsOffset, h.cellCount) += 1;
+    });
+    expectRejected(check, bytes, "adjacency offsets", "inconsistent adjacency offsets", [](Aligned &b) {
+        const TileFileHeader &h = b.header();
+        b.word(h.adjacencyOffsetsOffset, 0) = 1;
+    });
+    expectRejected(check, bytes, "region offsets", "inconsistent region offsets", [](Aligned &b) {
+        const TileFileHeader &h = b.header();
+        b.word(h.regionOffsetsOffset, h.regionCount) += 1;
+    });
+    expectRejected(check, bytes, "outline offsets", "inconsistent region offsets", [](Aligned &b) {
+        const TileFileHeader &h = b.header();
+        b.word(h.outlineOffsetsOffset, h.outlineCount) -= 1;
+    });
+    expectRejected(check, v1_bytes, "truncated version 1 bytes", "truncated", [](Aligned &) {},
+                   v1_bytes.size() - 8);
+
+    const std::string cut = dir.file("cut.vttile");
+    std::FILE *f = std::fopen(cut.c_str(), "wb");
+    const bool cut_written = f && std::fwrite(bytes.data(), 1, bytes.size() / 2, f) == bytes.size() / 2;
+    if (f)
+        std::fclose(f);
+    const bool cut_opened = file.open(cut, &error);
+    check.expect(cut_written && !cut_opened && !file.isOpen() && error.find("truncated") != std::string::npos,
+                 format("tile format %s: truncated file rejected, \"%s\"", name.c_str(), error.c_str()));
+}
+
+} // namespace test
+} // namespace vt
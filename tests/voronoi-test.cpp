@@ -0,0 +1,123 @@
+#include "check.h"
+
+#include <algorithm>
+
+namespace vt {
+namespace test {
+
+namespace {
+
+/**
+ * Wrapped tiles of a handful of sites, given in tile coordinates: the halo
+ * their construction needs is wider than the int32 quantizer range leaves
+ * around the tile and they go through the 64-bit sites.
+ */
+struct FewSites {
+    int w, h;
+    Wrap wrap;
+    std::vector<CellVertex> sites;
+};
+
+const FewSites FEW_SITES[] = {
+    {10, 6, WRAP_X, {{3.5, 2.25}}},
+    {10, 6, WRAP_Y, {{3.5, 2.25}}},
+    {10, 6, WRAP_XY, {{3.5, 2.25}}},
+    {10, 6, WRAP_X, {{1.0, 1.0}, {6.0, 4.5}}},
+    {10, 6, WRAP_XY, {{1.0, 1.0}, {6.0, 4.5}}},
+    {1000, 800, WRAP_XY, {{10.0, 790.0}, {500.0, 400.0}, {990.0, 20.0}}},
+};
+
+Grid quantize(const std::vector<CellVertex> &points, int w, int h) {
+    const GridQuantizer quant(w, h);
+    Grid g;
+    for (const CellVertex &p : points)
+        g.emplace_back(quant.toInt(p.x()), quant.toInt(p.y()));
+    return g;
+}
+
+void checkTile(Checker &check, const Case &c, ThreadPool &wide, ThreadPool &inline_pool) {
+    const std::string name = caseName(c);
+    const double tolerance = VERTEX_TOLERANCE * std::max(c.w, c.h);
+    const double tile = double(c.w) * c.h;
+    const Grid g = generateGrid(c.w, c.h, c.num, c.seed);
+
+    Adjacency adjacency;
+    std::vector<uint32_t> edges;
+    const CellStore reference = computeVoronoiSerial(g, c.w, c.h, &adjacency, &edges);
+
+    double total;
+    const bool covered = coversArea(reference, g.size(), tile, total);
+    check.expect(covered, format("voronoi %s: %zu cells, area %.12g of %.12g", name.c_str(), reference.size(),
+                                 total, tile));
+
+    check.expect(matchCells(referenceCells(siteCoordinates(g, c.w, c.h), c.w, c.h), reference,
+                            REFERENCE_TOLERANCE * std::max(c.w, c.h)),
+                 format("voronoi %s: serial cells as bisector cut ones", name.c_str()));
+
+    Adjacency blocked_adjacency;
+    std::vector<uint32_t> blocked_edges;
+    const CellStore blocked = computeVoronoiBlocked(g, c.w, c.h, wide, &blocked_adjacency, &blocked_edges);
+    check.expect(sameCells(reference, blocked, tolerance, &edges, &blocked_edges) &&
+                 sameAdjacency(adjacency, blocked_adjacency),
+                 format("voronoi %s: blocked cells as serial ones", name.c_str()));
+
+    Adjacency strip_adjacency;
+    std::vector<uint32_t> strip_edges;
+    const CellStore strips = computeVoronoiPartitioned(g, c.w, c.h, wide, &strip_adjacency, &strip_edges);
+    check.expect(sameCells(reference, strips, tolerance, &edges, &strip_edges) &&
+                 sameAdjacency(adjacency, strip_adjacency),
+                 format("voronoi %s: partitioned cells as serial ones", name.c_str()));
+
+    // reused buffers, the second run on the context sees the first one's
+    TilingContext context(inline_pool);
+    context.generateGrid(c.w, c.h, c.num, c.seed + 1);
+    context.computeVoronoi(context.sites(), c.w, c.h);
+    const Grid &again = context.generateGrid(c.w, c.h, c.num, c.seed);
+    check.expect(again == g && sameCells(reference, context.computeVoronoi(again, c.w, c.h), tolerance),
+                 format("voronoi %s: context sites and cells as fresh ones", name.c_str()));
+}
+
+void checkWrapped(Checker &check, const std::string &name, const Grid &g, int w, int h, Wrap wrap,
+                  ThreadPool &wide, ThreadPool &inline_pool) {
+    const double tile = double(w) * h;
+
+    Adjacency adjacency;
+    std::vector<uint32_t> edges;
+    const CellStore cells = computeVoronoiWrapped(g, w, h, wrap, wide, &adjacency, &edges);
+
+    double total;
+    const bool covered = coversArea(cells, g.size(), tile, total);
+    check.expect(covered, format("voronoi %s: %zu cells, area %.12g of %.12g", name.c_str(), cells.size(), total,
+                                 tile));
+
+    check.expect(matchCells(referenceCells(siteCoordinates(g, w, h), w, h, wrap), cells,
+                            REFERENCE_TOLERANCE * std::max(w, h)),
+                 format("voronoi %s: wrapped cells as bisector cut ones", name.c_str()));
+
+    Adjacency inline_adjacency;
+    std::vector<uint32_t> inline_edges;
+    const CellStore inline_cells = computeVoronoiWrapped(g, w, h, wrap, inline_pool, &inline_adjacency,
+                                                         &inline_edges);
+    check.expect(sameCells(cells, inline_cells, VERTEX_TOLERANCE * std::max(w, h), &edges, &inline_edges) &&
+                 sameAdjacency(adjacency, inline_adjacency),
+                 format("voronoi %s: same cells on any pool", name.c_str()));
+}
+
+} // namespace
+
+void checkVoronoi(Checker &check, ThreadPool &wide, ThreadPool &inline_pool) {
+    for (const Case &c : CASES) {
+        if (c.wrap == WRAP_NONE)
+            checkTile(check, c, wide, inline_pool);
+        else
+            checkWrapped(check, caseName(c), generateWrappedGrid(c.w, c.h, c.num, c.seed, c.wrap), c.w, c.h,
+                         c.wrap, wide, inline_pool);
+    }
+
+    for (const FewSites &f : FEW_SITES)
+        checkWrapped(check, format("%dx%d n=%zu%s", f.w, f.h, f.sites.size(), wrapName(f.wrap)),
+                     quantize(f.sites, f.w, f.h), f.w, f.h, f.wrap, wide, inline_pool);
+}
+
+} // namespace test
+} // namespace vt
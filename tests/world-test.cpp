@@ -0,0 +1,93 @@
+#include "check.h"
+
+#include <algorithm>
+
+#include "chunked-world.h"
+
+namespace vt {
+namespace test {
+
+namespace {
+
+/// world whose last row and column of chunks are narrower than the others
+ChunkedWorldSettings worldSettings(size_t cached) {
+    ChunkedWorldSettings settings;
+    settings.width = 900.0;
+    settings.height = 700.0;
+    settings.chunkSize = 128.0;
+    settings.minDist = 6.0;
+    settings.seed = 9;
+    settings.cachedChunks = cached;
+    return settings;
+}
+
+bool sameSites(const std::vector<CellVertex> &a, const std::vector<CellVertex> &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].x() != b[i].x() || a[i].y() != b[i].y())
+            return false;
+    }
+    return true;
+}
+
+bool ownsSites(const Chunk &chunk) {
+    for (const CellVertex &s : chunk.sites) {
+        if (s.x() < chunk.x0 || s.x() >= chunk.x1 || s.y() < chunk.y0 || s.y() >= chunk.y1)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void checkChunkedWorld(Checker &check, ThreadPool &, ThreadPool &) {
+    const ChunkedWorldSettings settings = worldSettings(0);
+    const std::string name = format("%gx%g chunk=%g min distance %g", settings.width, settings.height,
+                                    settings.chunkSize, settings.minDist);
+
+    ChunkedWorld world(settings);
+    std::vector<Chunk> chunks;
+    world.generate([&](const Chunk &chunk) { chunks.push_back(chunk); });
+    check.expect(chunks.size() == size_t(world.chunksX() * world.chunksY()),
+                 format("world %s: %zu chunks", name.c_str(), chunks.size()));
+
+    // chunks built alone, in the reverse order, their neighbours rebuilt on
+    // demand by a one-entry cache
+    ChunkedWorld alone(worldSettings(1));
+    bool owned = true, same = true;
+    for (auto it = chunks.rbegin(); it != chunks.rend(); ++it) {
+        const Chunk again = alone.chunk(it->cx, it->cy);
+        owned = owned && ownsSites(*it);
+        same = same && sameSites(it->sites, again.sites) &&
+               sameCells(it->cells, again.cells, VERTEX_TOLERANCE * std::max(settings.width, settings.height));
+    }
+    check.expect(owned, format("world %s: sites inside of their chunks", name.c_str()));
+    check.expect(same, format("world %s: chunks built alone as in a full pass", name.c_str()));
+
+    std::vector<CellVertex> sites;
+    CellStore cells;
+    for (const Chunk &chunk : chunks) {
+        sites.insert(sites.end(), chunk.sites.begin(), chunk.sites.end());
+        for (size_t i = 0; i < chunk.cells.size(); ++i)
+            cells.append(chunk.cells[i]);
+    }
+
+    const double limit = settings.minDist * (1.0 - DISTANCE_SLACK);
+    const double closest = closestPair(sites, settings.width, settings.height, settings.minDist, WRAP_NONE);
+    check.expect(closest >= limit, format("world %s: closest pair %.6g across the chunk borders too", name.c_str(),
+                                          closest));
+
+    // cells of the whole world at once, borders included
+    const double world_area = settings.width * settings.height;
+    double total;
+    const bool covered = coversArea(cells, sites.size(), world_area, total);
+    check.expect(covered, format("world %s: %zu cells, area %.12g of %.12g", name.c_str(), cells.size(), total,
+                                 world_area));
+    check.expect(matchCells(referenceCells(sites, settings.width, settings.height), cells,
+                            REFERENCE_TOLERANCE * std::max(settings.width, settings.height)),
+                 format("world %s: cells as bisector cut ones of every site", name.c_str()));
+}
+
+} // namespace test
+} // namespace vt
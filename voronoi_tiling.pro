@@ -1,19 +1,21 @@
-QT       += core gui
+TEMPLATE = subdirs
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+# core: Qt free library with the sampling and Voronoi code
+# gui:  interactive viewer (voronoi_tiling)
+# cli:  headless batch generator (voronoi_tiling_cli)
+# tests: optimized paths against their references (vt_tests), run by make check
+SUBDIRS = \
+        core \
+        gui \
+        cli \
+        tests
 
-TARGET = voronoi_tiling
-TEMPLATE = app
+gui.depends = core
+cli.depends = core
+tests.depends = core
 
-DEFINES += QT_DEPRECATED_WARNINGS
-
-SOURCES += \
-        main.cpp \
-        dialog.cpp
-
-HEADERS += \
-        dialog.h \
-        poisson-grid.h
-
-QMAKE_CFLAGS += -fno-omit-frame-pointer -g
-QMAKE_CXXFLAGS += -fno-omit-frame-pointer -g
+# qmake CONFIG+=vt_bench: Google Benchmark suite (vt_bench), needs libbenchmark
+vt_bench {
+    SUBDIRS += bench
+    bench.depends = core
+}